@@ -0,0 +1,131 @@
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Log binário diferido: em vez de formatar e escrever na USB CDC no ponto da chamada
+// (bloqueante, e dentro dos callbacks do lwIP), cada LOG_*() grava um registro compacto
+// num buffer circular na RAM: o endereço da string de formato (que fica na flash),
+// o instante e os argumentos já convertidos. Pode ser chamado de qualquer contexto,
+// inclusive IRQ e o outro core. binlog_poll(), no loop principal, escoa os registros
+// pela USB em linhas "@L <hex>", que tools/binlog_dump decodifica com o ELF do firmware.
+//
+// O formato não leva "\n" (o decodificador quebra a linha) e precisa ser um literal.
+// Cada argumento é classificado pelo tipo em tempo de compilação (_Generic): inteiros
+// de até 32 bits, de 64 bits, float/double (gravados como float), strings (copiadas,
+// até BINLOG_STR_MAX bytes) e ponteiros. No máximo BINLOG_MAX_ARGS argumentos.
+
+// Níveis; abaixo de BINLOG_NIVEL_MIN a chamada some na compilação
+#define BINLOG_DEBUG 0
+#define BINLOG_INFO  1
+#define BINLOG_AVISO 2
+#define BINLOG_ERRO  3
+
+#ifndef BINLOG_NIVEL_MIN
+#define BINLOG_NIVEL_MIN BINLOG_INFO
+#endif
+
+#define BINLOG_BUF_SIZE  4096   // Potência de 2
+#define BINLOG_MAX_ARGS  6
+#define BINLOG_STR_MAX   24
+
+typedef enum {
+    BINLOG_ARG_I32 = 1,
+    BINLOG_ARG_U32,
+    BINLOG_ARG_I64,
+    BINLOG_ARG_U64,
+    BINLOG_ARG_F32,
+    BINLOG_ARG_STR,
+    BINLOG_ARG_PTR,
+} binlog_arg_tipo_t;
+
+typedef struct {
+    uint8_t tipo;               // binlog_arg_tipo_t
+    union {
+        uint32_t u32;
+        uint64_t u64;
+        float f32;
+        const char *str;
+    };
+} binlog_arg_t;
+
+// Prepara o buffer. Antes disso os registros são descartados.
+void binlog_init(void);
+
+// Grava um registro (use as macros LOG_*).
+void binlog_write(uint8_t nivel, const char *fmt, unsigned nargs, const binlog_arg_t *args);
+
+// Escoa até alguns registros pela USB. Chamar no loop principal.
+void binlog_poll(void);
+
+// Há registros que binlog_poll() escoaria agora (terminal USB aberto)?
+bool binlog_pending(void);
+
+// Registros descartados por buffer cheio desde o boot.
+uint32_t binlog_dropped(void);
+
+// Conversores usados por BINLOG_ARG()
+static inline binlog_arg_t binlog_arg_i32(int32_t v)  { binlog_arg_t a = { .tipo = BINLOG_ARG_I32 }; a.u32 = (uint32_t)v; return a; }
+static inline binlog_arg_t binlog_arg_u32(uint32_t v) { binlog_arg_t a = { .tipo = BINLOG_ARG_U32 }; a.u32 = v; return a; }
+static inline binlog_arg_t binlog_arg_i64(int64_t v)  { binlog_arg_t a = { .tipo = BINLOG_ARG_I64 }; a.u64 = (uint64_t)v; return a; }
+static inline binlog_arg_t binlog_arg_u64(uint64_t v) { binlog_arg_t a = { .tipo = BINLOG_ARG_U64 }; a.u64 = v; return a; }
+static inline binlog_arg_t binlog_arg_f32(double v)   { binlog_arg_t a = { .tipo = BINLOG_ARG_F32 }; a.f32 = (float)v; return a; }
+static inline binlog_arg_t binlog_arg_str(const char *v) { binlog_arg_t a = { .tipo = BINLOG_ARG_STR }; a.str = v; return a; }
+static inline binlog_arg_t binlog_arg_ptr(const volatile void *v) { binlog_arg_t a = { .tipo = BINLOG_ARG_PTR }; a.u64 = (uintptr_t)v; return a; }
+
+#define BINLOG_ARG(x) _Generic((x),                         \
+    _Bool: binlog_arg_u32,                                  \
+    char: binlog_arg_i32,                                   \
+    signed char: binlog_arg_i32,                            \
+    unsigned char: binlog_arg_u32,                          \
+    short: binlog_arg_i32,                                  \
+    unsigned short: binlog_arg_u32,                         \
+    int: binlog_arg_i32,                                    \
+    unsigned int: binlog_arg_u32,                           \
+    long: binlog_arg_i32,                                   \
+    unsigned long: binlog_arg_u32,                          \
+    long long: binlog_arg_i64,                              \
+    unsigned long long: binlog_arg_u64,                     \
+    float: binlog_arg_f32,                                  \
+    double: binlog_arg_f32,                                 \
+    char *: binlog_arg_str,                                 \
+    const char *: binlog_arg_str,                           \
+    default: binlog_arg_ptr)(x)
+
+// Contagem e expansão dos argumentos (até BINLOG_MAX_ARGS)
+#define BINLOG_CAT_(a, b) a##b
+#define BINLOG_CAT(a, b) BINLOG_CAT_(a, b)
+#define BINLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, n, ...) n
+#define BINLOG_NARGS(...) BINLOG_NARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define BINLOG_VEC_0() NULL
+#define BINLOG_VEC_1(a) (const binlog_arg_t[]){ BINLOG_ARG(a) }
+#define BINLOG_VEC_2(a, b) (const binlog_arg_t[]){ BINLOG_ARG(a), BINLOG_ARG(b) }
+#define BINLOG_VEC_3(a, b, c) (const binlog_arg_t[]){ BINLOG_ARG(a), BINLOG_ARG(b), BINLOG_ARG(c) }
+#define BINLOG_VEC_4(a, b, c, d) (const binlog_arg_t[]){ BINLOG_ARG(a), BINLOG_ARG(b), BINLOG_ARG(c), BINLOG_ARG(d) }
+#define BINLOG_VEC_5(a, b, c, d, e) (const binlog_arg_t[]){ BINLOG_ARG(a), BINLOG_ARG(b), BINLOG_ARG(c), BINLOG_ARG(d), BINLOG_ARG(e) }
+#define BINLOG_VEC_6(a, b, c, d, e, f) (const binlog_arg_t[]){ BINLOG_ARG(a), BINLOG_ARG(b), BINLOG_ARG(c), BINLOG_ARG(d), BINLOG_ARG(e), BINLOG_ARG(f) }
+#define BINLOG_VEC(n, ...) BINLOG_CAT(BINLOG_VEC_, n)(__VA_ARGS__)
+
+#if PICO_ON_DEVICE
+#define BINLOG(nivel, fmt, ...) do {                                                    \
+        if ((nivel) >= BINLOG_NIVEL_MIN) {                                              \
+            binlog_write((nivel), "" fmt "", BINLOG_NARGS(__VA_ARGS__),                 \
+                         BINLOG_VEC(BINLOG_NARGS(__VA_ARGS__), ##__VA_ARGS__));         \
+        }                                                                               \
+    } while (0)
+#else
+// Host (fleet_sim): sem USB nem ELF para decodificar; formata na hora
+#include <stdio.h>
+#define BINLOG(nivel, fmt, ...) do {                                                    \
+        if ((nivel) >= BINLOG_NIVEL_MIN) printf(fmt "\n", ##__VA_ARGS__);               \
+    } while (0)
+#endif
+
+#define LOG_DEBUG(fmt, ...) BINLOG(BINLOG_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  BINLOG(BINLOG_INFO, fmt, ##__VA_ARGS__)
+#define LOG_AVISO(fmt, ...) BINLOG(BINLOG_AVISO, fmt, ##__VA_ARGS__)
+#define LOG_ERRO(fmt, ...)  BINLOG(BINLOG_ERRO, fmt, ##__VA_ARGS__)
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+// Linha do tempo do boot: registra o instante (desde o power-on) de cada etapa
+// até a primeira publicação, para medir o time-to-first-publish.
+
+// Registra um evento. Ignorado depois que o relatório foi impresso.
+void boot_trace_mark(const char *evento);
+
+// Imprime a linha do tempo completa (apenas na primeira chamada).
+void boot_trace_report(void);
+
+#endif
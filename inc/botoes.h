@@ -10,8 +10,8 @@
 // Inicializa os pinos dos botões como entradas com pull-up.
 void buttons_init(void);
 
-// Verifica o estado atual dos botões, compara com o estado anterior e publica
-// mensagens MQTT em caso de mudança.
+// Verifica o estado atual dos botões, compara com o estado anterior e enfileira
+// mensagens MQTT (classe de evento, ver pub_queue.h) em caso de mudança.
 void buttons_check_and_handle(bool *last_a_state, bool *last_b_state);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef BROKER_H
+#define BROKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lista de brokers (BROKER_LISTA em shared_vars.h) com pontuação de saúde. A conexão
+// disputa os melhores candidatos em paralelo (ver mqtt_connect) e o vencedor é lembrado
+// para as reconexões seguintes.
+
+#define BROKER_MAX       4      // Entradas aceitas em BROKER_LISTA
+#define BROKER_CORRIDA   2      // Candidatos disputando a mesma conexão
+
+typedef struct {
+    char host[48];              // IPv4 ou nome (resolvido pelo DNS em pico_net)
+    uint16_t port;
+    uint8_t protocol_version;   // Aprendido: cai para v3.1.1 se o broker recusar MQTT 5
+    uint32_t custo_ms;          // Média móvel do tempo até o CONNACK (0 = ainda sem medida)
+    uint8_t falhas;             // Falhas consecutivas
+    uint32_t conexoes;          // Vitórias acumuladas
+} broker_t;
+
+// Lê BROKER_LISTA ("host:porta,host:porta,..."). Retorna false se nenhuma entrada for válida.
+bool broker_init(void);
+
+// Quantidade de brokers configurados.
+int broker_count(void);
+
+// Entrada i da lista (0 <= i < broker_count()).
+broker_t *broker_get(int i);
+
+// Preenche 'out' com até 'max' índices, do melhor para o pior: o último vencedor (se
+// não falhou desde então) e depois os demais por pontuação. Retorna quantos preencheu.
+int broker_candidates(int *out, int max);
+
+// Resultado de uma tentativa. Quem perdeu a corrida não é reportado.
+void broker_report_success(int i, uint32_t tempo_ms);
+void broker_report_failure(int i);
+
+#endif
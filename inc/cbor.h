@@ -0,0 +1,84 @@
+#ifndef CBOR_H
+#define CBOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Codificador/decodificador CBOR (RFC 8949) mínimo para os payloads de telemetria.
+// Só itens de tamanho definido; sem alocação dinâmica.
+
+// --- Codificação ---
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;      // Algum item não coube; o conteúdo de buf não deve ser usado
+} cbor_writer_t;
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t cap);
+
+void cbor_put_uint(cbor_writer_t *w, uint64_t v);
+void cbor_put_int(cbor_writer_t *w, int64_t v);
+void cbor_put_bool(cbor_writer_t *w, bool v);
+void cbor_put_null(cbor_writer_t *w);
+// Usa meia precisão (3 bytes) quando o valor cabe nela sem perda, senão float32 (5 bytes)
+void cbor_put_float(cbor_writer_t *w, float v);
+void cbor_put_text(cbor_writer_t *w, const char *s, size_t len);
+void cbor_put_bytes(cbor_writer_t *w, const uint8_t *data, size_t len);
+// Cabeçalhos de contêiner: devem ser seguidos de n itens (array) ou n pares chave/valor (map)
+void cbor_put_array(cbor_writer_t *w, size_t n);
+void cbor_put_map(cbor_writer_t *w, size_t n);
+void cbor_put_tag(cbor_writer_t *w, uint64_t tag);
+
+// Bytes escritos, ou 0 se houve estouro do buffer.
+size_t cbor_writer_finish(const cbor_writer_t *w);
+
+// --- Decodificação ---
+
+typedef enum {
+    CBOR_TYPE_UINT,
+    CBOR_TYPE_NEGINT,       // Valor em item->i
+    CBOR_TYPE_BYTES,
+    CBOR_TYPE_TEXT,
+    CBOR_TYPE_ARRAY,        // Quantidade de itens em item->count
+    CBOR_TYPE_MAP,          // Quantidade de pares em item->count
+    CBOR_TYPE_TAG,          // Número da tag em item->u; o item marcado vem a seguir
+    CBOR_TYPE_BOOL,
+    CBOR_TYPE_NULL,
+    CBOR_TYPE_UNDEFINED,
+    CBOR_TYPE_FLOAT
+} cbor_type_t;
+
+typedef struct {
+    cbor_type_t type;
+    union {
+        uint64_t u;
+        int64_t i;
+        double f;
+        bool b;
+        uint64_t count;
+        struct {
+            const uint8_t *ptr;     // Aponta para dentro do buffer de entrada
+            size_t len;
+        } str;
+    };
+} cbor_item_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+} cbor_reader_t;
+
+void cbor_reader_init(cbor_reader_t *r, const uint8_t *buf, size_t len);
+
+// Lê o próximo item (contêineres só informam o tamanho; os filhos vêm nas chamadas
+// seguintes). Retorna false no fim da entrada ou se ela estiver malformada.
+bool cbor_read(cbor_reader_t *r, cbor_item_t *item);
+
+// Pula um item completo, incluindo o conteúdo de arrays, maps e tags.
+bool cbor_skip(cbor_reader_t *r);
+
+#endif
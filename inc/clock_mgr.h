@@ -0,0 +1,103 @@
+#ifndef CLOCK_MGR_H
+#define CLOCK_MGR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+// Escala do clock do sistema conforme a carga. O loop pede clock alto para os trechos
+// que fazem conta (handshake TLS, publicação cifrada, composição da tela) e o libera ao
+// terminar. Sem pedidos, o clk_sys desce para o nível ocioso depois de CLOCK_DESCE_MS.
+// A subida é imediata. Para subir acima de 133 MHz, a tensão do núcleo (VREG) sobe
+// antes do PLL. Na descida, ela volta depois.
+//
+// Periféricos: o clk_peri (UART, SPI) fica preso ao PLL_USB de 48 MHz, e o USB e o ADC
+// já usam esse PLL. O I2C do RP2040 conta com o clk_sys; os barramentos registrados em
+// clock_mgr_add_i2c() recebem o baud de novo a cada troca. O PIO do CYW43 também roda
+// no clk_sys: com CYW43_PIO_CLOCK_DIV_DYNAMIC, o divisor acompanha o clock. Sem ele,
+// nenhum nível pode passar de 2x CLOCK_CYW43_PIO_MAX_KHZ. A flash roda a clk_sys / 2
+// (PICO_FLASH_SPI_CLKDIV): 100 MHz no nível de rajada, abaixo dos 133 MHz do W25Q16JV.
+//
+// As trocas só acontecem nas chamadas do loop principal, nunca em interrupção, então
+// nenhuma transferência do I2C ou do CYW43 está em curso.
+
+typedef enum {
+    CLOCK_OCIOSO,               // Entre prazos, esperando rede ou sensores
+    CLOCK_NORMAL,               // Clock de boot do SDK
+    CLOCK_RAJADA,               // Criptografia e handshake
+    CLOCK_NIVEIS
+} clock_nivel_t;
+
+typedef enum {
+    CLOCK_MOTIVO_HANDSHAKE,     // Conexão TCP + TLS-PSK + CONNACK (nível de rajada)
+    CLOCK_MOTIVO_CRIPTO,        // Publicação: montagem, cifra e MAC dos registros (rajada)
+    CLOCK_MOTIVO_TELA,          // Composição do display (normal)
+    CLOCK_MOTIVOS
+} clock_motivo_t;
+
+#ifndef CLOCK_OCIOSO_KHZ
+#define CLOCK_OCIOSO_KHZ        48000
+#endif
+#ifndef CLOCK_NORMAL_KHZ
+#define CLOCK_NORMAL_KHZ        125000
+#endif
+#ifndef CLOCK_RAJADA_KHZ
+#define CLOCK_RAJADA_KHZ        200000
+#endif
+
+// Tensão do núcleo por nível (vreg_voltage do SDK). 1,15 V é o mínimo para 200 MHz.
+#ifndef CLOCK_OCIOSO_VREG
+#define CLOCK_OCIOSO_VREG       VREG_VOLTAGE_DEFAULT
+#endif
+#ifndef CLOCK_NORMAL_VREG
+#define CLOCK_NORMAL_VREG       VREG_VOLTAGE_DEFAULT
+#endif
+#ifndef CLOCK_RAJADA_VREG
+#define CLOCK_RAJADA_VREG       VREG_VOLTAGE_1_15
+#endif
+
+#ifndef CLOCK_VREG_ESPERA_US
+#define CLOCK_VREG_ESPERA_US    1000    // Estabilização do VREG depois de subir a tensão
+#endif
+#ifndef CLOCK_DESCE_MS
+#define CLOCK_DESCE_MS          20      // Sem pedidos por este tempo, o clock desce
+#endif
+#ifndef CLOCK_CYW43_PIO_MAX_KHZ
+#define CLOCK_CYW43_PIO_MAX_KHZ 62500   // PIO do CYW43: o padrão do SDK (125 MHz / 2)
+#endif
+#ifndef CLOCK_RELATORIO_MS
+#define CLOCK_RELATORIO_MS      60000
+#endif
+#define CLOCK_MAX_I2C           2
+
+typedef struct {
+    uint64_t tempo_us[CLOCK_NIVEIS];    // Tempo em cada nível desde o boot
+    uint32_t trocas;
+    uint64_t troca_us;                  // Tempo gasto nas trocas (VREG + PLL)
+    uint32_t falhas;                    // Trocas recusadas pelo PLL
+} clock_stats_t;
+
+// Valida os níveis, prende o clk_peri no PLL_USB e começa no nível normal. Com
+// CLOCK_ESCALA 0 (shared_vars.h), ou com algum nível inválido, o clock fica fixo.
+void clock_mgr_init(void);
+
+// Registra um barramento I2C para receber o baud de novo a cada troca de clock.
+bool clock_mgr_add_i2c(i2c_inst_t *i2c, uint baudrate);
+
+// Pede o nível do motivo até o clock_mgr_liberar() correspondente. Sobe na hora.
+void clock_mgr_pedir(clock_motivo_t motivo);
+void clock_mgr_liberar(clock_motivo_t motivo);
+
+// Aplica a descida pendente e imprime o relatório "[CLOCK]" a cada CLOCK_RELATORIO_MS.
+// Chamar a cada iteração do loop principal.
+void clock_mgr_poll(void);
+
+// Próximo instante em que clock_mgr_poll() tem o que fazer (o sono do loop não deve
+// passar dele, senão a CPU dorme no clock alto).
+absolute_time_t clock_mgr_prazo(void);
+
+clock_nivel_t clock_mgr_nivel(void);
+void clock_mgr_stats(clock_stats_t *out);
+
+#endif
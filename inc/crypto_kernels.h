@@ -0,0 +1,35 @@
+#ifndef CRYPTO_KERNELS_H
+#define CRYPTO_KERNELS_H
+
+#include <stdint.h>
+
+// Núcleos de AES e SHA-256 escritos para o Cortex-M0+ (sem extensões de criptografia).
+// Não dependem do mbedTLS: src/crypto_alt.c os liga aos hooks _ALT e o crypto_bench
+// os compara com as implementações originais.
+//
+// As chaves expandidas usam o mesmo formato do mbedTLS: palavras little-endian, Nr + 1
+// chaves de rodada; a de decifração segue a "cifra inversa equivalente" (ordem inversa,
+// com InvMixColumns aplicado às rodadas do meio), como mbedtls_aes_setkey_dec().
+
+// Expansão de chave (128, 192 ou 256 bits). 'rk' precisa de 60 palavras. Retorna Nr
+// (10, 12 ou 14) ou 0 se o tamanho for inválido. O firmware usa a expansão do próprio
+// mbedTLS; estas servem ao benchmark e aos testes no host.
+int crypto_aes_setkey_enc(uint32_t *rk, const uint8_t *key, unsigned bits);
+int crypto_aes_setkey_dec(uint32_t *rk, const uint8_t *key, unsigned bits);
+
+// Variante com T-table: uma tabela de 1 KB por sentido, na SRAM, com as outras três
+// colunas obtidas por rotação. No RP2040 a SRAM não tem cache, então o tempo de acesso
+// não depende do índice; em processadores com cache de dados a variante vaza pela cache.
+void crypto_aes_encrypt_table(const uint32_t *rk, int nr, const uint8_t in[16], uint8_t out[16]);
+void crypto_aes_decrypt_table(const uint32_t *rk, int nr, const uint8_t in[16], uint8_t out[16]);
+
+// Variante bitsliced em tempo constante: sem nenhum acesso à memória indexado por dado
+// secreto (S-box por circuito booleano). Mais lenta; para tabelas em flash/cache ou
+// quando o tempo constante precisa valer em qualquer processador.
+void crypto_aes_encrypt_ct(const uint32_t *rk, int nr, const uint8_t in[16], uint8_t out[16]);
+void crypto_aes_decrypt_ct(const uint32_t *rk, int nr, const uint8_t in[16], uint8_t out[16]);
+
+// Função de compressão do SHA-256 sobre um bloco de 64 bytes.
+void crypto_sha256_block(uint32_t state[8], const uint8_t data[64]);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef DEVICE_STATE_H
+#define DEVICE_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Estado do dispositivo publicado por seqlock. Quem escreve (callbacks do lwIP, cliente
+// MQTT, leitura de sensores; no futuro IRQs ou o core 1) atualiza os campos por estas
+// funções; quem lê (display, publicação, diagnóstico) tira um snapshot consistente sem
+// desabilitar interrupções: a leitura é refeita se um escritor passou no meio.
+
+typedef struct {
+    uint32_t versao;            // Muda a cada escrita: snapshot igual ao anterior = nada mudou
+    bool wifi_conectado;
+    uint32_t ipv4;              // Endereço atual (ordem de rede), 0 sem conexão
+    bool mqtt_conectado;
+    float temperatura;          // Última leitura, °C
+    uint64_t temperatura_t_us;  // Instante da leitura (time_us_64), 0 se nenhuma
+} device_state_t;
+
+// Prepara a exclusão entre escritores. Chamar uma vez no boot, antes de qualquer escrita.
+void device_state_init(void);
+
+// Copia o estado atual para 'out'. Lock-free; pode ser chamada de qualquer contexto
+// (os escritores mascaram as IRQs do próprio core durante as poucas instruções da escrita).
+void device_state_snapshot(device_state_t *out);
+
+// Escritores. Cada chamada publica uma nova versão do estado inteiro.
+void device_state_set_wifi(bool conectado, uint32_t ipv4);
+void device_state_set_mqtt(bool conectado);
+void device_state_set_temperatura(float celsius, uint64_t t_us);
+
+// Leitura de um único campo (nunca rasga). Para combinar campos, use o snapshot.
+bool device_state_wifi_conectado(void);
+bool device_state_mqtt_conectado(void);
+
+#endif
@@ -13,18 +13,40 @@
 #ifndef LWIP_SOCKET
 #define LWIP_SOCKET                 0
 #endif
-#if PICO_CYW43_ARCH_POLL
+#if PICO_CYW43_ARCH_POLL && !MEM_ESTATICA
 #define MEM_LIBC_MALLOC             1
+// Alocações do lwIP contadas à parte no heap compartilhado (mem_diag.h)
+#include "mem_diag.h"
+#define mem_clib_malloc(size)       mem_diag_malloc(MEM_LWIP, size)
+#define mem_clib_calloc(n, size)    mem_diag_calloc(MEM_LWIP, n, size)
+#define mem_clib_free(p)            mem_diag_free(p)
 #else
-// MEM_LIBC_MALLOC is incompatible with non polling versions
+// MEM_LIBC_MALLOC is incompatible with non polling versions. No modo estático
+// (MEM_ESTATICA, mem_diag.h) o lwIP também usa o heap e os pools próprios, de tamanho fixo.
 #define MEM_LIBC_MALLOC             0
 #endif
 #define MEM_ALIGNMENT               4
 #ifndef MEM_SIZE
+#if MEM_ESTATICA
+// Heap do lwIP: segmentos TCP de saída (PBUF_RAM, até TCP_SND_BUF) e mensagens de DHCP, DNS e SNTP
+#define MEM_SIZE                    16384
+#else
 #define MEM_SIZE                    4000
 #endif
+#endif
 #define MEMP_NUM_TCP_SEG            32
 #define MEMP_NUM_ARP_QUEUE          10
+#if MEM_ESTATICA
+// Pools explícitos, sem MEMP_MEM_MALLOC: cada um vira um vetor memp_memory_* no map
+#define MEMP_MEM_MALLOC             0
+#define MEMP_NUM_PBUF               16
+#define MEMP_NUM_RAW_PCB            1
+#define MEMP_NUM_UDP_PCB            4   // DHCP, DNS, SNTP e folga
+#define MEMP_NUM_TCP_PCB            4   // Conexões da corrida de brokers e as em TIME_WAIT
+#define MEMP_NUM_TCP_PCB_LISTEN     1
+#define MEMP_NUM_REASSDATA          2
+#define MEMP_NUM_FRAG_PBUF          4
+#endif
 #define PBUF_POOL_SIZE              24
 #define LWIP_ARP                    1
 #define LWIP_ETHERNET               1
@@ -48,7 +70,9 @@
 #define LWIP_IPV4                   1
 #define LWIP_TCP                    1
 #define LWIP_UDP                    1
-#define LWIP_DNS                    0
+#define LWIP_DNS                    1
+#define DNS_TABLE_SIZE              4
+#define DNS_MAX_NAME_LENGTH         64
 #define LWIP_TCP_KEEPALIVE          1
 #define LWIP_NETIF_TX_SINGLE_PBUF   1
 #define DHCP_DOES_ARP_CHECK         0
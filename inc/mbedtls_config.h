@@ -20,6 +20,19 @@
 #define MBEDTLS_CIPHER_MODE_CBC     // Necessário para TLS
 #define MBEDTLS_GCM_C                // Necessário para TLS
 
+// ===== Núcleos otimizados para o M0+ (src/crypto_kernels.c, ligados em src/crypto_alt.c) =====
+// CRYPTO_ALT 0 volta às implementações C do mbedTLS (o crypto_bench compila assim para comparar).
+#ifndef CRYPTO_ALT
+#define CRYPTO_ALT 1
+#endif
+#if CRYPTO_ALT
+#define MBEDTLS_AES_ENCRYPT_ALT
+#define MBEDTLS_AES_DECRYPT_ALT
+#define MBEDTLS_SHA256_PROCESS_ALT
+#endif
+// AES: 0 = T-table na SRAM (rápido; sem cache de dados no RP2040); 1 = bitsliced em tempo constante
+#define CRYPTO_AES_TEMPO_CONSTANTE 0
+
 // ===== Entropia e RNG =====
 #define MBEDTLS_ENTROPY_C
 #define MBEDTLS_CTR_DRBG_C
@@ -30,6 +43,13 @@
 #define MBEDTLS_PLATFORM_C
 #define MBEDTLS_PLATFORM_MEMORY
 
+// Modo estático (mem_diag.h): o registro de saída cabe num segmento TCP cheio
+// (MQTT_CORK_BUF_SIZE), então 4 KB bastam e a vaga de cada sessão encolhe 12 KB. O de
+// entrada fica em 16 KB: o broker pode mandar registros cheios.
+#if MEM_ESTATICA
+#define MBEDTLS_SSL_OUT_CONTENT_LEN 4096
+#endif
+
 // ===== O que NÃO precisamos =====
 // Desabilitar suporte a certificados/X.509
 #undef MBEDTLS_X509_USE_C
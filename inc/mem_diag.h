@@ -0,0 +1,143 @@
+#ifndef MEM_DIAG_H
+#define MEM_DIAG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Uso de memória por subsistema. Com MEM_LIBC_MALLOC=1, lwIP, mbedTLS e o framebuffer
+// do display dividem o heap da newlib. Cada um aloca pelos wrappers abaixo, que guardam
+// tamanho e subsistema num cabeçalho de 8 bytes antes do bloco. Assim, o bloco
+// liberado desconta do subsistema certo. Os ganchos:
+//  - lwIP: mem_clib_malloc/calloc/free em lwipopts.h
+//  - mbedTLS: mbedtls_platform_set_calloc_free() em mqtt_init()
+//  - display: ssd1306_init()/ssd1306_deinit()
+//
+// As pilhas dos dois cores são pintadas com um padrão em mem_diag_init(). A marca
+// d'água é o ponto mais fundo onde o padrão foi sobrescrito. No host (ferramentas), os
+// wrappers são o malloc da libc.
+//
+// Modo estático (opção ALOCACAO_ESTATICA do CMake, que define MEM_ESTATICA=1). Não há
+// heap: cada bloco sai de um pool de tamanho fixo, reservado no link.
+//  - mbedTLS: uma vaga por sessão (MEM_TLS_SESSOES, uma por candidato da corrida de
+//    brokers), com um bloco para cada registro (entrada e saída) e classes de blocos
+//    pequenos para contextos e transformações. O pedido vai para a menor classe com bloco
+//    livre, na vaga escolhida por mem_diag_tls_sessao(). Sem fragmentação, e alocar custa
+//    a varredura de um bitmap. A configuração (PSK e identidade) tem a vaga
+//    MEM_TLS_CONFIG.
+//  - display: um bloco do tamanho do framebuffer.
+//  - lwIP: sai do mem_diag. Usa MEM_LIBC_MALLOC 0, com o próprio MEM_SIZE e os pools
+//    MEMP_NUM_* (lwipopts.h).
+// As seções críticas usam um spinlock de hardware, que também exclui o core 1. O malloc
+// da newlib vira panic (--wrap=_malloc_r e _sbrk). Nesse modo, os bytes contados são os
+// dos blocos reservados.
+
+#ifndef MEM_ESTATICA
+#define MEM_ESTATICA 0
+#endif
+#ifndef MEM_TLS_SESSOES
+#define MEM_TLS_SESSOES         2       // >= BROKER_CORRIDA (verificado em src/mqtt.c)
+#endif
+#define MEM_TLS_CONFIG          MEM_TLS_SESSOES     // Vaga da configuração TLS compartilhada
+
+// Registros TLS: MBEDTLS_SSL_IN/OUT_CONTENT_LEN mais cabeçalho, IV, MAC e padding
+#ifndef MEM_TLS_ENTRADA_LEN
+#define MEM_TLS_ENTRADA_LEN     16384
+#endif
+#ifndef MEM_TLS_SAIDA_LEN
+#define MEM_TLS_SAIDA_LEN       4096
+#endif
+#define MEM_TLS_FOLGA_REGISTRO  512
+
+// Blocos pequenos por sessão (até 32 por classe). A linha "[MEM] tls" mostra o pico de
+// cada classe, para ajustar.
+#ifndef MEM_TLS_BLOCOS_64
+#define MEM_TLS_BLOCOS_64       4       // Hostname e afins
+#endif
+#ifndef MEM_TLS_BLOCOS_256
+#define MEM_TLS_BLOCOS_256      6       // Sessão, contextos de hash e de HMAC
+#endif
+#ifndef MEM_TLS_BLOCOS_512
+#define MEM_TLS_BLOCOS_512      6       // Transformações e contextos AES
+#endif
+#ifndef MEM_TLS_BLOCOS_1K
+#define MEM_TLS_BLOCOS_1K       4       // Contextos GCM
+#endif
+#ifndef MEM_TLS_BLOCOS_2K
+#define MEM_TLS_BLOCOS_2K       1       // Parâmetros do handshake
+#endif
+#ifndef MEM_TLS_BLOCOS_CONFIG
+#define MEM_TLS_BLOCOS_CONFIG   4       // Blocos de 64 bytes: PSK e identidade
+#endif
+#ifndef MEM_DISPLAY_BLOCO
+#define MEM_DISPLAY_BLOCO       (128 * 64 / 8 + 8)  // Framebuffer 128x64 + byte de controle do I2C
+#endif
+
+typedef enum {
+    MEM_LWIP,                   // pbufs PBUF_RAM e demais mem_malloc() do lwIP
+    MEM_MBEDTLS,                // Contexto SSL e buffers de registro (entrada e saída)
+    MEM_DISPLAY,                // Framebuffer do SSD1306
+    MEM_SUBSISTEMAS
+} mem_subsistema_t;
+
+typedef struct {
+    uint32_t atual;             // Bytes em uso (sem os cabeçalhos)
+    uint32_t pico;
+    uint32_t blocos;            // Blocos em uso
+    uint32_t falhas;            // Pedidos recusados pelo heap (ou pelos pools)
+    uint32_t capacidade;        // Bytes dos pools do modo estático; 0 no heap compartilhado
+} mem_uso_t;
+
+typedef struct {
+    uint32_t tamanho;           // 0: pilha não reservada (core 1 sem pico_multicore)
+    uint32_t usado;             // Maior profundidade alcançada desde o boot
+} mem_pilha_t;
+
+typedef struct {
+    mem_uso_t sub[MEM_SUBSISTEMAS];
+    uint32_t pico_total;        // Maior soma simultânea dos subsistemas
+    uint32_t heap_total;        // Do fim do .bss ao início das pilhas (limite do sbrk)
+    uint32_t heap_uso;          // mallinfo(): inclui o que não passa pelos wrappers
+    uint32_t heap_arena;        // Já obtido do sbrk; não volta
+    uint32_t sem_cabecalho;     // Blocos liberados aqui que vieram do malloc direto
+    mem_pilha_t pilha[2];       // Core 0 e core 1
+} mem_diag_t;
+
+#if PICO_ON_DEVICE
+// Pinta as pilhas. Chamar no início do main(), antes de a pilha do core 0 crescer.
+void mem_diag_init(void);
+
+void *mem_diag_malloc(mem_subsistema_t sub, size_t tam);
+void *mem_diag_calloc(mem_subsistema_t sub, size_t n, size_t tam);
+void mem_diag_free(void *p);
+#else
+#include <stdlib.h>
+#define mem_diag_init()                 ((void)0)
+#define mem_diag_malloc(sub, tam)       ((void)(sub), malloc(tam))
+#define mem_diag_calloc(sub, n, tam)    ((void)(sub), calloc(n, tam))
+#define mem_diag_free(p)                free(p)
+#endif
+
+#if PICO_ON_DEVICE && MEM_ESTATICA
+// Vaga (0..MEM_TLS_SESSOES - 1, ou MEM_TLS_CONFIG) das próximas alocações do mbedTLS. O
+// callback de calloc do mbedTLS não recebe contexto: quem chama o mbedTLS escolhe antes.
+void mem_diag_tls_sessao(unsigned vaga);
+#else
+#define mem_diag_tls_sessao(vaga)       ((void)(vaga))
+#endif
+
+void mem_diag_snapshot(mem_diag_t *out);
+
+// Imprime linhas "[MEM]" com o heap, cada subsistema e as duas pilhas.
+void mem_diag_relata(void);
+
+static inline const char *mem_diag_nome(mem_subsistema_t sub) {
+    switch (sub) {
+    case MEM_LWIP:      return "lwip";
+    case MEM_MBEDTLS:   return "mbedtls";
+    case MEM_DISPLAY:   return "display";
+    default:            return "?";
+    }
+}
+
+#endif
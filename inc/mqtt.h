@@ -3,11 +3,158 @@
 #define MQTT_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "mbedtls/ssl.h"
+#include "pico_net.h"
+#include "reconnect.h"
+#include "mqtt_topics.h"
 
-// Tenta estabelecer a conexão completa (TCP -> TLS -> MQTT) com o broker.
+// Tamanho máximo do corpo de um pacote recebido que é guardado (o excedente é descartado).
+// Cobre o CONNACK do MQTT 5 com as propriedades usuais.
+#define MQTT_RX_BUF_SIZE 128
+
+// Nível de protocolo enviado no CONNECT
+#define MQTT_VERSAO_311 4
+#define MQTT_VERSAO_5   5
+
+// Escrita combinada (cork): bytes acumulados antes de um envio forçado. Um registro TLS
+// com vários pacotes paga um cabeçalho, um IV, um MAC e um segmento TCP só. O limite
+// é o maior registro que ainda cabe num segmento de TCP_MSS (1460) com o overhead do
+// AES-128-CBC-SHA256: 5 de cabeçalho, 16 de IV, 32 de MAC e até 16 de padding.
+#define MQTT_CORK_BUF_SIZE (1460 - 69)
+
+// Máximo de aliases de tópico que o cliente associa por conexão (MQTT 5)
+#define MQTT_MAX_TOPIC_ALIASES 8
+
+// Etapas da conexão de um cliente
+typedef enum {
+    MQTT_STATE_IDLE,            // Sem sessão
+    MQTT_STATE_TCP_CONNECTING,  // Aguardando o TCP conectar
+    MQTT_STATE_TLS_HANDSHAKE,   // Handshake TLS-PSK em andamento
+    MQTT_STATE_WAIT_CONNACK,    // CONNECT enviado, aguardando CONNACK
+    MQTT_STATE_CONNECTED,       // Sessão MQTT ativa
+    MQTT_STATE_FAILED           // Falhou; ver failure_stage
+} mqtt_state_t;
+
+// Contexto de um cliente MQTT sobre TLS. Cada instância tem sua própria sessão TLS e
+// conexão TCP; a configuração TLS (PSK, ciphersuite, DRBG) é compartilhada.
+typedef struct {
+    mbedtls_ssl_context ssl;
+    pico_net_context net;
+    bool session_open;              // true enquanto ssl/net estão alocados
+    uint8_t tls_sessao;             // Vaga TLS no modo estático (mem_diag.h); 0 por padrão
+
+    const char *host;
+    uint16_t port;
+    char client_id[32];
+
+    uint8_t protocol_version;       // MQTT_VERSAO_5 ou MQTT_VERSAO_311
+    bool fallback;                  // A última tentativa foi recusada em v5; a próxima usa v3.1.1
+    pico_net_perfil_t transporte;   // Perfil de transporte (ver mqtt_client_set_transport)
+
+    // Negociado no CONNACK (MQTT 5)
+    uint16_t topic_alias_max;       // Topic Alias Maximum do broker (0 = sem aliases)
+    uint16_t receive_max;           // Receive Maximum do broker (limite de QoS 1/2 em trânsito)
+    const mqtt_topic_t *aliases[MQTT_MAX_TOPIC_ALIASES]; // aliases[i] usa o alias i + 1
+    uint8_t alias_count;
+    int32_t bytes_saved;            // Bytes a menos que o mesmo tráfego em v3.1.1
+
+    mqtt_state_t state;
+    reconnect_class_t failure_stage; // Etapa em que a última conexão falhou
+    absolute_time_t deadline;        // Timeout da etapa atual
+
+    // Recepção: cabeçalho fixo (tipo + Remaining Length) seguido do corpo
+    uint8_t rx_type;
+    uint8_t rx_hdr_len;             // Bytes do cabeçalho fixo já lidos
+    bool rx_hdr_done;
+    bool rx_complete;               // O pacote em rx_* está pronto para ser consumido
+    uint32_t rx_len;                // Remaining Length do pacote em curso
+    uint32_t rx_got;                // Bytes do corpo já lidos
+    int rx_erro;                    // Retorno do mbedtls_ssl_read() que encerrou a leitura
+    uint8_t rx_buf[MQTT_RX_BUF_SIZE];
+
+    // Envio: com corked, os pacotes vão para tx_buf e saem juntos no flush/uncork
+    bool corked;
+    uint16_t tx_len;
+    uint16_t tx_pacotes;
+    uint8_t tx_buf[MQTT_CORK_BUF_SIZE];
+} mqtt_client_t;
+
+// --- API por cliente ---
+
+// Prepara o DRBG e a configuração TLS. Pode ser chamada no boot, antes de haver rede.
+bool mqtt_init(void);
+
+// Configura destino e client ID. Não abre conexão. O protocolo inicial é MQTT_VERSAO
+// (shared_vars.h) e pode ser trocado em c->protocol_version antes de conectar.
+void mqtt_client_init(mqtt_client_t *c, const char *host, uint16_t port, const char *client_id);
+
+// Perfil de transporte (padrão MQTT_TRANSPORTE, de shared_vars.h), aplicado na hora se
+// houver conexão:
+//   PICO_NET_LATENCIA: Nagle desligado e cork ignorado; cada pacote vira um registro
+//                      TLS pequeno, enviado no ato.
+//   PICO_NET_VAZAO:    Nagle ligado e cork acumulando até um registro de um segmento
+//                      cheio (MQTT_CORK_BUF_SIZE).
+void mqtt_client_set_transport(mqtt_client_t *c, pico_net_perfil_t perfil);
+
+// Inicia a conexão TCP sem bloquear. O progresso é feito por mqtt_client_step().
+bool mqtt_client_start(mqtt_client_t *c);
+
+// Avança a conexão (TCP -> TLS -> CONNECT/CONNACK) sem bloquear. Retorna o estado atual.
+mqtt_state_t mqtt_client_step(mqtt_client_t *c);
+
+// Conecta de forma bloqueante (start + step com poll da rede até concluir ou falhar).
+bool mqtt_client_connect(mqtt_client_t *c);
+
+// Publica uma mensagem de texto (QoS 0).
+bool mqtt_client_publish(mqtt_client_t *c, const char *topic, const char *payload);
+
+// Publica em um tópico fixo (QoS 0); só o payload é copiado. len <= MQTT_TOPIC_MAX_PAYLOAD.
+bool mqtt_client_publish_topic(mqtt_client_t *c, const mqtt_topic_t *topic, const uint8_t *payload, size_t len);
+
+// Escrita combinada: depois de cork, os pacotes são acumulados (até MQTT_CORK_BUF_SIZE,
+// quando há um envio forçado) e uncork envia o acumulado como um único registro TLS.
+// No perfil PICO_NET_LATENCIA, cork não faz nada.
+// flush envia na hora sem sair do modo cork. Retornam false se a escrita falhou (a
+// sessão fica em MQTT_STATE_FAILED e o acumulado é descartado).
+void mqtt_client_cork(mqtt_client_t *c);
+bool mqtt_client_flush(mqtt_client_t *c);
+bool mqtt_client_uncork(mqtt_client_t *c);
+
+// Envia um PINGREQ (keep-alive / medição de round-trip). Sempre sai na hora: junto com
+// o que estiver acumulado pelo cork, se houver.
+bool mqtt_client_ping(mqtt_client_t *c);
+
+// Lê e trata os pacotes recebidos. Retorna quantos PINGRESP chegaram, ou -1 se a conexão caiu.
+int mqtt_client_process_input(mqtt_client_t *c);
+
+// Encerra a sessão (TLS + TCP) e libera os recursos, se houver uma aberta.
+void mqtt_client_close(mqtt_client_t *c);
+
+// --- API do dispositivo (brokers de BROKER_LISTA, client ID DEVICE_ID) ---
+
+// Tenta estabelecer a conexão completa (TCP -> TLS -> MQTT), disputando em paralelo os
+// melhores brokers da lista (ver broker.h). O vencedor é o preferido na próxima vez.
 bool mqtt_connect(void);
 
 // Publica uma mensagem de texto (payload) em um tópico.
 bool mqtt_publish(const char *topic, const char *payload);
 
-#endif
\ No newline at end of file
+// Publica um payload em um tópico fixo (ver mqtt_topics.h).
+bool mqtt_publish_topic(const mqtt_topic_t *topic, const uint8_t *payload, size_t len);
+
+// Escrita combinada na sessão atual (ver mqtt_client_cork). Sem sessão, cork não faz
+// nada e flush/uncork retornam true se não havia nada acumulado.
+void mqtt_cork(void);
+bool mqtt_flush(void);
+bool mqtt_uncork(void);
+
+// Etapa (TCP ou TLS) em que a última tentativa de conexão falhou (a mais avançada entre
+// os candidatos: TLS se algum broker respondeu ao TCP).
+reconnect_class_t mqtt_last_failure(void);
+
+// Encerra a sessão atual (TLS + TCP) e libera os recursos, se houver uma aberta.
+void mqtt_disconnect(void);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef MQTT_TOPICS_H
+#define MQTT_TOPICS_H
+
+#include <stdint.h>
+
+// Descritores de tópicos fixos: o cabeçalho do PUBLISH (tipo, espaço para o Remaining
+// Length, comprimento do tópico) e os bytes do tópico são montados em tempo de compilação.
+// Publicar só copia o payload (e, em MQTT 5, as propriedades) para depois do tópico e
+// ajusta o Remaining Length. O endereço do descritor identifica o tópico para os aliases.
+
+// Bytes antes do tópico: 0x30, 2 bytes reservados ao Remaining Length, comprimento (MSB, LSB)
+#define MQTT_TOPIC_PREFIX_LEN   5
+// Maior payload aceito por um tópico fixo (define o buffer reservado para cada um)
+#define MQTT_TOPIC_MAX_PAYLOAD  128
+// Espaço entre o tópico e o payload para as propriedades do MQTT 5 (comprimento + Topic Alias)
+#define MQTT_TOPIC_PROPS_MAX    4
+
+// Formato do payload publicado em cada tópico (ver payload.h)
+typedef enum {
+    MQTT_FORMATO_TEXTO,     // Valor em texto puro (ex.: "25.31")
+    MQTT_FORMATO_JSON,      // Objeto JSON (ex.: {"estado":"pressionado"})
+    MQTT_FORMATO_CBOR       // Mapa CBOR com chaves inteiras (RFC 8949)
+} mqtt_payload_format_t;
+
+typedef struct {
+    uint8_t *buf;           // Prefixo + tópico + espaço para o payload
+    uint16_t topic_len;
+    mqtt_payload_format_t format;
+} mqtt_topic_t;
+
+/*
+ * Define um tópico fixo. O terminador da string ocupa o primeiro byte da área das
+ * propriedades/payload e é sobrescrito a cada publicação. Ex.:
+ *   MQTT_TOPIC_DEFINE(mqtt_topic_temperatura, "/aluno72/bitdoglab/temp", MQTT_FORMATO_CBOR);
+ */
+#define MQTT_TOPIC_DEFINE(name, str, fmt)                                              \
+    /* O Remaining Length precisa caber nos 2 bytes reservados (< 16384) */             \
+    _Static_assert(2 + sizeof(str) - 1 + MQTT_TOPIC_PROPS_MAX + MQTT_TOPIC_MAX_PAYLOAD < 16384, \
+                   "tópico MQTT longo demais: " str);                                  \
+    static struct __attribute__((packed)) {                                            \
+        uint8_t prefix[MQTT_TOPIC_PREFIX_LEN];                                         \
+        char topic[sizeof(str)];                                                       \
+        uint8_t payload[MQTT_TOPIC_PROPS_MAX + MQTT_TOPIC_MAX_PAYLOAD - 1];            \
+    } name##_buf = {                                                                   \
+        { 0x30, 0x00, 0x00, (uint8_t)((sizeof(str) - 1) >> 8), (uint8_t)(sizeof(str) - 1) }, \
+        str,                                                                           \
+        { 0 }                                                                          \
+    };                                                                                 \
+    const mqtt_topic_t name = { (uint8_t *)&name##_buf, sizeof(str) - 1, fmt }
+
+// Tópicos usados pelo firmware (definidos em src/mqtt_topics.c)
+extern const mqtt_topic_t mqtt_topic_temperatura;
+extern const mqtt_topic_t mqtt_topic_botao_a;
+extern const mqtt_topic_t mqtt_topic_botao_b;
+extern const mqtt_topic_t mqtt_topic_diag_memoria;
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef NET_CACHE_H
+#define NET_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Dados da última associação bem-sucedida, guardados no último setor da flash
+// para que o próximo boot possa pular a varredura de canais e o DHCP.
+typedef struct {
+    uint32_t ssid_hash;     // Invalida o cache se WIFI_SSID mudar
+    uint8_t  bssid[6];      // AP usado na última associação
+    uint8_t  channel;       // Canal desse AP
+    uint8_t  has_lease;     // 1 se os campos abaixo contêm um lease DHCP
+    uint32_t ip;            // Endereços em ordem de rede (ip4_addr_t.addr)
+    uint32_t netmask;
+    uint32_t gw;
+} net_cache_t;
+
+// Lê o cache da flash. Retorna false se não existir, estiver corrompido ou for de outro SSID.
+bool net_cache_load(net_cache_t *out);
+
+// Grava o cache na flash, apenas se for diferente do conteúdo atual.
+// Bloqueia por algumas dezenas de ms (apagamento do setor); não chamar de callbacks.
+bool net_cache_store(const net_cache_t *cache);
+
+// Hash do SSID configurado, usado para validar o cache.
+uint32_t net_cache_ssid_hash(void);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef PAYLOAD_H
+#define PAYLOAD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mqtt_topics.h"
+#include "mem_diag.h"
+
+// Monta os payloads publicados pelo firmware no formato configurado para cada tópico
+// (texto, JSON ou CBOR). Todas as funções retornam o tamanho escrito, ou 0 se não coube.
+
+// Chaves inteiras dos mapas CBOR (1 byte cada no fio). Os consumidores usam a mesma tabela.
+#define PAYLOAD_CHAVE_TIMESTAMP   0     // uint, ms UTC desde 1970 (da primeira amostra)
+#define PAYLOAD_CHAVE_TEMPERATURA 1     // float, °C
+#define PAYLOAD_CHAVE_ESTADO      2     // bool, true = pressionado
+#define PAYLOAD_CHAVE_INTERVALOS  3     // [uint], ms entre cada amostra e a anterior
+#define PAYLOAD_CHAVE_MEMORIA     4     // [[atual, pico, falhas]], por subsistema (mem_diag.h)
+#define PAYLOAD_CHAVE_HEAP        5     // [em uso, total], bytes
+#define PAYLOAD_CHAVE_PILHAS      6     // [core 0, core 1], bytes usados (marca d'água)
+
+// Valores de um canal de sensor, em ordem cronológica. t_ms traz o horário UTC (ms) de
+// cada amostra; pode ser NULL ou ter zeros se o relógio ainda não foi sincronizado, e
+// nesse caso o horário é omitido. Texto leva todas, uma por linha ("25.31 1718000000000");
+// JSON leva o último valor e o seu horário ({"nome":25.31,"ts":1718000000000}); CBOR leva
+// todas: {0: t0, chave: 25.31} ou {0: t0, chave: [v1, v2, ...], 3: [dt2, ...]}.
+size_t payload_valores(const mqtt_topic_t *topic, const char *nome, uint8_t chave,
+                       const float *valores, const uint64_t *t_ms, size_t n,
+                       uint8_t *buf, size_t cap);
+
+// Temperatura: "25.31" | {"temperatura":25.31} | {1: 25.31}
+size_t payload_temperatura(const mqtt_topic_t *topic, float celsius, uint8_t *buf, size_t cap);
+
+// Evento de botão: "pressionado" | {"estado":"pressionado","ts":...} | {0: ..., 2: true}
+// t_ms é o horário UTC do evento (0 = desconhecido, omitido).
+size_t payload_botao(const mqtt_topic_t *topic, bool pressionado, uint64_t t_ms, uint8_t *buf, size_t cap);
+
+// Memória: "heap 23456/180000 pilhas 1180/0" |
+// {"lwip":[1200,5400,0],"mbedtls":[...],"display":[...],"heap":[23456,180000],"pilhas":[1180,0]} |
+// {4: [[1200, 5400, 0], ...], 5: [23456, 180000], 6: [1180, 0]}
+size_t payload_memoria(const mqtt_topic_t *topic, const mem_diag_t *d, uint8_t *buf, size_t cap);
+
+#endif
@@ -2,32 +2,61 @@
 #define PICO_NET_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <mbedtls/ssl.h>
 
 // Enum para o estado da nossa conexão
 typedef enum {
     CONN_IDLE,
+    CONN_RESOLVING,     // Aguardando a resposta do DNS
     CONN_CONNECTING,
     CONN_CONNECTED,
     CONN_CLOSING,
     CONN_FAILED
 } conn_state_t;
 
+// Perfil de transporte de uma conexão
+typedef enum {
+    PICO_NET_VAZAO,     // Nagle ligado: escritas pequenas esperam o ACK e saem num segmento só
+    PICO_NET_LATENCIA,  // Nagle desligado: cada escrita sai na hora, sem esperar ACK
+} pico_net_perfil_t;
+
 // Estrutura principal que guarda o estado da rede
 typedef struct {
+#ifdef PICO_NET_HOST
+    int fd; /* socket POSIX não-bloqueante (tools/fleet_sim/pico_net_host.c) */
+    volatile conn_state_t state;
+#else
     mbedtls_ssl_context ssl;
     struct tcp_pcb *pcb;
     volatile conn_state_t state;
     struct pbuf *rx_buf;
     size_t rx_offset; /* offset dentro do primeiro pbuf (não mexer em p->payload) */
+    uint16_t port;    /* porta a conectar quando o DNS responder */
+    void *dns_req;    /* consulta DNS pendente (interno a pico_net.c) */
+#endif
+    pico_net_perfil_t perfil; /* aplicado a cada conexão (pico_net_set_profile) */
 } pico_net_context;
 
 void pico_net_init(pico_net_context *ctx);
-bool pico_net_connect(pico_net_context *ctx, const char *host_ip, uint16_t port);
+// Inicia a conexão TCP sem bloquear. 'host' pode ser um IPv4 ou um nome: nomes são
+// resolvidos pelo DNS do lwIP (que guarda as respostas pelo TTL) e o estado passa por
+// CONN_RESOLVING antes de CONN_CONNECTING. Nomes que falharam há pouco falham na hora.
+bool pico_net_connect(pico_net_context *ctx, const char *host, uint16_t port);
 void pico_net_close(pico_net_context *ctx);
 
+// Escolhe o perfil de transporte. Vale para a conexão aberta e para as próximas (até o
+// próximo pico_net_init, que volta para PICO_NET_VAZAO, o padrão do lwIP).
+void pico_net_set_profile(pico_net_context *ctx, pico_net_perfil_t perfil);
+
 // Funções de BIO para o mbedTLS (send/recv)
 int pico_net_send(void *ctx, const unsigned char *buf, size_t len);
 int pico_net_recv(void *ctx, unsigned char *buf, size_t len);
 
+#ifdef PICO_NET_HOST
+// Só no host: conclui um connect() pendente quando o epoll sinaliza o socket
+// (faz o papel de net_connected_cb/net_error_cb do lwIP).
+void pico_net_host_update(pico_net_context *ctx);
+#endif
+
 #endif // PICO_NET_H
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+
+// Gerência de energia. No modo contínuo nada muda em relação ao loop original; no modo
+// cíclico o rádio fica em economia (PM2), display e ADC ficam desligados entre usos, a
+// CPU dorme até o próximo prazo e as amostras acumuladas saem numa única rajada de rádio.
+
+#define POWER_MODO_CONTINUO 0
+#define POWER_MODO_CICLICO  1
+
+// Inicializa o modo configurado em POWER_MODO (shared_vars.h). Chamar depois de
+// wifi_init(), buttons_init() e da inicialização do display.
+void power_init(ssd1306_t *disp);
+
+// Avança janelas de rajada, desligamento do display e relatório de energia.
+// Chamar a cada iteração do loop principal.
+void power_poll(void);
+
+// true se os sensores podem publicar agora (sempre, no modo contínuo).
+bool power_can_publish(void);
+
+// true se o display está ligado e deve ser atualizado.
+bool power_display_on(void);
+
+// Cede a CPU até 'deadline', até haver trabalho para o cyw43 ou até um botão mudar de
+// estado, e então atende a pilha de rede.
+void power_wait(absolute_time_t deadline);
+
+#endif
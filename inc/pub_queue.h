@@ -0,0 +1,67 @@
+#ifndef PUB_QUEUE_H
+#define PUB_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mqtt_topics.h"
+
+// Fila de saída das publicações MQTT, com classes de prioridade. Quem produz mensagens
+// (botões, sensores) só enfileira; o loop principal esvazia a fila quando há conexão,
+// sempre a classe mais prioritária primeiro. Cada classe tem profundidade máxima e
+// política de descarte próprias, e a fila mede quanto tempo cada mensagem esperou.
+
+typedef enum {
+    PUB_CLASSE_EVENTO,          // Eventos (botões): furam a fila, mesmo fora da rajada de rádio
+    PUB_CLASSE_TELEMETRIA,      // Amostras periódicas dos sensores
+    PUB_CLASSE_DIAG,            // Diagnóstico: só quando não há mais nada
+    PUB_CLASSES
+} pub_classe_t;
+
+typedef enum {
+    PUB_DESCARTA_ANTIGA,        // Fila cheia: descarta a mais antiga (o estado mais recente vale mais)
+    PUB_DESCARTA_NOVA,          // Fila cheia: recusa a nova (quem produziu mantém os dados e tenta depois)
+    PUB_SUBSTITUI_TOPICO        // Mensagem do mesmo tópico na fila é substituída; cheia: recusa a nova
+} pub_politica_t;
+
+// Latência na fila em faixas de potência de 2: faixa i conta esperas < 2^i ms
+#define PUB_QUEUE_FAIXAS 12
+
+typedef struct {
+    uint32_t enfileiradas;
+    uint32_t enviadas;
+    uint32_t descartadas;
+    uint8_t profundidade_max;
+    uint32_t latencia_max_us;
+    uint64_t latencia_soma_us;
+    uint32_t faixas[PUB_QUEUE_FAIXAS];
+} pub_queue_stats_t;
+
+// Monta o payload de um evento na hora do envio, a partir do dado e do instante de
+// captura (time_us_64) guardados na fila. Retorna o tamanho escrito, ou 0 se não coube.
+typedef size_t (*pub_monta_t)(const mqtt_topic_t *topic, uint32_t dado, uint64_t t_us, uint8_t *buf, size_t cap);
+
+// Enfileira uma cópia do payload. Retorna false se a mensagem não entrou (política
+// PUB_DESCARTA_NOVA/PUB_SUBSTITUI_TOPICO com a classe cheia ou payload grande demais).
+bool pub_queue_push(pub_classe_t classe, const mqtt_topic_t *topic, const uint8_t *payload, size_t len);
+
+// Enfileira um evento cujo payload só é montado (por 'monta') ao sair da fila, para levar
+// o horário UTC de t_us mesmo que a captura tenha sido antes da primeira sincronização
+// SNTP. Enquanto o relógio não sincroniza, o evento espera até PUB_ESPERA_RELOGIO_MS
+// depois da conexão; passado isso, sai sem horário. Mesmas políticas de pub_queue_push.
+bool pub_queue_push_evento(pub_classe_t classe, const mqtt_topic_t *topic, pub_monta_t monta,
+                           uint32_t dado, uint64_t t_us);
+
+// Publica as mensagens pendentes, por prioridade. Eventos saem sempre que conectado;
+// telemetria e diagnóstico só se 'bulk' (ex.: durante a rajada do modo de energia).
+// As mensagens de uma chamada saem num único registro TLS (ver mqtt_cork). Retorna
+// quantas foram publicadas, ou -1 se a conexão caiu (as mensagens ficam na fila).
+int pub_queue_service(bool connected, bool bulk);
+
+// true se pub_queue_service(true, bulk) teria algo a publicar agora.
+bool pub_queue_ready(bool bulk);
+
+// Estatísticas acumuladas de uma classe.
+void pub_queue_stats(pub_classe_t classe, pub_queue_stats_t *out);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef RECONNECT_H
+#define RECONNECT_H
+
+#include <stdint.h>
+
+// Classes de falha com orçamentos independentes.
+typedef enum {
+    RECONNECT_WIFI,   // Associação ao AP / DHCP
+    RECONNECT_TCP,    // Conexão TCP com o broker
+    RECONNECT_TLS,    // Handshake TLS-PSK e CONNECT/CONNACK sobre a sessão segura
+    RECONNECT_NUM_CLASSES
+} reconnect_class_t;
+
+// Política de uma classe: backoff exponencial limitado + cool-down ao esgotar o orçamento.
+typedef struct {
+    uint32_t base_ms;       // Espera nominal após a primeira falha
+    uint32_t max_ms;        // Teto do backoff exponencial
+    uint8_t  budget;        // Falhas seguidas toleradas antes do cool-down
+    uint32_t cooldown_ms;   // Espera nominal quando o orçamento se esgota
+} reconnect_policy_t;
+
+// Fonte de aleatoriedade (no firmware, o CTR-DRBG; no host, um PRNG qualquer).
+typedef uint32_t (*reconnect_rand_fn)(void *ctx);
+
+typedef struct {
+    const reconnect_policy_t *policies;       // RECONNECT_NUM_CLASSES entradas
+    uint8_t failures[RECONNECT_NUM_CLASSES];  // Falhas seguidas por classe
+    reconnect_rand_fn rand;
+    void *rand_ctx;
+} reconnect_t;
+
+// Políticas padrão do firmware.
+extern const reconnect_policy_t reconnect_default_policies[RECONNECT_NUM_CLASSES];
+
+// Janela sobre a qual a primeira reconexão após uma queda é espalhada.
+#define RECONNECT_DROP_SPREAD_MS 5000
+
+void reconnect_init(reconnect_t *r, const reconnect_policy_t *policies, reconnect_rand_fn rand, void *rand_ctx);
+
+// Registra uma falha da classe e retorna quanto esperar (ms) antes da próxima tentativa.
+uint32_t reconnect_on_failure(reconnect_t *r, reconnect_class_t cls);
+
+// Zera o contador da classe após um sucesso.
+void reconnect_reset(reconnect_t *r, reconnect_class_t cls);
+
+// Espera antes de reconectar após perder uma conexão que estava saudável.
+// Nunca é zero fixo: se o broker reinicia, a frota inteira cai no mesmo instante.
+uint32_t reconnect_on_drop(reconnect_t *r);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mbedtls/ctr_drbg.h"
+
+// Semeia o CTR-DRBG a partir da entropia de hardware. Chamar uma vez no boot.
+bool rng_init(void);
+
+// DRBG compartilhado (TLS e demais usos de números aleatórios).
+mbedtls_ctr_drbg_context *rng_drbg(void);
+
+// Número aleatório de 32 bits do DRBG (assinatura compatível com reconnect_rand_fn).
+uint32_t rng_u32(void *ctx);
+
+#endif
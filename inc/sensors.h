@@ -0,0 +1,65 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "mqtt_topics.h"
+
+// Registro genérico de canais de sensores. Cada canal tem período de amostragem,
+// buffer circular de amostras com timestamp e política de publicação próprios; o
+// escalonador só faz trabalho quando o prazo mais próximo entre todos os canais vence.
+
+#define SENSORS_MAX_CHANNELS  8
+#define SENSOR_RING_SIZE      16    // Amostras guardadas por canal (as mais antigas são descartadas)
+
+// Lê um valor do sensor. Retorna false se a leitura falhou (a amostra é ignorada).
+typedef bool (*sensor_read_fn)(void *ctx, float *valor);
+
+typedef enum {
+    SENSOR_PUBLICA_AMOSTRA,     // Publica cada amostra assim que é lida
+    SENSOR_PUBLICA_PERIODICO,   // Publica a cada publish_period_ms
+    SENSOR_PUBLICA_MUDANCA      // Publica quando varia ao menos 'delta' (ou a cada publish_period_ms)
+} sensor_publish_policy_t;
+
+typedef struct {
+    float valor;
+    uint64_t t_us;              // Instante da leitura (time_us_64)
+} sensor_sample_t;
+
+// Configuração de um canal (normalmente constante, definida por quem registra)
+typedef struct {
+    const char *nome;           // Nome no JSON e no log
+    uint8_t chave;              // Chave inteira no CBOR (ver payload.h)
+    sensor_read_fn read;
+    void *ctx;
+    uint32_t period_ms;         // Intervalo de amostragem
+    sensor_publish_policy_t policy;
+    uint32_t publish_period_ms; // PERIODICO: intervalo; MUDANCA: intervalo máximo sem publicar (0 = sem limite)
+    float delta;                // MUDANCA: variação mínima
+    const mqtt_topic_t *topic;
+} sensor_config_t;
+
+// Registra um canal. Retorna o índice do canal, ou -1 se o registro estiver cheio.
+int sensors_register(const sensor_config_t *cfg);
+
+// Lê os canais cujo prazo venceu e, se can_publish, põe na fila de publicação (classe
+// telemetria, ver pub_queue.h) os que estiverem prontos. Amostras não enfileiradas (ex.:
+// sem conexão ou fila cheia) ficam no buffer e vão na próxima publicação.
+// Retorna quantos payloads foram enfileirados, ou -1 se a fila de telemetria estava cheia.
+int sensors_poll(bool can_publish);
+
+// Marca todos os canais com amostras para publicação na próxima chamada de sensors_poll()
+// (ex.: logo depois de conectar ao broker).
+void sensors_request_publish(void);
+
+// Próximo instante em que sensors_poll() tem trabalho a fazer.
+absolute_time_t sensors_next_deadline(void);
+
+// Total de amostras já publicadas (todos os canais), para métricas como energia por amostra.
+uint32_t sensors_samples_published(void);
+
+// Última amostra do canal. Retorna false se ainda não houver nenhuma.
+bool sensors_latest(int canal, sensor_sample_t *out);
+
+#endif
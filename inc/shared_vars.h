@@ -2,6 +2,7 @@
 #define SHARED_VARS_H
 
 #include <stdbool.h>
+#include "reconnect.h"
 
 // =============================================================================
 // Constantes de Configuração do Projeto
@@ -11,25 +12,77 @@
 #define WIFI_SSID       "ED-LINK FIBRA // Joao"
 #define WIFI_PASSWORD   "JOAO2FILHO8"
 
+// --- Endereçamento IP ---
+// 1: usa o IP fixo abaixo, sem DHCP (boot mais rápido).
+// 0: DHCP, reaproveitando o último lease salvo na flash enquanto o DHCP confirma.
+#define WIFI_IP_ESTATICO    0
+#define WIFI_IP_ENDERECO    "192.168.1.150"
+#define WIFI_IP_MASCARA     "255.255.255.0"
+#define WIFI_IP_GATEWAY     "192.168.1.1"
+#define WIFI_IP_DNS         "192.168.1.1"
+
 // --- Configurações do Broker MQTT ---
-#define BROKER_HOST     "192.168.1.107"  // IP do Servidor
+#define BROKER_HOST     "192.168.1.107"  // IP ou nome do servidor
 #define BROKER_PORT     "8872"
+// Brokers aceitos, "host:porta" (IP ou nome) separados por vírgula (até BROKER_MAX). Com mais de
+// um, os dois melhores disputam cada conexão e o vencedor é o preferido na seguinte, ex.:
+//   #define BROKER_LISTA BROKER_HOST ":" BROKER_PORT ",broker2.local:8872"
+#define BROKER_LISTA    BROKER_HOST ":" BROKER_PORT
 #define PSK_IDENTITY    "aluno72"
 #define DEVICE_ID       "bitdoglab01-aluno72"  // ID do dispositivo (client ID MQTT)
+// Protocolo: 5 = MQTT 5 com aliases de tópico (cai para v3.1.1 se o broker recusar); 4 = v3.1.1
+#define MQTT_VERSAO     5
 #define MQTT_TOPICO_TEMPERATURA "/aluno72/bitdoglab/temp"
 #define MQTT_TOPICO_BOTAO_A     "/aluno72/bitdoglab/botoes/a"
 #define MQTT_TOPICO_BOTAO_B     "/aluno72/bitdoglab/botoes/b"
+#define MQTT_TOPICO_DIAG_MEMORIA "/aluno72/bitdoglab/diag/memoria"
+// Formato do payload por tópico: MQTT_FORMATO_TEXTO, MQTT_FORMATO_JSON ou MQTT_FORMATO_CBOR
+// (CBOR reduz o payload; decodifique com tools/cbor_dump)
+#define MQTT_FORMATO_TEMPERATURA MQTT_FORMATO_TEXTO
+#define MQTT_FORMATO_BOTOES      MQTT_FORMATO_JSON
+#define MQTT_FORMATO_DIAG        MQTT_FORMATO_JSON
+// Transporte: PICO_NET_LATENCIA (Nagle desligado, cada pacote num registro TLS enviado na
+// hora: menor atraso entre o botão e o broker) ou PICO_NET_VAZAO (Nagle ligado e pacotes
+// acumulados em registros de até um segmento: menos bytes e segmentos por mensagem)
+#define MQTT_TRANSPORTE PICO_NET_LATENCIA
+
+// --- Sincronização de horário (SNTP) ---
+#define NTP_SERVIDOR    "200.160.7.186"  // a.ntp.br (IP fixo: a hora não depende do DNS)
+#define NTP_PORTA       123
+
+// --- Energia ---
+// POWER_MODO_CONTINUO: rádio sem economia, display sempre ligado, loop a cada 1 ms.
+// POWER_MODO_CICLICO: rádio em PM2, display e ADC desligados fora de uso, CPU dormindo
+// entre os prazos e publicação em lote numa rajada de rádio a cada 50 s (use o formato
+// CBOR para que o lote leve todas as amostras, não só a última).
+#define POWER_MODO      POWER_MODO_CONTINUO
+
+// --- Clock do sistema ---
+// 1: o clk_sys sobe para 200 MHz (1,15 V) no handshake TLS e na publicação, fica em
+// 125 MHz na composição da tela e desce para 48 MHz no resto. A cada minuto, o log
+// "[CLOCK]" mostra o tempo em cada nível. 0: 125 MHz fixos. Níveis em clock_mgr.h.
+#define CLOCK_ESCALA    1
+
+// --- Diagnóstico de memória ---
+// A cada MEM_DIAG_INTERVALO_MS, o log "[MEM]" mostra o heap por subsistema (lwIP, mbedTLS,
+// display) e as marcas d'água das pilhas, e o mesmo resumo vai para MQTT_TOPICO_DIAG_MEMORIA
+// (classe de diagnóstico da fila). A tecla 'm' no terminal USB pede o relatório na hora.
+#define MEM_DIAG_INTERVALO_MS   60000
+
+// --- Perfil da cache XIP ---
+// 1: mede ciclos e faltas na cache XIP da publicação e da composição da tela e imprime
+// linhas "[XIP]" a cada XIP_PERFIL_INTERVALO_MS. Compare builds com XIP_RAM_QUENTE 1 e 0
+// (funções quentes na SRAM ou na flash; ver xip_cache.h).
+#define XIP_PERFIL              0
+#define XIP_PERFIL_INTERVALO_MS 60000
 
 // =============================================================================
 // Variáveis Globais Compartilhadas
 // =============================================================================
 
-// Estrutura única para armazenar os dados do sensor lidos pela task do MPU
-// e consumidos pelas tasks de display e MQTT.
-extern volatile float temperatura_atual;
+// Temperatura e estado das conexões ficam em device_state.h (snapshot consistente)
 
-// Flags de status de conexão
-extern volatile bool g_wifi_connected;
-extern volatile bool g_mqtt_connected;
+// Política de reconexão (Wi-Fi, TCP e TLS) compartilhada pelo Wi-Fi e pelo loop principal
+extern reconnect_t g_reconnect;
 
 #endif
\ No newline at end of file
@@ -70,6 +70,40 @@ typedef struct {
     size_t bufsize;		/**< buffer size */
 } ssd1306_t;
 
+/**
+*	@brief how the raster primitives combine with the buffer
+*/
+typedef enum {
+    SSD1306_OP_SET,         /**< light the pixels */
+    SSD1306_OP_CLEAR,       /**< turn the pixels off */
+    SSD1306_OP_XOR          /**< invert the pixels (drawing twice restores the buffer) */
+} ssd1306_op_t;
+
+/**
+*	@brief image in the controller's native layout (generated by tools/ssd1306_assets)
+*
+*	data holds (height+7)/8 pages of width bytes each; bit 0 of a byte is the top row of its page
+*/
+typedef struct {
+    uint8_t width;          /**< width in pixels */
+    uint8_t height;         /**< height in pixels */
+    const uint8_t *data;    /**< page-major pixel data */
+} ssd1306_imagem_t;
+
+/**
+*	@brief proportional font in the controller's native layout (generated by tools/ssd1306_assets)
+*
+*	each glyph is a page-major image of widths[c-first] columns by height rows, at data+offsets[c-first]
+*/
+typedef struct {
+    uint8_t height;             /**< height in pixels (every glyph) */
+    uint8_t first;              /**< first character */
+    uint8_t last;               /**< last character */
+    const uint8_t *widths;      /**< advance of each character, spacing included (0: missing) */
+    const uint16_t *offsets;    /**< start of each glyph in data */
+    const uint8_t *data;        /**< page-major glyph data */
+} ssd1306_fonte_t;
+
 /**
 *	@brief initialize display
 *
@@ -172,6 +206,66 @@ void ssd1306_draw_pixel(ssd1306_t *p, uint32_t x, uint32_t y);
 */
 void ssd1306_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
 
+/**
+	@brief draw line on buffer with the given op (integer Bresenham, clipped)
+
+	Horizontal and vertical lines are span fills; every pixel is touched once, so XOR is reversible.
+
+	@param[in] p : instance of display
+	@param[in] x1 : x position of starting point
+	@param[in] y1 : y position of starting point
+	@param[in] x2 : x position of end point
+	@param[in] y2 : y position of end point
+	@param[in] op : set, clear or invert
+*/
+void ssd1306_draw_line_op(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2, ssd1306_op_t op);
+
+/**
+	@brief horizontal span of width pixels starting at (x, y), clipped
+
+	@param[in] p : instance of display
+	@param[in] x : x position of leftmost pixel (may be negative)
+	@param[in] y : y position
+	@param[in] width : length in pixels
+	@param[in] op : set, clear or invert
+*/
+void ssd1306_draw_hline(ssd1306_t *p, int32_t x, int32_t y, uint32_t width, ssd1306_op_t op);
+
+/**
+	@brief vertical span of height pixels starting at (x, y), clipped; one masked byte per page
+
+	@param[in] p : instance of display
+	@param[in] x : x position
+	@param[in] y : y position of topmost pixel (may be negative)
+	@param[in] height : length in pixels
+	@param[in] op : set, clear or invert
+*/
+void ssd1306_draw_vline(ssd1306_t *p, int32_t x, int32_t y, uint32_t height, ssd1306_op_t op);
+
+/**
+	@brief filled rectangle, clipped; whole bytes per page (memset for set/clear), masks on the edge pages
+
+	@param[in] p : instance of display
+	@param[in] x : x position of top left corner (may be negative)
+	@param[in] y : y position of top left corner (may be negative)
+	@param[in] width : width in pixels
+	@param[in] height : height in pixels
+	@param[in] op : set, clear or invert
+*/
+void ssd1306_fill_rect(ssd1306_t *p, int32_t x, int32_t y, uint32_t width, uint32_t height, ssd1306_op_t op);
+
+/**
+	@brief rectangle outline of width x height pixels, clipped; each pixel touched once
+
+	@param[in] p : instance of display
+	@param[in] x : x position of top left corner (may be negative)
+	@param[in] y : y position of top left corner (may be negative)
+	@param[in] width : width in pixels
+	@param[in] height : height in pixels
+	@param[in] op : set, clear or invert
+*/
+void ssd1306_draw_rect(ssd1306_t *p, int32_t x, int32_t y, uint32_t width, uint32_t height, ssd1306_op_t op);
+
 /**
 	@brief clear square at given position with given size
 
@@ -225,6 +319,33 @@ void ssd1306_bmp_show_image_with_offset(ssd1306_t *p, const uint8_t *data, const
 */
 void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long size);
 
+/**
+	@brief draw precompiled image, replacing the pixels it covers
+
+	A full-screen image at (0, 0) is a single memcpy; with y a multiple of 8, one memcpy per page.
+
+	@param[in] p : instance of display
+	@param[in] x : x position (may be negative or cross the border: the image is clipped)
+	@param[in] y : y position
+	@param[in] img : image generated by tools/ssd1306_assets
+*/
+void ssd1306_draw_image(ssd1306_t *p, int32_t x, int32_t y, const ssd1306_imagem_t *img);
+
+/**
+	@brief draw text with a precompiled font, over the current contents
+
+	Characters outside the font (e.g. UTF-8 lead bytes) are skipped without advancing.
+
+	@param[in] p : instance of display
+	@param[in] x : x starting position of text
+	@param[in] y : y starting position of text
+	@param[in] font : font generated by tools/ssd1306_assets
+	@param[in] s : text to draw
+
+	@return x position after the last character
+*/
+int32_t ssd1306_draw_text(ssd1306_t *p, int32_t x, int32_t y, const ssd1306_fonte_t *font, const char *s);
+
 /**
 	@brief draw char with given font
 
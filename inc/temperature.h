@@ -1,7 +1,12 @@
 #ifndef TEMPERATURE_H
 #define TEMPERATURE_H
 
+#include <stdbool.h>
+
 // Protótipo da função para ler a temperatura interna do RP2040
 float read_onboard_temp_celsius(void); 
 
+// Liga/desliga o gating: com ele, o ADC e o sensor interno só ficam ligados durante a leitura.
+void temperature_set_gating(bool enable);
+
 #endif
@@ -0,0 +1,29 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Cliente SNTP (RFC 4330) sobre UDP do lwIP. Mantém a relação entre o timer de
+// hardware (time_us_64) e o UTC, corrigindo a deriva do cristal entre sincronizações.
+// As amostras guardam o instante do timer na captura e são convertidas para UTC na
+// publicação, então leituras feitas antes da primeira sincronização também recebem
+// o horário correto.
+
+// Inicializa o cliente. Chamar uma vez no boot, depois de wifi_init().
+void time_sync_init(void);
+
+// Envia consultas e trata timeouts. Chamar a cada iteração do loop principal.
+void time_sync_poll(void);
+
+// true depois da primeira sincronização bem-sucedida.
+bool time_sync_valid(void);
+
+// Converte um instante do timer (time_us_64) em milissegundos UTC desde 1970.
+// Retorna 0 se ainda não houve sincronização.
+uint64_t time_sync_utc_ms(uint64_t local_us);
+
+// Deriva estimada do timer local, em partes por bilhão (positivo = timer atrasa).
+int32_t time_sync_drift_ppb(void);
+
+#endif
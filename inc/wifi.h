@@ -4,11 +4,25 @@
 #include <stdbool.h>
 //#include "lwip/ip_addr.h"
 
+// Estados da máquina de associação assíncrona do Wi-Fi
+typedef enum {
+    WIFI_STATE_IDLE,        // Nenhuma associação em andamento
+    WIFI_STATE_JOINING,     // cyw43 associando ao AP
+    WIFI_STATE_WAIT_IP,     // Link L2 ativo, aguardando endereço via DHCP
+    WIFI_STATE_CONNECTED,   // Link ativo e com IP válido
+    WIFI_STATE_BACKOFF      // Falha na associação, aguardando para tentar de novo
+} wifi_state_t;
+
 // Inicializa o hardware e o modo Wi-Fi da placa. Deve ser chamada apenas uma vez.
 void wifi_init(void);
 
-// Conecta o módulo Wi-Fi da placa ao ponto de acesso especificado.
-bool wifi_connect(void);
-extern volatile bool g_wifi_connected;
+// Inicia a associação ao ponto de acesso sem bloquear. O progresso é feito em wifi_poll().
+void wifi_connect_async(void);
+
+// Avança a máquina de estados (timeouts e reassociação). Chamar a cada iteração do loop.
+void wifi_poll(void);
+
+// Retorna o estado atual da conexão Wi-Fi.
+wifi_state_t wifi_get_state(void);
 
 #endif
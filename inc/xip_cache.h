@@ -0,0 +1,92 @@
+#ifndef XIP_CACHE_H
+#define XIP_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Código quente fora da XIP. O firmware roda da flash pela cache XIP de 16 KB, e uma
+// falta custa dezenas de ciclos. As rodadas do AES, o pico_net, o codificador MQTT e o
+// blitter do display disputam essa cache. RAM_QUENTE(nome), na definição de uma função,
+// faz o crt0 copiá-la para a SRAM no boot (__not_in_flash_func do SDK).
+// RAM_QUENTE_DADOS(nome) faz o mesmo com uma tabela const lida nesses caminhos.
+//
+// Os candidatos saem do relatório de xip_regiao_*(): ciclos e faltas na cache por
+// execução de um caminho. Com XIP_RAM_QUENTE 0, tudo volta para a flash. Compilar as
+// duas versões e comparar os relatórios dá o antes e o depois. No host (ferramentas),
+// as macros não fazem nada.
+
+#ifndef XIP_RAM_QUENTE
+#define XIP_RAM_QUENTE 1
+#endif
+
+#if PICO_ON_DEVICE && XIP_RAM_QUENTE
+#include "pico.h"
+#define RAM_QUENTE(nome)        __not_in_flash_func(nome)
+#define RAM_QUENTE_DADOS(nome)  __not_in_flash(#nome)
+#else
+#define RAM_QUENTE(nome)        nome
+#define RAM_QUENTE_DADOS(nome)
+#endif
+
+// Perfil de um caminho do código: ciclos (SysTick, no clock da CPU) e acessos e acertos
+// da cache XIP (contadores CTR_ACC e CTR_HIT do XIP_CTRL). Os contadores da XIP são
+// globais: contam os dois cores e também as leituras de dados const da flash. As somas
+// ficam separadas por clk_sys (os níveis do clock_mgr), porque ciclos e faltas a 48 e a
+// 200 MHz não se comparam.
+#define XIP_CLOCKS 3
+
+typedef struct {
+    uint32_t mhz;               // clk_sys destas somas; 0 = sem uso
+    uint32_t execucoes;
+    uint64_t ciclos;
+    uint32_t pior_ciclos;
+    uint64_t acessos;           // Acessos à cache XIP
+    uint64_t faltas;            // Acessos que foram buscar na flash
+} xip_soma_t;
+
+typedef struct {
+    const char *nome;
+    xip_soma_t soma[XIP_CLOCKS];
+
+    // Execução em curso
+    uint32_t t0_us;
+    uint32_t st0;
+    uint32_t acc0;
+    uint32_t hit0;
+} xip_regiao_t;
+
+#define XIP_REGIAO(nome_) { .nome = (nome_) }
+
+// Liga o SysTick como contador de ciclos livre. Chamar uma vez, antes das medidas.
+void xip_cache_init(void);
+
+// Informa o clk_sys novo (o clock_mgr chama a cada troca). Converte o timer em ciclos
+// nas execuções mais longas que a volta do SysTick e separa as somas por clock.
+void xip_cache_clock(uint32_t hz);
+
+// Invalida a cache XIP, para medir um caminho a frio.
+void xip_cache_flush(void);
+
+// Marca o início e o fim de uma execução do caminho. Um início sem fim é descartado
+// pelo início seguinte.
+void xip_regiao_inicio(xip_regiao_t *r);
+void xip_regiao_fim(xip_regiao_t *r);
+
+// Imprime uma linha "[XIP]" por clock, com as médias por execução, e zera as somas.
+void xip_regiao_relata(xip_regiao_t *r);
+
+// Perfil no firmware principal: publicação e composição da tela, relatadas a cada
+// XIP_PERFIL_INTERVALO_MS. Ligue XIP_PERFIL em shared_vars.h; desligado, some na compilação.
+#ifndef XIP_PERFIL
+#define XIP_PERFIL 0
+#endif
+
+#if XIP_PERFIL
+#define XIP_PERFIL_INICIO(r) xip_regiao_inicio(r)
+#define XIP_PERFIL_FIM(r)    xip_regiao_fim(r)
+#else
+#define XIP_PERFIL_INICIO(r) ((void)(r))
+#define XIP_PERFIL_FIM(r)    ((void)(r))
+#endif
+
+#endif
@@ -15,11 +15,24 @@
 #include "temperature.h"
 #include "botoes.h"
 #include "ssd1306.h"
+#include "assets.h"
+#include "boot_trace.h"
+#include "reconnect.h"
+#include "rng.h"
+#include "payload.h"
+#include "sensors.h"
+#include "time_sync.h"
+#include "power.h"
+#include "pub_queue.h"
+#include "device_state.h"
+#include "binlog.h"
+#include "xip_cache.h"
+#include "clock_mgr.h"
+#include "mem_diag.h"
 
 // --- Constantes de Controle ---
 #define TEMPERATURE_READ_INTERVAL_MS 5000
 #define MQTT_PUBLISH_INTERVAL_MS 10000 // Publica a cada 10 segundos
-#define MQTT_RECONNECT_INTERVAL_MS 10000 // Tenta reconectar a cada 10 segundos
 #define DISPLAY_UPDATE_INTERVAL_MS 100 // *** ATUALIZA O ECRÃ 10 VEZES POR SEGUNDO ***
 
 // --- Pinos ---
@@ -29,115 +42,250 @@
 // --- Display ---
 ssd1306_t disp;
 
+// --- Perfil da cache XIP (XIP_PERFIL) ---
+static xip_regiao_t perfil_publicacao = XIP_REGIAO("publicacao");
+static xip_regiao_t perfil_tela = XIP_REGIAO("tela");
+
+// --- Sensores ---
+static bool ler_temperatura(void *ctx, float *valor) {
+    (void)ctx;
+    *valor = read_onboard_temp_celsius();
+    device_state_set_temperatura(*valor, time_us_64()); // Exibida no display
+    return true;
+}
+
+static const sensor_config_t canal_temperatura = {
+    .nome = "temperatura",
+    .chave = PAYLOAD_CHAVE_TEMPERATURA,
+    .read = ler_temperatura,
+    .period_ms = TEMPERATURE_READ_INTERVAL_MS,
+    .policy = SENSOR_PUBLICA_PERIODICO,
+    .publish_period_ms = MQTT_PUBLISH_INTERVAL_MS,
+    .topic = &mqtt_topic_temperatura,
+};
+
+// --- Diagnóstico ---
+// Resumo de memória pela fila de diagnóstico: sai quando não há mais nada a publicar, e
+// só o mais recente espera na fila
+static void publica_memoria(void) {
+    mem_diag_t d;
+    uint8_t payload[MQTT_TOPIC_MAX_PAYLOAD];
+
+    mem_diag_snapshot(&d);
+    size_t len = payload_memoria(&mqtt_topic_diag_memoria, &d, payload, sizeof(payload));
+    if (len) pub_queue_push(PUB_CLASSE_DIAG, &mqtt_topic_diag_memoria, payload, len);
+}
+
 void init_display() {
     i2c_init(i2c1, 400 * 1000);
+    clock_mgr_add_i2c(i2c1, 400 * 1000);    // O I2C conta com o clk_sys, que muda de nível
     gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
     gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
     gpio_pull_up(I2C_SDA_PIN);
     gpio_pull_up(I2C_SCL_PIN);
     
     ssd1306_init(&disp, 128, 64, 0x3C, i2c1);
-    ssd1306_clear(&disp);
-    ssd1306_draw_string(&disp, 0, 0, 1, "Iniciando...");
+    // Imagem e fontes vêm de assets/, convertidas no build (tools/ssd1306_assets)
+    ssd1306_draw_image(&disp, 0, 0, &splash);
+    ssd1306_draw_text(&disp, 0, 56, &fonte_5x8, "Iniciando...");
     ssd1306_show(&disp);
 }
 
 
 int main() {
+    mem_diag_init();        // Pinta as pilhas antes de elas crescerem
     stdio_init_all();
+    binlog_init();
+    clock_mgr_init();
+#if XIP_PERFIL
+    xip_cache_init();
+#endif
+    boot_trace_mark("inicio");
+    device_state_init();
 
-    // Inicializações de hardware
+    // Backoff com jitter vindo do DRBG: cada dispositivo da frota sorteia esperas diferentes.
+    // Antes do Wi-Fi: uma falha já no wifi_connect_async() agenda a nova tentativa por ele.
+    // Até o mqtt_init() semear o DRBG, rng_u32() usa o gerador de hardware.
+    reconnect_init(&g_reconnect, reconnect_default_policies, rng_u32, NULL);
+
+    // O Wi-Fi vem primeiro: a associação é a etapa mais lenta do boot e segue em
+    // segundo plano enquanto o restante do hardware e a criptografia inicializam.
+    wifi_init();
+    wifi_connect_async();
+    time_sync_init();
+
+    // Inicializações de hardware, intercaladas com o poll do cyw43 para a associação avançar
     adc_init();
     buttons_init();
+    cyw43_arch_poll();
     init_display();
-    wifi_init();
+    boot_trace_mark("display_ok");
+    cyw43_arch_poll();
 
-    // Tenta conectar ao Wi-Fi repetidamente
-    while (!wifi_connect()) {
-        printf("Falha ao conectar no Wi-Fi. Tentando novamente em 5 segundos...\n");
-        ssd1306_clear(&disp);
-        ssd1306_draw_string(&disp, 0, 0, 1, "Conectando WiFi...");
-        ssd1306_show(&disp);
-        sleep_ms(5000);
+    // DRBG e configuração TLS ficam prontos antes de existir rede
+    if (!mqtt_init()) {
+        printf("[MAIN] Falha ao inicializar a criptografia.\n");
     }
+    boot_trace_mark("cripto_ok");
+
+    // Canais de sensores: cada um com seu período e política de publicação
+    sensors_register(&canal_temperatura);
+
+    // Modo de energia (POWER_MODO): rádio, display, ADC e sono da CPU
+    power_init(&disp);
 
     printf("Inicialização completa. Entrando no loop principal...\n");
 
     // --- Temporizadores para todas as tarefas não-bloqueantes ---
-    absolute_time_t next_temp_read = get_absolute_time();
-    absolute_time_t next_mqtt_publish = get_absolute_time();
     absolute_time_t next_display_update = get_absolute_time();
     absolute_time_t next_mqtt_connect_attempt = get_absolute_time();
+    absolute_time_t next_xip_report = make_timeout_time_ms(XIP_PERFIL_INTERVALO_MS);
+    absolute_time_t next_mem_diag = make_timeout_time_ms(MEM_DIAG_INTERVALO_MS);
     
     // Variáveis para o estado dos botões
     bool last_button_a_state = false;
     bool last_button_b_state = false;
 
+    bool first_publish_done = false;
+
+    // Snapshot do estado compartilhado (temperatura e conexões)
+    device_state_t st;
+
     while (true) {
         // --- Loop Principal Não-Bloqueante ---
 
+        // 0: Mantém o Wi-Fi associado (reassocia em segundo plano se o link cair)
+        wifi_poll();
+        device_state_snapshot(&st);
+        if (!st.wifi_conectado && st.mqtt_conectado) {
+            printf("[MAIN] Wi-Fi caiu, encerrando sessão MQTT.\n");
+            mqtt_disconnect();
+            device_state_snapshot(&st);
+        }
+        time_sync_poll();
+        power_poll();
+        clock_mgr_poll();
+
         // 1: Verifica botões (sempre, para máxima responsividade)
         buttons_check_and_handle(&last_button_a_state, &last_button_b_state);
 
-        // 2: Ler a temperatura periodicamente
-        if (time_reached(next_temp_read)) {
-            temperatura_atual = read_onboard_temp_celsius();
-            //printf("[MAIN] Temperatura lida: %.2f °C\n", temperatura_atual); // Opcional: pode poluir o log
-            next_temp_read = make_timeout_time_ms(TEMPERATURE_READ_INTERVAL_MS);
+        // 2: Amostrar os sensores e enfileirar conforme a política de cada canal
+        // (no modo cíclico, só durante a rajada de rádio; até lá as amostras acumulam)
+        sensors_poll(st.mqtt_conectado && power_can_publish());
+
+        // 3: Esvaziar a fila de publicação: eventos primeiro, telemetria e diagnóstico
+        // só quando o modo de energia permite. Com mensagens na fila, o clock sobe para a
+        // cifra dos registros.
+        bool publica = st.mqtt_conectado && pub_queue_ready(power_can_publish());
+        if (publica) clock_mgr_pedir(CLOCK_MOTIVO_CRIPTO);
+        XIP_PERFIL_INICIO(&perfil_publicacao);
+        int publicados = pub_queue_service(st.mqtt_conectado, power_can_publish());
+        if (publicados > 0) {
+            XIP_PERFIL_FIM(&perfil_publicacao);     // Só as voltas que publicaram
+        }
+        if (publica) clock_mgr_liberar(CLOCK_MOTIVO_CRIPTO);
+        if (publicados < 0) {
+            printf("[MAIN] Falha ao publicar. A conexão pode ter caído.\n");
+            // A reconexão será tratada pelo passo 4, após uma espera aleatória curta
+            // para que dispositivos derrubados juntos não voltem todos no mesmo instante.
+            next_mqtt_connect_attempt = make_timeout_time_ms(reconnect_on_drop(&g_reconnect));
+        } else if (publicados > 0 && !first_publish_done) {
+            first_publish_done = true;
+            boot_trace_mark("primeira_publicacao");
+            boot_trace_report();
         }
 
-        // 3: Gerenciar a conexão MQTT de forma não-bloqueante
-        if (g_wifi_connected && !g_mqtt_connected && time_reached(next_mqtt_connect_attempt)) {
+        // 4: Gerenciar a conexão MQTT de forma não-bloqueante
+        device_state_snapshot(&st);     // A publicação pode ter derrubado a conexão
+        if (st.wifi_conectado && !st.mqtt_conectado && time_reached(next_mqtt_connect_attempt)) {
             printf("[MAIN] Wi-Fi OK, tentando conectar ao Broker MQTT...\n");
             
-            if (mqtt_connect()) {
-                // Sucesso! Agenda a primeira publicação imediatamente.
-                next_mqtt_publish = get_absolute_time();
+            clock_mgr_pedir(CLOCK_MOTIVO_HANDSHAKE);
+            bool conectou = mqtt_connect();
+            clock_mgr_liberar(CLOCK_MOTIVO_HANDSHAKE);
+            if (conectou) {
+                // Sucesso! Zera os orçamentos e publica as últimas leituras imediatamente.
+                reconnect_reset(&g_reconnect, RECONNECT_TCP);
+                reconnect_reset(&g_reconnect, RECONNECT_TLS);
+                sensors_request_publish();
             } else {
-                // Falha! Agenda a próxima tentativa sem bloquear o loop.
-                printf("[MAIN] Falha ao conectar ao MQTT. Tentando novamente em %d ms...\n", MQTT_RECONNECT_INTERVAL_MS);
-                next_mqtt_connect_attempt = make_timeout_time_ms(MQTT_RECONNECT_INTERVAL_MS);
+                // Falha! Agenda a próxima tentativa com backoff, sem bloquear o loop.
+                reconnect_class_t cls = mqtt_last_failure();
+                uint32_t delay_ms = reconnect_on_failure(&g_reconnect, cls);
+                printf("[MAIN] Falha ao conectar ao MQTT (%s). Tentando novamente em %lu ms...\n",
+                       cls == RECONNECT_TCP ? "TCP" : "TLS", (unsigned long)delay_ms);
+                next_mqtt_connect_attempt = make_timeout_time_ms(delay_ms);
             }
         }
 
-        // 4: Publicar dados via MQTT
-        if (g_mqtt_connected && time_reached(next_mqtt_publish)) {
-            char payload[16];
-            snprintf(payload, sizeof(payload), "%.2f", temperatura_atual);
-
-            if (!mqtt_publish(MQTT_TOPICO_TEMPERATURA, payload)) {
-                printf("[MAIN] Falha ao publicar. A conexão pode ter caído.\n");
-                // A reconexão será tratada automaticamente pelo passo 3.
-                next_mqtt_connect_attempt = get_absolute_time(); // Tenta reconectar imediatamente.
-            }
-            
-            next_mqtt_publish = make_timeout_time_ms(MQTT_PUBLISH_INTERVAL_MS);
-        }
-        
-        // 5: Atualizar Display (agora de forma muito mais rápida)
-        if (time_reached(next_display_update)) {
+        // 5: Atualizar Display (agora de forma muito mais rápida), se estiver ligado. Um
+        // snapshot único garante que IP, temperatura e MQTT exibidos são do mesmo instante.
+        device_state_snapshot(&st);
+        if (power_display_on() && time_reached(next_display_update)) {
+            clock_mgr_pedir(CLOCK_MOTIVO_TELA);
+            XIP_PERFIL_INICIO(&perfil_tela);    // Composição; o envio pelo I2C fica de fora
             ssd1306_clear(&disp);
             char line_buffer[32];
 
-            snprintf(line_buffer, sizeof(line_buffer), "IP: %s", ip4addr_ntoa(netif_ip4_addr(netif_default)));
-            ssd1306_draw_string(&disp, 0, 0, 1, line_buffer);
+            if (st.wifi_conectado) {
+                ip4_addr_t ip;
+                ip4_addr_set_u32(&ip, st.ipv4);
+                snprintf(line_buffer, sizeof(line_buffer), "IP: %s", ip4addr_ntoa(&ip));
+            } else {
+                snprintf(line_buffer, sizeof(line_buffer), "WiFi: %s", wifi_get_state() == WIFI_STATE_BACKOFF ? "falhou" : "conectando");
+            }
+            ssd1306_draw_text(&disp, 0, 0, &fonte_5x8, line_buffer);
 
-            snprintf(line_buffer, sizeof(line_buffer), "Temp: %.2f°C", temperatura_atual);
-            ssd1306_draw_string(&disp, 0, 16, 1, line_buffer);
+            // Temperatura em destaque, com a fonte de 16 px (ocupa as linhas 16 a 31)
+            ssd1306_draw_text(&disp, 0, 20, &fonte_5x8, "Temp:");
+            snprintf(line_buffer, sizeof(line_buffer), "%.2f°C", st.temperatura);
+            ssd1306_draw_text(&disp, 34, 16, &fonte_10x16, line_buffer);
             
-            snprintf(line_buffer, sizeof(line_buffer), "MQTT: %s", g_mqtt_connected ? "Conectado" : "Desconectado");
-            ssd1306_draw_string(&disp, 0, 32, 1, line_buffer);
+            snprintf(line_buffer, sizeof(line_buffer), "MQTT: %s", st.mqtt_conectado ? "Conectado" : "Desconectado");
+            ssd1306_draw_text(&disp, 0, 32, &fonte_5x8, line_buffer);
 
             snprintf(line_buffer, sizeof(line_buffer), "BTNS: A:%s B:%s", last_button_a_state ? "P" : "S", last_button_b_state ? "P" : "S");
-            ssd1306_draw_string(&disp, 0, 48, 1, line_buffer);
+            ssd1306_draw_text(&disp, 0, 48, &fonte_5x8, line_buffer);
+            XIP_PERFIL_FIM(&perfil_tela);
+            clock_mgr_liberar(CLOCK_MOTIVO_TELA);
 
             ssd1306_show(&disp);
             next_display_update = make_timeout_time_ms(DISPLAY_UPDATE_INTERVAL_MS);
         }
 
-        // 6: Permite que a pilha de rede Wi-Fi funcione e cede o controlo
-        // Esta função é otimizada para consumir muito pouca energia se não houver trabalho a fazer.
-        cyw43_arch_poll();
-        sleep_ms(1); // Um pequeno delay para evitar 100% de uso da CPU
+        // 6: Escoa pela USB os registros do log binário (gravados nos caminhos quentes e
+        // nos callbacks do lwIP sem formatar nada), o diagnóstico de memória e, com
+        // XIP_PERFIL, o perfil da cache XIP
+        binlog_poll();
+        if (getchar_timeout_us(0) == 'm') {
+            mem_diag_relata();
+        }
+        if (time_reached(next_mem_diag)) {
+            mem_diag_relata();
+            publica_memoria();
+            next_mem_diag = make_timeout_time_ms(MEM_DIAG_INTERVALO_MS);
+        }
+        if (XIP_PERFIL && time_reached(next_xip_report)) {
+            xip_regiao_relata(&perfil_publicacao);
+            xip_regiao_relata(&perfil_tela);
+            next_xip_report = make_timeout_time_ms(XIP_PERFIL_INTERVALO_MS);
+        }
+
+        // 7: Permite que a pilha de rede Wi-Fi funcione e cede o controlo até o próximo
+        // prazo (no modo contínuo, 1 ms; no cíclico, dorme até a próxima amostra ou botão)
+        absolute_time_t prazo = sensors_next_deadline();
+        if (st.mqtt_conectado && pub_queue_ready(power_can_publish())) {
+            prazo = get_absolute_time();    // Fila com mensagens além do limite por ciclo
+        }
+        if (binlog_pending()) {
+            prazo = get_absolute_time();    // Log além do limite escoado por volta
+        }
+        if (power_display_on() && absolute_time_diff_us(next_display_update, prazo) > 0) {
+            prazo = next_display_update;
+        }
+        if (absolute_time_diff_us(clock_mgr_prazo(), prazo) > 0) {
+            prazo = clock_mgr_prazo();      // Não dormir no clock alto
+        }
+        power_wait(prazo);
     }
 }
\ No newline at end of file
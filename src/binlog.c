@@ -0,0 +1,164 @@
+#include "binlog.h"
+#include "xip_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "hardware/sync.h"
+
+// Registro no buffer (little-endian, sem alinhamento):
+//   [0]    tamanho total do registro, em bytes
+//   [1]    nível << 4 | número de argumentos
+//   [2..5] endereço da string de formato
+//   [6..9] time_us_32() da chamada
+//   e, por argumento, 1 byte de tipo seguido de 4 bytes (I32/U32/F32/PTR), 8 bytes
+//   (I64/U64) ou 1 byte de tamanho e o texto, sem terminador (STR).
+#define BINLOG_CABECALHO     10
+#define BINLOG_REGISTRO_MAX  (BINLOG_CABECALHO + BINLOG_MAX_ARGS * (2 + BINLOG_STR_MAX))
+
+// Registros escoados por chamada de binlog_poll(): limita o tempo gasto na USB por volta
+#define BINLOG_DRENO_MAX     8
+
+#define BINLOG_MASCARA (BINLOG_BUF_SIZE - 1)
+
+static uint8_t buf[BINLOG_BUF_SIZE];
+static uint32_t head = 0;       // Próximo byte a escrever (só cresce; índice = & máscara)
+static uint32_t tail = 0;       // Próximo byte a escoar
+static uint32_t perdidos = 0;
+static uint32_t perdidos_avisados = 0;
+
+// Escritores em IRQ e nos dois cores: o spinlock de hardware também desliga as IRQs
+static spin_lock_t *lock = NULL;
+
+void binlog_init(void) {
+    lock = spin_lock_init((uint)spin_lock_claim_unused(true));
+}
+
+static uint8_t *binlog_put32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+void RAM_QUENTE(binlog_write)(uint8_t nivel, const char *fmt, unsigned nargs, const binlog_arg_t *args) {
+    uint8_t reg[BINLOG_REGISTRO_MAX];
+    uint8_t *p = reg + BINLOG_CABECALHO;
+
+    if (!lock) return;
+    if (nargs > BINLOG_MAX_ARGS) nargs = BINLOG_MAX_ARGS;
+
+    // O registro é montado fora da seção crítica; dentro dela só a cópia para o buffer
+    reg[1] = (uint8_t)(nivel << 4 | nargs);
+    binlog_put32(&reg[2], (uint32_t)(uintptr_t)fmt);
+    binlog_put32(&reg[6], time_us_32());
+    for (unsigned i = 0; i < nargs; i++) {
+        const binlog_arg_t *a = &args[i];
+        *p++ = a->tipo;
+        switch (a->tipo) {
+        case BINLOG_ARG_I64:
+        case BINLOG_ARG_U64:
+            p = binlog_put32(p, (uint32_t)a->u64);
+            p = binlog_put32(p, (uint32_t)(a->u64 >> 32));
+            break;
+        case BINLOG_ARG_F32: {
+            uint32_t bits;
+            memcpy(&bits, &a->f32, sizeof(bits));
+            p = binlog_put32(p, bits);
+            break;
+        }
+        case BINLOG_ARG_STR: {
+            const char *s = a->str ? a->str : "(null)";
+            size_t n = strnlen(s, BINLOG_STR_MAX);
+            *p++ = (uint8_t)n;
+            memcpy(p, s, n);
+            p += n;
+            break;
+        }
+        case BINLOG_ARG_PTR:
+            p = binlog_put32(p, (uint32_t)a->u64);
+            break;
+        default:
+            p = binlog_put32(p, a->u32);
+            break;
+        }
+    }
+    uint32_t len = (uint32_t)(p - reg);
+    reg[0] = (uint8_t)len;
+
+    // Buffer cheio: descarta o registro novo (os antigos ainda não foram vistos)
+    uint32_t irq = spin_lock_blocking(lock);
+    if (BINLOG_BUF_SIZE - (head - tail) < len) {
+        perdidos++;
+    } else {
+        uint32_t ini = head & BINLOG_MASCARA;
+        uint32_t ate_fim = BINLOG_BUF_SIZE - ini;
+        if (len <= ate_fim) {
+            memcpy(&buf[ini], reg, len);
+        } else {
+            memcpy(&buf[ini], reg, ate_fim);
+            memcpy(buf, reg + ate_fim, len - ate_fim);
+        }
+        head += len;
+    }
+    spin_unlock(lock, irq);
+}
+
+/**
+ * @brief Retira o registro mais antigo do buffer. Retorna o tamanho, ou 0 se vazio.
+ */
+static uint32_t binlog_pop(uint8_t *reg) {
+    uint32_t len = 0;
+    uint32_t irq = spin_lock_blocking(lock);
+    if (head != tail) {
+        len = buf[tail & BINLOG_MASCARA];
+        for (uint32_t i = 0; i < len; i++) {
+            reg[i] = buf[(tail + i) & BINLOG_MASCARA];
+        }
+        tail += len;
+    }
+    spin_unlock(lock, irq);
+    return len;
+}
+
+void binlog_poll(void) {
+    static const char hex[] = "0123456789abcdef";
+    uint8_t reg[BINLOG_REGISTRO_MAX];
+    char linha[3 + 2 * BINLOG_REGISTRO_MAX + 1];
+
+    // Sem terminal aberto os registros esperam no buffer, em vez de se perderem na USB
+    if (!lock || !stdio_usb_connected()) return;
+
+    if (perdidos != perdidos_avisados) {
+        uint32_t n = perdidos;
+        printf("[LOG] %lu registros descartados (buffer cheio).\n", (unsigned long)(n - perdidos_avisados));
+        perdidos_avisados = n;
+    }
+
+    for (int r = 0; r < BINLOG_DRENO_MAX; r++) {
+        uint32_t len = binlog_pop(reg);
+        if (len == 0) break;
+
+        char *q = linha;
+        *q++ = '@';
+        *q++ = 'L';
+        *q++ = ' ';
+        for (uint32_t i = 0; i < len; i++) {
+            *q++ = hex[reg[i] >> 4];
+            *q++ = hex[reg[i] & 0x0F];
+        }
+        *q = '\0';
+        puts(linha);
+    }
+}
+
+bool binlog_pending(void) {
+    return lock && head != tail && stdio_usb_connected();
+}
+
+uint32_t binlog_dropped(void) {
+    return perdidos;
+}
@@ -0,0 +1,44 @@
+#include "boot_trace.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "pico/stdlib.h"
+
+#define BOOT_TRACE_MAX_EVENTS 16
+
+typedef struct {
+    const char *evento;
+    uint64_t t_us;
+} boot_trace_event_t;
+
+static boot_trace_event_t events[BOOT_TRACE_MAX_EVENTS];
+static int event_count = 0;
+static bool reported = false;
+
+void boot_trace_mark(const char *evento) {
+    if (reported || event_count >= BOOT_TRACE_MAX_EVENTS) return;
+
+    // O timer começa a contar no reset, então time_us_64() já é o tempo desde o power-on
+    events[event_count].evento = evento;
+    events[event_count].t_us = time_us_64();
+    event_count++;
+}
+
+void boot_trace_report(void) {
+    if (reported) return;
+    reported = true;
+
+    printf("[BOOT] Linha do tempo do boot:\n");
+    uint64_t prev = 0;
+    for (int i = 0; i < event_count; i++) {
+        printf("[BOOT] %8llu us (+%7llu us) %s\n",
+               (unsigned long long)events[i].t_us,
+               (unsigned long long)(events[i].t_us - prev),
+               events[i].evento);
+        prev = events[i].t_us;
+    }
+    if (event_count > 0) {
+        printf("[BOOT] Time-to-first-publish: %llu ms\n", (unsigned long long)(events[event_count - 1].t_us / 1000));
+    }
+}
@@ -1,9 +1,25 @@
 #include "botoes.h"
 #include "pico/stdlib.h"
 #include "shared_vars.h"
-#include "mqtt.h"
+#include "pub_queue.h"
+#include "payload.h"
+#include "time_sync.h"
 #include <stdio.h>
 
+/**
+ * @brief Payload do evento no formato do tópico, montado ao sair da fila: t_us (instante
+ * da borda) é convertido para UTC só então, e leva horário mesmo se a borda veio antes da
+ * primeira sincronização.
+ */
+static size_t botoes_monta(const mqtt_topic_t *topic, uint32_t pressionado, uint64_t t_us, uint8_t *buf, size_t cap) {
+    return payload_botao(topic, pressionado != 0, time_sync_utc_ms(t_us), buf, cap);
+}
+
+// Enfileira o evento (classe prioritária) com o instante em que a borda foi detectada
+static void botoes_publica(const mqtt_topic_t *topic, bool pressionado, uint64_t t_us) {
+    pub_queue_push_evento(PUB_CLASSE_EVENTO, topic, botoes_monta, pressionado, t_us);
+}
+
 void buttons_init(void) {
     gpio_init(BUTTON_A_PIN);
     gpio_set_dir(BUTTON_A_PIN, GPIO_IN);
@@ -17,29 +33,27 @@ void buttons_init(void) {
 void buttons_check_and_handle(bool *last_a_state, bool *last_b_state) {
     bool current_a_state = !gpio_get(BUTTON_A_PIN); // Invertido: true se pressionado
     bool current_b_state = !gpio_get(BUTTON_B_PIN); // Invertido: true se pressionado
+    uint64_t agora = time_us_64();
 
     // Verifica Botão A
     if (current_a_state != *last_a_state) {
-        if (g_mqtt_connected) {
-            if (current_a_state) {
-                mqtt_publish(MQTT_TOPICO_BOTAO_A, "{\"estado\":\"pressionado\"}");
-            } else {
-                printf("[BOTOES] Botao A liberado!\n");
-                mqtt_publish(MQTT_TOPICO_BOTAO_A, "{\"estado\":\"liberado\"}");
-            }
+        // Sem conexão o evento fica na fila e sai, com o horário da borda, ao reconectar
+        if (current_a_state) {
+            botoes_publica(&mqtt_topic_botao_a, true, agora);
+        } else {
+            printf("[BOTOES] Botao A liberado!\n");
+            botoes_publica(&mqtt_topic_botao_a, false, agora);
         }
         *last_a_state = current_a_state;
     }
 
     // Verifica Botão B
     if (current_b_state != *last_b_state) {
-        if (g_mqtt_connected) {
-            if (current_b_state) {
-                mqtt_publish(MQTT_TOPICO_BOTAO_B, "{\"estado\":\"pressionado\"}");
-            } else {
-                printf("[BOTOES] Botao B liberado!\n");
-                mqtt_publish(MQTT_TOPICO_BOTAO_B, "{\"estado\":\"liberado\"}");
-            }
+        if (current_b_state) {
+            botoes_publica(&mqtt_topic_botao_b, true, agora);
+        } else {
+            printf("[BOTOES] Botao B liberado!\n");
+            botoes_publica(&mqtt_topic_botao_b, false, agora);
         }
         *last_b_state = current_b_state;
     }
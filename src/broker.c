@@ -0,0 +1,99 @@
+#include "broker.h"
+#include "shared_vars.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cada falha consecutiva pesa como um broker este tanto mais lento
+#define BROKER_PENALIDADE_MS  10000
+#define BROKER_FALHAS_MAX     8
+
+static broker_t brokers[BROKER_MAX];
+static int broker_n = 0;
+static int vencedor = -1;
+
+bool broker_init(void) {
+    const char *p = BROKER_LISTA;
+
+    broker_n = 0;
+    vencedor = -1;
+    while (*p && broker_n < BROKER_MAX) {
+        const char *fim = strchr(p, ',');
+        size_t len = fim ? (size_t)(fim - p) : strlen(p);
+        const char *sep = memchr(p, ':', len);
+
+        if (sep && (size_t)(sep - p) < sizeof(brokers[0].host) && sep > p) {
+            broker_t *b = &brokers[broker_n];
+            memset(b, 0, sizeof(*b));
+            memcpy(b->host, p, (size_t)(sep - p));
+            b->port = (uint16_t)atoi(sep + 1);
+            b->protocol_version = MQTT_VERSAO;
+            if (b->port) broker_n++;
+        }
+        if (!fim) break;
+        p = fim + 1;
+    }
+
+    if (broker_n == 0) {
+        printf("[BROKER] BROKER_LISTA sem entradas válidas.\n");
+        return false;
+    }
+    for (int i = 0; i < broker_n; i++) {
+        printf("[BROKER] %d: %s:%u\n", i, brokers[i].host, brokers[i].port);
+    }
+    return true;
+}
+
+int broker_count(void) {
+    return broker_n;
+}
+
+broker_t *broker_get(int i) {
+    return &brokers[i];
+}
+
+/**
+ * @brief Pontuação (menor é melhor): tempo médio de conexão mais a penalidade por falhas.
+ */
+static uint32_t broker_score(const broker_t *b) {
+    return b->custo_ms + (uint32_t)b->falhas * BROKER_PENALIDADE_MS;
+}
+
+int broker_candidates(int *out, int max) {
+    int n = 0;
+    bool usado[BROKER_MAX] = { false };
+
+    // O último vencedor vai na frente enquanto continuar respondendo
+    if (vencedor >= 0 && brokers[vencedor].falhas == 0 && n < max) {
+        out[n++] = vencedor;
+        usado[vencedor] = true;
+    }
+    // Demais por pontuação; empate mantém a ordem da lista
+    while (n < max) {
+        int melhor = -1;
+        for (int i = 0; i < broker_n; i++) {
+            if (usado[i]) continue;
+            if (melhor < 0 || broker_score(&brokers[i]) < broker_score(&brokers[melhor])) melhor = i;
+        }
+        if (melhor < 0) break;
+        out[n++] = melhor;
+        usado[melhor] = true;
+    }
+    return n;
+}
+
+void broker_report_success(int i, uint32_t tempo_ms) {
+    broker_t *b = &brokers[i];
+    b->custo_ms = b->custo_ms ? (3 * b->custo_ms + tempo_ms) / 4 : tempo_ms;
+    b->falhas = 0;
+    b->conexoes++;
+    vencedor = i;
+    printf("[BROKER] Conectado a %s:%u em %lu ms (média %lu ms).\n",
+           b->host, b->port, (unsigned long)tempo_ms, (unsigned long)b->custo_ms);
+}
+
+void broker_report_failure(int i) {
+    broker_t *b = &brokers[i];
+    if (b->falhas < BROKER_FALHAS_MAX) b->falhas++;
+}
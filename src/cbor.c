@@ -0,0 +1,328 @@
+#include "cbor.h"
+
+#include <math.h>
+#include <string.h>
+
+// Tipos maiores (3 bits superiores do byte inicial)
+#define CBOR_MAJOR_UINT   0
+#define CBOR_MAJOR_NEGINT 1
+#define CBOR_MAJOR_BYTES  2
+#define CBOR_MAJOR_TEXT   3
+#define CBOR_MAJOR_ARRAY  4
+#define CBOR_MAJOR_MAP    5
+#define CBOR_MAJOR_TAG    6
+#define CBOR_MAJOR_SIMPLE 7
+
+// Valores simples e floats (tipo maior 7)
+#define CBOR_FALSE     20
+#define CBOR_TRUE      21
+#define CBOR_NULL      22
+#define CBOR_UNDEFINED 23
+#define CBOR_FLOAT16   25
+#define CBOR_FLOAT32   26
+#define CBOR_FLOAT64   27
+
+// Profundidade máxima aceita por cbor_skip()
+#define CBOR_MAX_DEPTH 8
+
+// --- Codificação ---
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t cap) {
+    w->buf = buf;
+    w->cap = cap;
+    w->len = 0;
+    w->overflow = false;
+}
+
+static void cbor_write(cbor_writer_t *w, const void *data, size_t n) {
+    if (w->overflow || n > w->cap - w->len) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(&w->buf[w->len], data, n);
+    w->len += n;
+}
+
+/**
+ * @brief Escreve o cabeçalho de um item com o argumento na menor forma possível.
+ */
+static void cbor_put_head(cbor_writer_t *w, uint8_t major, uint64_t arg) {
+    uint8_t head[9];
+    size_t n;
+
+    major <<= 5;
+    if (arg < 24) {
+        head[0] = major | (uint8_t)arg;
+        n = 1;
+    } else if (arg <= 0xFF) {
+        head[0] = major | 24;
+        head[1] = (uint8_t)arg;
+        n = 2;
+    } else if (arg <= 0xFFFF) {
+        head[0] = major | 25;
+        head[1] = (uint8_t)(arg >> 8);
+        head[2] = (uint8_t)arg;
+        n = 3;
+    } else if (arg <= 0xFFFFFFFFu) {
+        head[0] = major | 26;
+        for (int i = 0; i < 4; i++) head[1 + i] = (uint8_t)(arg >> (24 - 8 * i));
+        n = 5;
+    } else {
+        head[0] = major | 27;
+        for (int i = 0; i < 8; i++) head[1 + i] = (uint8_t)(arg >> (56 - 8 * i));
+        n = 9;
+    }
+    cbor_write(w, head, n);
+}
+
+void cbor_put_uint(cbor_writer_t *w, uint64_t v) {
+    cbor_put_head(w, CBOR_MAJOR_UINT, v);
+}
+
+void cbor_put_int(cbor_writer_t *w, int64_t v) {
+    if (v >= 0) {
+        cbor_put_head(w, CBOR_MAJOR_UINT, (uint64_t)v);
+    } else {
+        // -1 - n, sem estourar em INT64_MIN
+        cbor_put_head(w, CBOR_MAJOR_NEGINT, ~(uint64_t)v);
+    }
+}
+
+void cbor_put_bool(cbor_writer_t *w, bool v) {
+    uint8_t b = (CBOR_MAJOR_SIMPLE << 5) | (v ? CBOR_TRUE : CBOR_FALSE);
+    cbor_write(w, &b, 1);
+}
+
+void cbor_put_null(cbor_writer_t *w) {
+    uint8_t b = (CBOR_MAJOR_SIMPLE << 5) | CBOR_NULL;
+    cbor_write(w, &b, 1);
+}
+
+/**
+ * @brief Converte float32 em meia precisão, se a conversão for exata.
+ */
+static bool cbor_float_to_half(float v, uint16_t *half) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+
+    uint16_t sign = (bits >> 16) & 0x8000;
+    int32_t exp = (int32_t)((bits >> 23) & 0xFF);
+    uint32_t mant = bits & 0x7FFFFF;
+
+    if (exp == 0xFF) {
+        // Infinito ou NaN (NaN vira o NaN canônico de meia precisão)
+        *half = sign | 0x7C00 | (mant ? 0x200 : 0);
+        return true;
+    }
+    if (exp == 0 && mant == 0) {
+        *half = sign;
+        return true;
+    }
+
+    int32_t e = exp - 127 + 15;
+    if (e >= 31) return false;
+    if (e >= 1) {
+        if (mant & 0x1FFF) return false;        // Perderia bits da mantissa
+        *half = sign | (uint16_t)(e << 10) | (uint16_t)(mant >> 13);
+        return true;
+    }
+
+    // Subnormal em meia precisão
+    if (exp == 0 || e < -10) return false;
+    uint32_t full = mant | 0x800000;
+    uint32_t shift = (uint32_t)(14 - e);
+    if (full & ((1u << shift) - 1)) return false;
+    *half = sign | (uint16_t)(full >> shift);
+    return true;
+}
+
+void cbor_put_float(cbor_writer_t *w, float v) {
+    uint8_t out[5];
+    uint16_t half;
+
+    if (cbor_float_to_half(v, &half)) {
+        out[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_FLOAT16;
+        out[1] = (uint8_t)(half >> 8);
+        out[2] = (uint8_t)half;
+        cbor_write(w, out, 3);
+        return;
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    out[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_FLOAT32;
+    for (int i = 0; i < 4; i++) out[1 + i] = (uint8_t)(bits >> (24 - 8 * i));
+    cbor_write(w, out, 5);
+}
+
+void cbor_put_text(cbor_writer_t *w, const char *s, size_t len) {
+    cbor_put_head(w, CBOR_MAJOR_TEXT, len);
+    cbor_write(w, s, len);
+}
+
+void cbor_put_bytes(cbor_writer_t *w, const uint8_t *data, size_t len) {
+    cbor_put_head(w, CBOR_MAJOR_BYTES, len);
+    cbor_write(w, data, len);
+}
+
+void cbor_put_array(cbor_writer_t *w, size_t n) {
+    cbor_put_head(w, CBOR_MAJOR_ARRAY, n);
+}
+
+void cbor_put_map(cbor_writer_t *w, size_t n) {
+    cbor_put_head(w, CBOR_MAJOR_MAP, n);
+}
+
+void cbor_put_tag(cbor_writer_t *w, uint64_t tag) {
+    cbor_put_head(w, CBOR_MAJOR_TAG, tag);
+}
+
+size_t cbor_writer_finish(const cbor_writer_t *w) {
+    return w->overflow ? 0 : w->len;
+}
+
+// --- Decodificação ---
+
+void cbor_reader_init(cbor_reader_t *r, const uint8_t *buf, size_t len) {
+    r->buf = buf;
+    r->len = len;
+    r->pos = 0;
+}
+
+static bool cbor_read_be(cbor_reader_t *r, size_t n, uint64_t *out) {
+    if (n > r->len - r->pos) return false;
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++) v = (v << 8) | r->buf[r->pos + i];
+    r->pos += n;
+    *out = v;
+    return true;
+}
+
+static double cbor_half_to_double(uint16_t h) {
+    int exp = (h >> 10) & 0x1F;
+    int mant = h & 0x3FF;
+    double v;
+
+    if (exp == 0) {
+        v = mant / 16777216.0;                  // mant * 2^-24
+    } else if (exp == 31) {
+        v = mant ? NAN : INFINITY;
+    } else {
+        v = (mant + 1024) / 1024.0;
+        for (; exp > 15; exp--) v *= 2;
+        for (; exp < 15; exp++) v /= 2;
+    }
+    return (h & 0x8000) ? -v : v;
+}
+
+bool cbor_read(cbor_reader_t *r, cbor_item_t *item) {
+    if (r->pos >= r->len) return false;
+
+    uint8_t initial = r->buf[r->pos++];
+    uint8_t major = initial >> 5;
+    uint8_t info = initial & 0x1F;
+    uint64_t arg;
+
+    if (major == CBOR_MAJOR_SIMPLE) {
+        switch (info) {
+        case CBOR_FALSE:
+        case CBOR_TRUE:
+            item->type = CBOR_TYPE_BOOL;
+            item->b = info == CBOR_TRUE;
+            return true;
+        case CBOR_NULL:
+            item->type = CBOR_TYPE_NULL;
+            return true;
+        case CBOR_UNDEFINED:
+            item->type = CBOR_TYPE_UNDEFINED;
+            return true;
+        case CBOR_FLOAT16:
+            if (!cbor_read_be(r, 2, &arg)) return false;
+            item->type = CBOR_TYPE_FLOAT;
+            item->f = cbor_half_to_double((uint16_t)arg);
+            return true;
+        case CBOR_FLOAT32: {
+            if (!cbor_read_be(r, 4, &arg)) return false;
+            uint32_t bits = (uint32_t)arg;
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            item->type = CBOR_TYPE_FLOAT;
+            item->f = f;
+            return true;
+        }
+        case CBOR_FLOAT64:
+            if (!cbor_read_be(r, 8, &arg)) return false;
+            item->type = CBOR_TYPE_FLOAT;
+            memcpy(&item->f, &arg, sizeof(item->f));
+            return true;
+        default:
+            return false;       // Outros valores simples e o "break" não são usados
+        }
+    }
+
+    // Argumento: no próprio byte inicial ou nos 1/2/4/8 bytes seguintes
+    if (info < 24) {
+        arg = info;
+    } else if (info <= 27) {
+        if (!cbor_read_be(r, (size_t)1 << (info - 24), &arg)) return false;
+    } else {
+        return false;           // Tamanho indefinido ou reservado
+    }
+
+    switch (major) {
+    case CBOR_MAJOR_UINT:
+        item->type = CBOR_TYPE_UINT;
+        item->u = arg;
+        return true;
+    case CBOR_MAJOR_NEGINT:
+        if (arg > INT64_MAX) return false;
+        item->type = CBOR_TYPE_NEGINT;
+        item->i = -1 - (int64_t)arg;
+        return true;
+    case CBOR_MAJOR_BYTES:
+    case CBOR_MAJOR_TEXT:
+        if (arg > r->len - r->pos) return false;
+        item->type = major == CBOR_MAJOR_BYTES ? CBOR_TYPE_BYTES : CBOR_TYPE_TEXT;
+        item->str.ptr = &r->buf[r->pos];
+        item->str.len = (size_t)arg;
+        r->pos += (size_t)arg;
+        return true;
+    case CBOR_MAJOR_ARRAY:
+        item->type = CBOR_TYPE_ARRAY;
+        item->count = arg;
+        return true;
+    case CBOR_MAJOR_MAP:
+        item->type = CBOR_TYPE_MAP;
+        item->count = arg;
+        return true;
+    default:
+        item->type = CBOR_TYPE_TAG;
+        item->u = arg;
+        return true;
+    }
+}
+
+static bool cbor_skip_depth(cbor_reader_t *r, int depth) {
+    cbor_item_t item;
+
+    if (depth > CBOR_MAX_DEPTH || !cbor_read(r, &item)) return false;
+
+    switch (item.type) {
+    case CBOR_TYPE_ARRAY:
+    case CBOR_TYPE_MAP: {
+        uint64_t n = item.type == CBOR_TYPE_MAP ? item.count * 2 : item.count;
+        for (uint64_t i = 0; i < n; i++) {
+            if (!cbor_skip_depth(r, depth + 1)) return false;
+        }
+        return true;
+    }
+    case CBOR_TYPE_TAG:
+        return cbor_skip_depth(r, depth + 1);
+    default:
+        return true;
+    }
+}
+
+bool cbor_skip(cbor_reader_t *r) {
+    return cbor_skip_depth(r, 0);
+}
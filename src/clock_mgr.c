@@ -0,0 +1,254 @@
+#include "clock_mgr.h"
+#include "shared_vars.h"
+#include "xip_cache.h"
+
+#include <stdio.h>
+
+#include "hardware/clocks.h"
+#include "hardware/pll.h"
+#include "hardware/vreg.h"
+#if CYW43_PIO_CLOCK_DIV_DYNAMIC
+#include "pico/cyw43_driver.h"
+#endif
+
+#ifndef CLOCK_ESCALA
+#define CLOCK_ESCALA 1
+#endif
+
+typedef struct {
+    const char *nome;
+    uint32_t khz;
+    enum vreg_voltage vreg;
+    // Calculados em clock_mgr_init() (check_sys_clock_khz), para a troca não procurar
+    uint vco;
+    uint pd1, pd2;
+} clock_nivel_cfg_t;
+
+static clock_nivel_cfg_t niveis[CLOCK_NIVEIS] = {
+    [CLOCK_OCIOSO] = { "ocioso", CLOCK_OCIOSO_KHZ, CLOCK_OCIOSO_VREG },
+    [CLOCK_NORMAL] = { "normal", CLOCK_NORMAL_KHZ, CLOCK_NORMAL_VREG },
+    [CLOCK_RAJADA] = { "rajada", CLOCK_RAJADA_KHZ, CLOCK_RAJADA_VREG },
+};
+
+static const clock_nivel_t nivel_do_motivo[CLOCK_MOTIVOS] = {
+    [CLOCK_MOTIVO_HANDSHAKE] = CLOCK_RAJADA,
+    [CLOCK_MOTIVO_CRIPTO] = CLOCK_RAJADA,
+    [CLOCK_MOTIVO_TELA] = CLOCK_NORMAL,
+};
+
+static struct {
+    i2c_inst_t *i2c;
+    uint baudrate;
+} barramentos[CLOCK_MAX_I2C];
+static int n_barramentos = 0;
+
+static bool ativo = false;
+static clock_nivel_t nivel = CLOCK_NORMAL;
+static enum vreg_voltage vreg_atual = VREG_VOLTAGE_DEFAULT;
+static uint32_t motivos = 0;                // Bit por clock_motivo_t com pedido em aberto
+static bool desce_pendente = false;
+static absolute_time_t desce_em;
+
+// Contabilidade
+static clock_stats_t stats;
+static clock_stats_t stats_relatorio;       // Totais no último relatório
+static uint64_t marca_us;
+static absolute_time_t proximo_relatorio;
+
+/**
+ * @brief Atribui o tempo desde a última marca ao nível atual.
+ */
+static void clock_account(void) {
+    uint64_t agora = time_us_64();
+    stats.tempo_us[nivel] += agora - marca_us;
+    marca_us = agora;
+}
+
+static clock_nivel_t nivel_pedido(void) {
+    clock_nivel_t n = CLOCK_OCIOSO;
+    for (int m = 0; m < CLOCK_MOTIVOS; m++) {
+        if ((motivos & (1u << m)) && nivel_do_motivo[m] > n) n = nivel_do_motivo[m];
+    }
+    return n;
+}
+
+/**
+ * @brief Reajusta o que depende do clk_sys: clk_peri, baud do I2C e divisor do PIO do CYW43.
+ */
+static void clock_ajusta_perifericos(uint32_t khz) {
+    // Algumas versões do SDK voltam o clk_peri para o clk_sys em set_sys_clock_pll()
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, 48 * MHZ, 48 * MHZ);
+
+    for (int i = 0; i < n_barramentos; i++) {
+        i2c_set_baudrate(barramentos[i].i2c, barramentos[i].baudrate);
+    }
+
+#if CYW43_PIO_CLOCK_DIV_DYNAMIC
+    // Divisor em 8.8 bits que mantém o PIO em até CLOCK_CYW43_PIO_MAX_KHZ
+    uint32_t div256 = (khz * 256u + CLOCK_CYW43_PIO_MAX_KHZ - 1) / CLOCK_CYW43_PIO_MAX_KHZ;
+    if (div256 < 256) div256 = 256;
+    cyw43_set_pio_clkdiv_int_frac8(div256 >> 8, (uint8_t)div256);
+#else
+    (void)khz;
+#endif
+}
+
+/**
+ * @brief Troca o clk_sys para o nível 'n', com a tensão do núcleo na ordem certa.
+ */
+static bool clock_aplica(clock_nivel_t n) {
+    const clock_nivel_cfg_t *c = &niveis[n];
+    uint64_t t0 = time_us_64();
+
+    clock_account();
+
+    // Tensão sobe antes do PLL e desce depois dele
+    if (c->vreg > vreg_atual) {
+        vreg_set_voltage(c->vreg);
+        vreg_atual = c->vreg;
+        busy_wait_us(CLOCK_VREG_ESPERA_US);
+    }
+    set_sys_clock_pll(c->vco, c->pd1, c->pd2);
+    if (clock_get_hz(clk_sys) / 1000 != c->khz) {
+        stats.falhas++;
+        printf("[CLOCK] Falha ao trocar para %lu kHz.\n", (unsigned long)c->khz);
+        return false;
+    }
+    if (c->vreg < vreg_atual) {
+        vreg_set_voltage(c->vreg);
+        vreg_atual = c->vreg;
+    }
+    clock_ajusta_perifericos(c->khz);
+    xip_cache_clock(c->khz * 1000u);        // Perfil XIP: ciclos e somas no clock novo
+
+    nivel = n;
+    stats.trocas++;
+    stats.troca_us += time_us_64() - t0;
+    marca_us = time_us_64();                // O tempo da troca não conta para nenhum nível
+    return true;
+}
+
+void clock_mgr_init(void) {
+    marca_us = time_us_64();
+    proximo_relatorio = make_timeout_time_ms(CLOCK_RELATORIO_MS);
+
+    if (!CLOCK_ESCALA) {
+        printf("[CLOCK] Escala desligada: %lu kHz fixos.\n", (unsigned long)(clock_get_hz(clk_sys) / 1000));
+        return;
+    }
+
+    for (int n = 0; n < CLOCK_NIVEIS; n++) {
+        clock_nivel_cfg_t *c = &niveis[n];
+        if (!check_sys_clock_khz(c->khz, &c->vco, &c->pd1, &c->pd2)) {
+            printf("[CLOCK] %lu kHz (nível %s) não sai do PLL. Escala desligada.\n",
+                   (unsigned long)c->khz, c->nome);
+            return;
+        }
+#if !CYW43_PIO_CLOCK_DIV_DYNAMIC
+        if (c->khz > 2 * CLOCK_CYW43_PIO_MAX_KHZ) {
+            printf("[CLOCK] %lu kHz (nível %s) passa do limite do PIO do CYW43 sem "
+                   "CYW43_PIO_CLOCK_DIV_DYNAMIC. Escala desligada.\n", (unsigned long)c->khz, c->nome);
+            return;
+        }
+#endif
+    }
+
+    if (clock_get_hz(clk_sys) / 1000 != niveis[CLOCK_NORMAL].khz) {
+        if (!clock_aplica(CLOCK_NORMAL)) return;
+        stats.trocas = 0;
+        stats.troca_us = 0;
+    } else {
+        clock_ajusta_perifericos(niveis[CLOCK_NORMAL].khz);
+    }
+    ativo = true;
+    desce_pendente = true;
+    desce_em = make_timeout_time_ms(CLOCK_DESCE_MS);
+
+    printf("[CLOCK] Escala ligada: ocioso %lu, normal %lu e rajada %lu kHz.\n",
+           (unsigned long)niveis[CLOCK_OCIOSO].khz, (unsigned long)niveis[CLOCK_NORMAL].khz,
+           (unsigned long)niveis[CLOCK_RAJADA].khz);
+}
+
+bool clock_mgr_add_i2c(i2c_inst_t *i2c, uint baudrate) {
+    if (n_barramentos >= CLOCK_MAX_I2C) return false;
+    barramentos[n_barramentos].i2c = i2c;
+    barramentos[n_barramentos].baudrate = baudrate;
+    n_barramentos++;
+    return true;
+}
+
+void clock_mgr_pedir(clock_motivo_t motivo) {
+    motivos |= 1u << motivo;
+    if (!ativo) return;
+
+    clock_nivel_t alvo = nivel_pedido();
+    if (alvo > nivel) clock_aplica(alvo);
+    if (alvo >= nivel) desce_pendente = false;
+}
+
+void clock_mgr_liberar(clock_motivo_t motivo) {
+    motivos &= ~(1u << motivo);
+    if (!ativo) return;
+
+    // Cada liberação adia a descida: trabalho em sequência não paga trocas a cada volta
+    if (nivel_pedido() < nivel) {
+        desce_pendente = true;
+        desce_em = make_timeout_time_ms(CLOCK_DESCE_MS);
+    }
+}
+
+/**
+ * @brief Imprime o tempo em cada nível e as trocas desde o último relatório.
+ */
+static void clock_report(void) {
+    clock_account();
+
+    uint64_t tempo[CLOCK_NIVEIS], total_us = 0;
+    for (int n = 0; n < CLOCK_NIVEIS; n++) {
+        tempo[n] = stats.tempo_us[n] - stats_relatorio.tempo_us[n];
+        total_us += tempo[n];
+    }
+    if (total_us == 0) return;
+    uint32_t trocas = stats.trocas - stats_relatorio.trocas;
+    uint64_t troca_us = stats.troca_us - stats_relatorio.troca_us;
+
+    printf("[CLOCK] %llu s:", (unsigned long long)(total_us / 1000000));
+    for (int n = 0; n < CLOCK_NIVEIS; n++) {
+        printf(" %s %lu MHz %.1f%%%s", niveis[n].nome, (unsigned long)(niveis[n].khz / 1000),
+               100.0 * tempo[n] / total_us, n + 1 < CLOCK_NIVEIS ? "," : "");
+    }
+    printf(" | %lu trocas", (unsigned long)trocas);
+    if (trocas) printf(" (%llu us em média)", (unsigned long long)(troca_us / trocas));
+    if (stats.falhas) printf(", %lu falhas", (unsigned long)stats.falhas);
+    printf("\n");
+
+    stats_relatorio = stats;
+}
+
+void clock_mgr_poll(void) {
+    if (ativo && desce_pendente && time_reached(desce_em)) {
+        desce_pendente = false;
+        clock_nivel_t alvo = nivel_pedido();
+        if (alvo < nivel) clock_aplica(alvo);
+    }
+    if (time_reached(proximo_relatorio)) {
+        clock_report();
+        proximo_relatorio = make_timeout_time_ms(CLOCK_RELATORIO_MS);
+    }
+}
+
+absolute_time_t clock_mgr_prazo(void) {
+    if (ativo && desce_pendente && absolute_time_diff_us(desce_em, proximo_relatorio) > 0) {
+        return desce_em;
+    }
+    return proximo_relatorio;
+}
+
+clock_nivel_t clock_mgr_nivel(void) {
+    return nivel;
+}
+
+void clock_mgr_stats(clock_stats_t *out) {
+    clock_account();
+    *out = stats;
+}
@@ -0,0 +1,45 @@
+// Liga os núcleos de src/crypto_kernels.c ao mbedTLS pelos hooks _ALT de inc/mbedtls_config.h.
+// O mbedTLS continua responsável pela expansão de chave, pelos modos (CBC) e pelo HMAC;
+// aqui entram só a cifra de um bloco e a compressão do SHA-256.
+#define MBEDTLS_ALLOW_PRIVATE_ACCESS
+
+#include "crypto_kernels.h"
+#include "xip_cache.h"
+
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+
+#if defined(MBEDTLS_AES_ENCRYPT_ALT) || defined(MBEDTLS_AES_DECRYPT_ALT)
+static inline const uint32_t *aes_rk(const mbedtls_aes_context *ctx) {
+    return ctx->MBEDTLS_PRIVATE(buf) + ctx->MBEDTLS_PRIVATE(rk_offset);
+}
+#endif
+
+#if defined(MBEDTLS_AES_ENCRYPT_ALT)
+int RAM_QUENTE(mbedtls_internal_aes_encrypt)(mbedtls_aes_context *ctx, const unsigned char input[16], unsigned char output[16]) {
+#if CRYPTO_AES_TEMPO_CONSTANTE
+    crypto_aes_encrypt_ct(aes_rk(ctx), ctx->MBEDTLS_PRIVATE(nr), input, output);
+#else
+    crypto_aes_encrypt_table(aes_rk(ctx), ctx->MBEDTLS_PRIVATE(nr), input, output);
+#endif
+    return 0;
+}
+#endif
+
+#if defined(MBEDTLS_AES_DECRYPT_ALT)
+int RAM_QUENTE(mbedtls_internal_aes_decrypt)(mbedtls_aes_context *ctx, const unsigned char input[16], unsigned char output[16]) {
+#if CRYPTO_AES_TEMPO_CONSTANTE
+    crypto_aes_decrypt_ct(aes_rk(ctx), ctx->MBEDTLS_PRIVATE(nr), input, output);
+#else
+    crypto_aes_decrypt_table(aes_rk(ctx), ctx->MBEDTLS_PRIVATE(nr), input, output);
+#endif
+    return 0;
+}
+#endif
+
+#if defined(MBEDTLS_SHA256_PROCESS_ALT)
+int RAM_QUENTE(mbedtls_internal_sha256_process)(mbedtls_sha256_context *ctx, const unsigned char data[64]) {
+    crypto_sha256_block(ctx->MBEDTLS_PRIVATE(state), data);
+    return 0;
+}
+#endif
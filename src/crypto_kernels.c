@@ -0,0 +1,544 @@
+#include "crypto_kernels.h"
+#include "xip_cache.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// Leitura/escrita little-endian e big-endian sem depender do alinhamento
+static inline uint32_t le32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline void put_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t be32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+static inline uint32_t rotl8(uint32_t x) {
+    return x << 8 | x >> 24;
+}
+
+static inline uint32_t rotr(uint32_t x, unsigned n) {
+    return x >> n | x << (32 - n);
+}
+
+// =====================================================================================
+// Tabelas do AES
+// =====================================================================================
+
+// Ficam na SRAM (.bss) e são geradas no primeiro uso: 2,5 KB no total, contra 8 KB das
+// quatro tabelas por sentido do mbedTLS.
+static uint32_t ft[256];    // {2s, s, s, 3s} de s = S-box[i] (FT0 do mbedTLS)
+static uint32_t rt[256];    // {e·r, 9·r, d·r, b·r} de r = S-box inversa[i] (RT0)
+static uint8_t fsb[256];
+static uint8_t rsb[256];
+static bool tabelas_prontas = false;
+
+static inline uint8_t xtime(uint8_t x) {
+    return (uint8_t)(x << 1 ^ ((x & 0x80) ? 0x1B : 0x00));
+}
+
+static uint8_t gf_mul(uint8_t a, uint8_t b) {
+    uint8_t p = 0;
+    while (b) {
+        if (b & 1) p ^= a;
+        a = xtime(a);
+        b >>= 1;
+    }
+    return p;
+}
+
+/**
+ * @brief Gera S-boxes e T-tables a partir do gerador 3 do GF(2^8) (como aes_gen_tables()).
+ */
+static void aes_gen_tables(void) {
+    uint8_t pow[256], log[256];
+    uint8_t x = 1;
+
+    for (int i = 0; i < 256; i++) {
+        pow[i] = x;
+        log[x] = (uint8_t)i;
+        x ^= xtime(x);
+    }
+
+    fsb[0x00] = 0x63;
+    rsb[0x63] = 0x00;
+    for (int i = 1; i < 256; i++) {
+        uint8_t inv = pow[255 - log[i]];
+        uint8_t s = inv;
+        for (int k = 0; k < 4; k++) {
+            inv = (uint8_t)(inv << 1 | inv >> 7);
+            s ^= inv;
+        }
+        s ^= 0x63;
+        fsb[i] = s;
+        rsb[s] = (uint8_t)i;
+    }
+
+    for (int i = 0; i < 256; i++) {
+        uint8_t s = fsb[i];
+        uint8_t s2 = xtime(s);
+        ft[i] = (uint32_t)s2 | (uint32_t)s << 8 | (uint32_t)s << 16 | (uint32_t)(s2 ^ s) << 24;
+
+        uint8_t r = rsb[i];
+        rt[i] = (uint32_t)gf_mul(r, 0x0E) | (uint32_t)gf_mul(r, 0x09) << 8 |
+                (uint32_t)gf_mul(r, 0x0D) << 16 | (uint32_t)gf_mul(r, 0x0B) << 24;
+    }
+    tabelas_prontas = true;
+}
+
+static inline void aes_tables(void) {
+    if (!tabelas_prontas) aes_gen_tables();
+}
+
+// =====================================================================================
+// Expansão de chave
+// =====================================================================================
+
+static inline uint32_t sub_word(uint32_t w) {
+    return (uint32_t)fsb[w & 0xFF] | (uint32_t)fsb[(w >> 8) & 0xFF] << 8 |
+           (uint32_t)fsb[(w >> 16) & 0xFF] << 16 | (uint32_t)fsb[w >> 24] << 24;
+}
+
+int crypto_aes_setkey_enc(uint32_t *rk, const uint8_t *key, unsigned bits) {
+    int nk;
+
+    switch (bits) {
+    case 128: nk = 4; break;
+    case 192: nk = 6; break;
+    case 256: nk = 8; break;
+    default: return 0;
+    }
+    aes_tables();
+
+    int total = 4 * (nk + 7);
+    uint8_t rcon = 0x01;
+    for (int i = 0; i < nk; i++) {
+        rk[i] = le32(key + 4 * i);
+    }
+    for (int i = nk; i < total; i++) {
+        uint32_t t = rk[i - 1];
+        if (i % nk == 0) {
+            t = sub_word(t >> 8 | t << 24) ^ rcon;      // RotWord + SubWord + Rcon
+            rcon = xtime(rcon);
+        } else if (nk > 6 && i % nk == 4) {
+            t = sub_word(t);
+        }
+        rk[i] = rk[i - nk] ^ t;
+    }
+    return nk + 6;
+}
+
+int crypto_aes_setkey_dec(uint32_t *rk, const uint8_t *key, unsigned bits) {
+    uint32_t enc[60];
+    int nr = crypto_aes_setkey_enc(enc, key, bits);
+    if (nr == 0) return 0;
+
+    // Rodadas em ordem inversa; as do meio passam por InvMixColumns (rt[fsb[x]])
+    for (int r = 0; r <= nr; r++) {
+        const uint32_t *sk = enc + 4 * (nr - r);
+        for (int j = 0; j < 4; j++) {
+            uint32_t w = sk[j];
+            if (r == 0 || r == nr) {
+                rk[4 * r + j] = w;
+            } else {
+                rk[4 * r + j] = rt[fsb[w & 0xFF]] ^ rotl8(rt[fsb[(w >> 8) & 0xFF]] ^
+                                rotl8(rt[fsb[(w >> 16) & 0xFF]] ^ rotl8(rt[fsb[w >> 24]])));
+            }
+        }
+    }
+    memset(enc, 0, sizeof(enc));
+    return nr;
+}
+
+// =====================================================================================
+// AES com T-table
+// =====================================================================================
+
+// Índices já multiplicados por 4 (deslocamento + máscara 0x3FC): no Thumb-1 são duas
+// instruções por consulta em vez de três (extrair o byte e depois escalar).
+#define TB0(t, x) (*(const uint32_t *)((const uint8_t *)(t) + (((x) << 2) & 0x3FC)))
+#define TB1(t, x) (*(const uint32_t *)((const uint8_t *)(t) + (((x) >> 6) & 0x3FC)))
+#define TB2(t, x) (*(const uint32_t *)((const uint8_t *)(t) + (((x) >> 14) & 0x3FC)))
+#define TB3(t, x) (*(const uint32_t *)((const uint8_t *)(t) + (((x) >> 22) & 0x3FC)))
+
+// Uma coluna: as tabelas FT1..FT3 do mbedTLS são FT0 rodada de 8, 16 e 24 bits; aninhar
+// as rotações deixa só três ROR por coluna, todas de 8.
+#define AES_COL(t, k, a, b, c, d) \
+    ((k) ^ TB0(t, a) ^ rotl8(TB1(t, b) ^ rotl8(TB2(t, c) ^ rotl8(TB3(t, d)))))
+
+#define AES_FROUND(rk, x0, x1, x2, x3, y0, y1, y2, y3) do {  \
+    x0 = AES_COL(ft, (rk)[0], y0, y1, y2, y3);              \
+    x1 = AES_COL(ft, (rk)[1], y1, y2, y3, y0);              \
+    x2 = AES_COL(ft, (rk)[2], y2, y3, y0, y1);              \
+    x3 = AES_COL(ft, (rk)[3], y3, y0, y1, y2);              \
+} while (0)
+
+#define AES_RROUND(rk, x0, x1, x2, x3, y0, y1, y2, y3) do {  \
+    x0 = AES_COL(rt, (rk)[0], y0, y3, y2, y1);              \
+    x1 = AES_COL(rt, (rk)[1], y1, y0, y3, y2);              \
+    x2 = AES_COL(rt, (rk)[2], y2, y1, y0, y3);              \
+    x3 = AES_COL(rt, (rk)[3], y3, y2, y1, y0);              \
+} while (0)
+
+// Última rodada: só S-box, sem MixColumns
+#define AES_LAST(sb, k, a, b, c, d) \
+    ((k) ^ (uint32_t)(sb)[(a) & 0xFF] ^ (uint32_t)(sb)[((b) >> 8) & 0xFF] << 8 ^ \
+     (uint32_t)(sb)[((c) >> 16) & 0xFF] << 16 ^ (uint32_t)(sb)[(d) >> 24] << 24)
+
+void RAM_QUENTE(crypto_aes_encrypt_table)(const uint32_t *rk, int nr, const uint8_t in[16], uint8_t out[16]) {
+    uint32_t x0, x1, x2, x3, y0, y1, y2, y3;
+
+    aes_tables();
+    x0 = le32(in) ^ rk[0];
+    x1 = le32(in + 4) ^ rk[1];
+    x2 = le32(in + 8) ^ rk[2];
+    x3 = le32(in + 12) ^ rk[3];
+
+    // Duas rodadas por volta, alternando os registradores (sem cópias)
+    for (int i = (nr >> 1) - 1; i > 0; i--) {
+        rk += 4;
+        AES_FROUND(rk, y0, y1, y2, y3, x0, x1, x2, x3);
+        rk += 4;
+        AES_FROUND(rk, x0, x1, x2, x3, y0, y1, y2, y3);
+    }
+    rk += 4;
+    AES_FROUND(rk, y0, y1, y2, y3, x0, x1, x2, x3);
+    rk += 4;
+
+    put_le32(out, AES_LAST(fsb, rk[0], y0, y1, y2, y3));
+    put_le32(out + 4, AES_LAST(fsb, rk[1], y1, y2, y3, y0));
+    put_le32(out + 8, AES_LAST(fsb, rk[2], y2, y3, y0, y1));
+    put_le32(out + 12, AES_LAST(fsb, rk[3], y3, y0, y1, y2));
+}
+
+void RAM_QUENTE(crypto_aes_decrypt_table)(const uint32_t *rk, int nr, const uint8_t in[16], uint8_t out[16]) {
+    uint32_t x0, x1, x2, x3, y0, y1, y2, y3;
+
+    aes_tables();
+    x0 = le32(in) ^ rk[0];
+    x1 = le32(in + 4) ^ rk[1];
+    x2 = le32(in + 8) ^ rk[2];
+    x3 = le32(in + 12) ^ rk[3];
+
+    for (int i = (nr >> 1) - 1; i > 0; i--) {
+        rk += 4;
+        AES_RROUND(rk, y0, y1, y2, y3, x0, x1, x2, x3);
+        rk += 4;
+        AES_RROUND(rk, x0, x1, x2, x3, y0, y1, y2, y3);
+    }
+    rk += 4;
+    AES_RROUND(rk, y0, y1, y2, y3, x0, x1, x2, x3);
+    rk += 4;
+
+    put_le32(out, AES_LAST(rsb, rk[0], y0, y3, y2, y1));
+    put_le32(out + 4, AES_LAST(rsb, rk[1], y1, y0, y3, y2));
+    put_le32(out + 8, AES_LAST(rsb, rk[2], y2, y1, y0, y3));
+    put_le32(out + 12, AES_LAST(rsb, rk[3], y3, y2, y1, y0));
+}
+
+// =====================================================================================
+// AES bitsliced (tempo constante)
+// =====================================================================================
+//
+// O bloco vira 8 fatias: a fatia k tem o bit k dos 16 bytes, com o byte da linha r e
+// coluna c na posição 4r + c (cada linha do estado é um nibble). A fatia ocupa 16 bits
+// e é duplicada na metade alta da palavra, assim a rotação de linhas do MixColumns é um
+// único ROR de 32 bits. Tudo é AND/XOR/deslocamento de valor fixo, e a multiplicação
+// usada no empacotamento leva 1 ciclo no M0+ do RP2040, independente dos operandos.
+
+// Bits 0, 8, 16 e 24 -> bits 24..27 (sem colisões nem vai-um entre os produtos parciais)
+#define CT_JUNTA_NIBBLE   0x01020408u
+// Nibble -> bits 0, 8, 16 e 24
+#define CT_ESPALHA_NIBBLE 0x00204081u
+
+/**
+ * @brief Converte 16 bytes (ordem do AES: coluna a coluna) para as 8 fatias.
+ */
+static void ct_fatia(const uint8_t b[16], uint32_t s[8]) {
+    uint32_t linha[4];
+
+    for (int r = 0; r < 4; r++) {
+        linha[r] = (uint32_t)b[r] | (uint32_t)b[r + 4] << 8 | (uint32_t)b[r + 8] << 16 | (uint32_t)b[r + 12] << 24;
+    }
+    for (int k = 0; k < 8; k++) {
+        uint32_t x = 0;
+        for (int r = 0; r < 4; r++) {
+            uint32_t bits = (linha[r] >> k) & 0x01010101u;
+            x |= ((bits * CT_JUNTA_NIBBLE) >> 24 & 0xF) << (4 * r);
+        }
+        s[k] = x | x << 16;
+    }
+}
+
+/**
+ * @brief Inverso de ct_fatia().
+ */
+static void ct_junta(const uint32_t s[8], uint8_t b[16]) {
+    for (int r = 0; r < 4; r++) {
+        uint32_t linha = 0;
+        for (int k = 0; k < 8; k++) {
+            linha |= (((s[k] >> (4 * r)) & 0xF) * CT_ESPALHA_NIBBLE & 0x01010101u) << k;
+        }
+        b[r] = (uint8_t)linha;
+        b[r + 4] = (uint8_t)(linha >> 8);
+        b[r + 8] = (uint8_t)(linha >> 16);
+        b[r + 12] = (uint8_t)(linha >> 24);
+    }
+}
+
+static void ct_add_round_key(uint32_t s[8], const uint32_t rk[4]) {
+    uint8_t b[16];
+    uint32_t k[8];
+
+    for (int j = 0; j < 4; j++) put_le32(b + 4 * j, rk[j]);
+    ct_fatia(b, k);
+    for (int i = 0; i < 8; i++) s[i] ^= k[i];
+    memset(b, 0, sizeof(b));
+    memset(k, 0, sizeof(k));
+}
+
+/**
+ * @brief S-box por circuito (Boyar-Peralta: 32 AND, 83 XOR, 4 XNOR) nas 8 fatias.
+ * U0/S0 são o bit mais significativo.
+ */
+static void ct_sub_bytes(uint32_t s[8]) {
+    uint32_t U0 = s[7], U1 = s[6], U2 = s[5], U3 = s[4], U4 = s[3], U5 = s[2], U6 = s[1], U7 = s[0];
+
+    // Camada linear de entrada
+    uint32_t T1 = U0 ^ U3, T2 = U0 ^ U5, T3 = U0 ^ U6, T4 = U3 ^ U5, T5 = U4 ^ U6;
+    uint32_t T6 = T1 ^ T5, T7 = U1 ^ U2, T8 = U7 ^ T6, T9 = U7 ^ T7, T10 = T6 ^ T7;
+    uint32_t T11 = U1 ^ U5, T12 = U2 ^ U5, T13 = T3 ^ T4, T14 = T6 ^ T11, T15 = T5 ^ T11;
+    uint32_t T16 = T5 ^ T12, T17 = T9 ^ T16, T18 = U3 ^ U7, T19 = T7 ^ T18, T20 = T1 ^ T19;
+    uint32_t T21 = U6 ^ U7, T22 = T7 ^ T21, T23 = T2 ^ T22, T24 = T2 ^ T10, T25 = T20 ^ T17;
+    uint32_t T26 = T3 ^ T16, T27 = T1 ^ T12;
+
+    // Inversão no GF(2^8) (parte não linear)
+    uint32_t M1 = T13 & T6, M2 = T23 & T8, M3 = T14 ^ M1, M4 = T19 & U7, M5 = M4 ^ M1;
+    uint32_t M6 = T3 & T16, M7 = T22 & T9, M8 = T26 ^ M6, M9 = T20 & T17, M10 = M9 ^ M6;
+    uint32_t M11 = T1 & T15, M12 = T4 & T27, M13 = M12 ^ M11, M14 = T2 & T10, M15 = M14 ^ M11;
+    uint32_t M16 = M3 ^ M2, M17 = M5 ^ T24, M18 = M8 ^ M7, M19 = M10 ^ M15, M20 = M16 ^ M13;
+    uint32_t M21 = M17 ^ M15, M22 = M18 ^ M13, M23 = M19 ^ T25, M24 = M22 ^ M23, M25 = M22 & M20;
+    uint32_t M26 = M21 ^ M25, M27 = M20 ^ M21, M28 = M23 ^ M25, M29 = M28 & M27, M30 = M26 & M24;
+    uint32_t M31 = M20 & M23, M32 = M27 & M31, M33 = M27 ^ M25, M34 = M21 & M22, M35 = M24 & M34;
+    uint32_t M36 = M24 ^ M25, M37 = M21 ^ M29, M38 = M32 ^ M33, M39 = M23 ^ M30, M40 = M35 ^ M36;
+    uint32_t M41 = M38 ^ M40, M42 = M37 ^ M39, M43 = M37 ^ M38, M44 = M39 ^ M40, M45 = M42 ^ M41;
+    uint32_t M46 = M44 & T6, M47 = M40 & T8, M48 = M39 & U7, M49 = M43 & T16, M50 = M38 & T9;
+    uint32_t M51 = M37 & T17, M52 = M42 & T15, M53 = M45 & T27, M54 = M41 & T10, M55 = M44 & T13;
+    uint32_t M56 = M40 & T23, M57 = M39 & T19, M58 = M43 & T3, M59 = M38 & T22, M60 = M37 & T20;
+    uint32_t M61 = M42 & T1, M62 = M45 & T4, M63 = M41 & T2;
+
+    // Camada linear de saída (inclui a transformação afim)
+    uint32_t L0 = M61 ^ M62, L1 = M50 ^ M56, L2 = M46 ^ M48, L3 = M47 ^ M55, L4 = M54 ^ M58;
+    uint32_t L5 = M49 ^ M61, L6 = M62 ^ L5, L7 = M46 ^ L3, L8 = M51 ^ M59, L9 = M52 ^ M53;
+    uint32_t L10 = M53 ^ L4, L11 = M60 ^ L2, L12 = M48 ^ M51, L13 = M50 ^ L0, L14 = M52 ^ M61;
+    uint32_t L15 = M55 ^ L1, L16 = M56 ^ L0, L17 = M57 ^ L1, L18 = M58 ^ L8, L19 = M63 ^ L4;
+    uint32_t L20 = L0 ^ L1, L21 = L1 ^ L7, L22 = L3 ^ L12, L23 = L18 ^ L2, L24 = L15 ^ L9;
+    uint32_t L25 = L6 ^ L10, L26 = L7 ^ L9, L27 = L8 ^ L10, L28 = L11 ^ L14, L29 = L11 ^ L17;
+
+    s[7] = L6 ^ L24;
+    s[6] = ~(L16 ^ L26);
+    s[5] = ~(L19 ^ L28);
+    s[4] = L6 ^ L21;
+    s[3] = L20 ^ L22;
+    s[2] = L25 ^ L29;
+    s[1] = ~(L13 ^ L27);
+    s[0] = ~(L6 ^ L23);
+}
+
+/**
+ * @brief Inversa da transformação afim da S-box: b_i = a_(i+2) ^ a_(i+5) ^ a_(i+7) ^ 0x05.
+ */
+static void ct_afim_inversa(uint32_t s[8]) {
+    uint32_t a[8];
+
+    memcpy(a, s, sizeof(a));
+    for (int i = 0; i < 8; i++) {
+        s[i] = a[(i + 2) & 7] ^ a[(i + 5) & 7] ^ a[(i + 7) & 7];
+    }
+    s[0] = ~s[0];
+    s[2] = ~s[2];
+}
+
+/**
+ * @brief S-box inversa. Como S = A∘inv, S^-1 = inv∘A^-1 = A^-1∘S∘A^-1: reaproveita o
+ * circuito direto em vez de um segundo circuito.
+ */
+static void ct_inv_sub_bytes(uint32_t s[8]) {
+    ct_afim_inversa(s);
+    ct_sub_bytes(s);
+    ct_afim_inversa(s);
+}
+
+// Linha r rodada de r colunas para a esquerda (nova coluna c = antiga c + r)
+static void ct_shift_rows(uint32_t s[8]) {
+    for (int k = 0; k < 8; k++) {
+        uint32_t x = s[k];
+        s[k] = (x & 0x000F000Fu) |
+               ((x >> 1) & 0x00700070u) | ((x << 3) & 0x00800080u) |
+               ((x >> 2) & 0x03000300u) | ((x << 2) & 0x0C000C00u) |
+               ((x << 1) & 0xE000E000u) | ((x >> 3) & 0x10001000u);
+    }
+}
+
+static void ct_inv_shift_rows(uint32_t s[8]) {
+    for (int k = 0; k < 8; k++) {
+        uint32_t x = s[k];
+        s[k] = (x & 0x000F000Fu) |
+               ((x << 1) & 0x00E000E0u) | ((x >> 3) & 0x00100010u) |
+               ((x >> 2) & 0x03000300u) | ((x << 2) & 0x0C000C00u) |
+               ((x >> 1) & 0x70007000u) | ((x << 3) & 0x80008000u);
+    }
+}
+
+// Multiplicação por 2 no GF(2^8), fatia a fatia (polinômio 0x11B)
+static void ct_xtime(uint32_t d[8], const uint32_t t[8]) {
+    uint32_t t7 = t[7];
+    d[7] = t[6];
+    d[6] = t[5];
+    d[5] = t[4];
+    d[4] = t[3] ^ t7;
+    d[3] = t[2] ^ t7;
+    d[2] = t[1];
+    d[1] = t[0] ^ t7;
+    d[0] = t7;
+}
+
+// out_r = 2·(a_r ^ a_r+1) ^ a_r+1 ^ a_r+2 ^ a_r+3; "linha r+1" é o ROR de 4 bits
+static void ct_mix_columns(uint32_t s[8]) {
+    uint32_t t[8], u[8], x2[8];
+
+    for (int k = 0; k < 8; k++) {
+        uint32_t r4 = rotr(s[k], 4);
+        t[k] = s[k] ^ r4;
+        u[k] = r4 ^ rotr(t[k], 8);
+    }
+    ct_xtime(x2, t);
+    for (int k = 0; k < 8; k++) s[k] = x2[k] ^ u[k];
+}
+
+// InvMixColumns = MixColumns precedido de a_r ^= 4·(a_r ^ a_r+2)
+static void ct_inv_mix_columns(uint32_t s[8]) {
+    uint32_t w[8], x2[8], x4[8];
+
+    for (int k = 0; k < 8; k++) w[k] = s[k] ^ rotr(s[k], 8);
+    ct_xtime(x2, w);
+    ct_xtime(x4, x2);
+    for (int k = 0; k < 8; k++) s[k] ^= x4[k];
+    ct_mix_columns(s);
+}
+
+void crypto_aes_encrypt_ct(const uint32_t *rk, int nr, const uint8_t in[16], uint8_t out[16]) {
+    uint32_t s[8];
+
+    ct_fatia(in, s);
+    ct_add_round_key(s, rk);
+    for (int r = 1; r < nr; r++) {
+        ct_sub_bytes(s);
+        ct_shift_rows(s);
+        ct_mix_columns(s);
+        ct_add_round_key(s, rk + 4 * r);
+    }
+    ct_sub_bytes(s);
+    ct_shift_rows(s);
+    ct_add_round_key(s, rk + 4 * nr);
+    ct_junta(s, out);
+    memset(s, 0, sizeof(s));
+}
+
+void crypto_aes_decrypt_ct(const uint32_t *rk, int nr, const uint8_t in[16], uint8_t out[16]) {
+    uint32_t s[8];
+
+    ct_fatia(in, s);
+    ct_add_round_key(s, rk);
+    for (int r = 1; r < nr; r++) {
+        ct_inv_sub_bytes(s);
+        ct_inv_shift_rows(s);
+        ct_inv_mix_columns(s);
+        ct_add_round_key(s, rk + 4 * r);
+    }
+    ct_inv_sub_bytes(s);
+    ct_inv_shift_rows(s);
+    ct_add_round_key(s, rk + 4 * nr);
+    ct_junta(s, out);
+    memset(s, 0, sizeof(s));
+}
+
+// =====================================================================================
+// SHA-256
+// =====================================================================================
+
+static const uint32_t sha256_k[64] RAM_QUENTE_DADOS(sha256_k) = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+#define SHA_S0(x) (rotr(x, 2) ^ rotr(x, 13) ^ rotr(x, 22))
+#define SHA_S1(x) (rotr(x, 6) ^ rotr(x, 11) ^ rotr(x, 25))
+#define SHA_G0(x) (rotr(x, 7) ^ rotr(x, 18) ^ ((x) >> 3))
+#define SHA_G1(x) (rotr(x, 17) ^ rotr(x, 19) ^ ((x) >> 10))
+#define SHA_CH(e, f, g) ((g) ^ ((e) & ((f) ^ (g))))
+#define SHA_MAJ(a, b, c) (((a) & (b)) | ((c) & ((a) | (b))))
+
+// Janela de 16 palavras (64 bytes de pilha em vez de 256); índices constantes após o
+// desenrolamento, então w[] fica em posições fixas da pilha
+#define SHA_W_CARGA(j) (w[j] = be32(data + 4 * (j)))
+#define SHA_W_NOVA(j)  (w[j] += SHA_G1(w[((j) + 14) & 15]) + w[((j) + 9) & 15] + SHA_G0(w[((j) + 1) & 15]))
+
+// Rodada sem renomear variáveis: quem faz o papel de cada letra gira a cada chamada
+#define SHA_RODADA(a, b, c, d, e, f, g, h, k, x) do {                  \
+    uint32_t t1 = (h) + SHA_S1(e) + SHA_CH(e, f, g) + (k) + (x);        \
+    (d) += t1;                                                          \
+    (h) = t1 + SHA_S0(a) + SHA_MAJ(a, b, c);                            \
+} while (0)
+
+#define SHA_BLOCO16(K, W) do {                                          \
+    SHA_RODADA(a, b, c, d, e, f, g, h, (K)[0], W(0));                   \
+    SHA_RODADA(h, a, b, c, d, e, f, g, (K)[1], W(1));                   \
+    SHA_RODADA(g, h, a, b, c, d, e, f, (K)[2], W(2));                   \
+    SHA_RODADA(f, g, h, a, b, c, d, e, (K)[3], W(3));                   \
+    SHA_RODADA(e, f, g, h, a, b, c, d, (K)[4], W(4));                   \
+    SHA_RODADA(d, e, f, g, h, a, b, c, (K)[5], W(5));                   \
+    SHA_RODADA(c, d, e, f, g, h, a, b, (K)[6], W(6));                   \
+    SHA_RODADA(b, c, d, e, f, g, h, a, (K)[7], W(7));                   \
+    SHA_RODADA(a, b, c, d, e, f, g, h, (K)[8], W(8));                   \
+    SHA_RODADA(h, a, b, c, d, e, f, g, (K)[9], W(9));                   \
+    SHA_RODADA(g, h, a, b, c, d, e, f, (K)[10], W(10));                 \
+    SHA_RODADA(f, g, h, a, b, c, d, e, (K)[11], W(11));                 \
+    SHA_RODADA(e, f, g, h, a, b, c, d, (K)[12], W(12));                 \
+    SHA_RODADA(d, e, f, g, h, a, b, c, (K)[13], W(13));                 \
+    SHA_RODADA(c, d, e, f, g, h, a, b, (K)[14], W(14));                 \
+    SHA_RODADA(b, c, d, e, f, g, h, a, (K)[15], W(15));                 \
+} while (0)
+
+void RAM_QUENTE(crypto_sha256_block)(uint32_t state[8], const uint8_t data[64]) {
+    uint32_t w[16];
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+    SHA_BLOCO16(sha256_k, SHA_W_CARGA);
+    for (const uint32_t *k = sha256_k + 16; k < sha256_k + 64; k += 16) {
+        SHA_BLOCO16(k, SHA_W_NOVA);
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
@@ -0,0 +1,98 @@
+#include "device_state.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#if PICO_ON_DEVICE
+#include "hardware/sync.h"
+#endif
+
+// Contador de sequência: ímpar enquanto um escritor está no meio da atualização
+static atomic_uint seq = 0;
+static device_state_t estado;
+
+#if PICO_ON_DEVICE
+// Escritores são serializados entre si (IRQ e os dois cores) por um spinlock de
+// hardware; leitores nunca o tocam
+static spin_lock_t *lock = NULL;
+#endif
+
+void device_state_init(void) {
+#if PICO_ON_DEVICE
+    lock = spin_lock_init((uint)spin_lock_claim_unused(true));
+#endif
+}
+
+/**
+ * @brief Abre uma escrita: exclusão entre escritores e sequência ímpar para os leitores.
+ */
+static uint32_t device_state_write_begin(void) {
+    uint32_t irq = 0;
+#if PICO_ON_DEVICE
+    irq = spin_lock_blocking(lock);
+#endif
+    unsigned s = atomic_load_explicit(&seq, memory_order_relaxed);
+    atomic_store_explicit(&seq, s + 1, memory_order_relaxed);
+    // Os dados só podem ser alterados depois que a sequência ímpar estiver visível
+    atomic_thread_fence(memory_order_release);
+    return irq;
+}
+
+/**
+ * @brief Fecha a escrita: sequência par de novo, com os dados visíveis antes dela.
+ */
+static void device_state_write_end(uint32_t irq) {
+    unsigned s = atomic_load_explicit(&seq, memory_order_relaxed) + 1;
+    estado.versao = s / 2;
+    atomic_store_explicit(&seq, s, memory_order_release);
+#if PICO_ON_DEVICE
+    spin_unlock(lock, irq);
+#else
+    (void)irq;
+#endif
+}
+
+void device_state_snapshot(device_state_t *out) {
+    unsigned s1, s2;
+    do {
+        s1 = atomic_load_explicit(&seq, memory_order_acquire);
+        if (s1 & 1) continue;               // Escritor no meio: tenta de novo
+        memcpy(out, &estado, sizeof(*out));
+        // A cópia tem de terminar antes de reler a sequência
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&seq, memory_order_relaxed);
+        if (s1 == s2) return;
+    } while (1);
+}
+
+void device_state_set_wifi(bool conectado, uint32_t ipv4) {
+    uint32_t irq = device_state_write_begin();
+    estado.wifi_conectado = conectado;
+    estado.ipv4 = conectado ? ipv4 : 0;
+    device_state_write_end(irq);
+}
+
+void device_state_set_mqtt(bool conectado) {
+    uint32_t irq = device_state_write_begin();
+    estado.mqtt_conectado = conectado;
+    device_state_write_end(irq);
+}
+
+void device_state_set_temperatura(float celsius, uint64_t t_us) {
+    uint32_t irq = device_state_write_begin();
+    estado.temperatura = celsius;
+    estado.temperatura_t_us = t_us;
+    device_state_write_end(irq);
+}
+
+bool device_state_wifi_conectado(void) {
+    device_state_t s;
+    device_state_snapshot(&s);
+    return s.wifi_conectado;
+}
+
+bool device_state_mqtt_conectado(void) {
+    device_state_t s;
+    device_state_snapshot(&s);
+    return s.mqtt_conectado;
+}
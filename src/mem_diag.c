@@ -0,0 +1,384 @@
+#include "mem_diag.h"
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#define MEM_MARCA       0x4D454D00u     // "MEM" + subsistema no byte baixo
+#define MEM_TINTA       0xA5A5A5A5u     // Padrão das pilhas ainda não usadas
+#define MEM_FOLGA       64              // Bytes abaixo do SP atual que a pintura não toca
+
+// Antes de cada bloco; 8 bytes mantêm o alinhamento do malloc da newlib
+typedef struct {
+    uint32_t tam;
+    uint32_t marca;
+} mem_cabecalho_t;
+
+// Símbolos do linker script do SDK (memmap_default.ld)
+extern char end;                                    // Início do heap
+extern char __StackLimit;                           // Limite do sbrk
+extern uint32_t __StackBottom[], __StackTop[];      // Pilha do core 0 (SCRATCH_Y)
+extern uint32_t __StackOneBottom[], __StackOneTop[];// Pilha do core 1 (SCRATCH_X)
+
+static mem_uso_t uso[MEM_SUBSISTEMAS];
+static uint32_t total_atual, pico_total;
+static uint32_t sem_cabecalho;
+
+static spin_lock_t *mem_spin;           // Reservado em mem_diag_init()
+
+/**
+ * @brief Entra na seção crítica dos contadores e dos pools. O spinlock de hardware exclui
+ * o outro core; antes de ele existir só há o core 0, e basta mascarar as interrupções.
+ */
+static uint32_t mem_trava(void) {
+    return mem_spin ? spin_lock_blocking(mem_spin) : save_and_disable_interrupts();
+}
+
+static void mem_destrava(uint32_t irq) {
+    if (mem_spin) spin_unlock(mem_spin, irq);
+    else restore_interrupts(irq);
+}
+
+#if MEM_ESTATICA
+#include <reent.h>
+
+#define MEM_ALINHA(t)           (((t) + 7u) & ~7u)
+#define MEM_BLOCOS(n, t)        ((n) * (MEM_ALINHA(t) + sizeof(mem_cabecalho_t)))
+#define MEM_CLASSES_MAX         7
+#define MEM_VAGA_DISPLAY        (MEM_TLS_CONFIG + 1)
+#define MEM_VAGAS               (MEM_VAGA_DISPLAY + 1)
+
+typedef struct {
+    uint32_t tam;
+    uint8_t n;
+} mem_classe_def_t;
+
+// Classes de uma sessão TLS, da menor para a maior
+static const mem_classe_def_t mem_classes_tls[] = {
+    { 64, MEM_TLS_BLOCOS_64 },
+    { 256, MEM_TLS_BLOCOS_256 },
+    { 512, MEM_TLS_BLOCOS_512 },
+    { 1024, MEM_TLS_BLOCOS_1K },
+    { 2048, MEM_TLS_BLOCOS_2K },
+    { MEM_TLS_SAIDA_LEN + MEM_TLS_FOLGA_REGISTRO, 1 },
+    { MEM_TLS_ENTRADA_LEN + MEM_TLS_FOLGA_REGISTRO, 1 },
+};
+static const mem_classe_def_t mem_classes_config[] = { { 64, MEM_TLS_BLOCOS_CONFIG } };
+static const mem_classe_def_t mem_classes_display[] = { { MEM_DISPLAY_BLOCO, 1 } };
+
+#define MEM_TLS_SESSAO_BYTES    (MEM_BLOCOS(MEM_TLS_BLOCOS_64, 64) + MEM_BLOCOS(MEM_TLS_BLOCOS_256, 256) + \
+                                 MEM_BLOCOS(MEM_TLS_BLOCOS_512, 512) + MEM_BLOCOS(MEM_TLS_BLOCOS_1K, 1024) + \
+                                 MEM_BLOCOS(MEM_TLS_BLOCOS_2K, 2048) + \
+                                 MEM_BLOCOS(1, MEM_TLS_SAIDA_LEN + MEM_TLS_FOLGA_REGISTRO) + \
+                                 MEM_BLOCOS(1, MEM_TLS_ENTRADA_LEN + MEM_TLS_FOLGA_REGISTRO))
+
+_Static_assert(MEM_TLS_BLOCOS_64 <= 32 && MEM_TLS_BLOCOS_256 <= 32 && MEM_TLS_BLOCOS_512 <= 32 &&
+               MEM_TLS_BLOCOS_1K <= 32 && MEM_TLS_BLOCOS_2K <= 32 && MEM_TLS_BLOCOS_CONFIG <= 32,
+               "no máximo 32 blocos por classe (bitmap de 32 bits)");
+
+// Pools: vetores de uint64_t para o alinhamento de 8 do cabeçalho. Os nomes aparecem
+// no map do link, cada um com o seu tamanho.
+static uint64_t mem_arena_mbedtls[MEM_TLS_SESSOES][MEM_TLS_SESSAO_BYTES / 8];
+static uint64_t mem_arena_mbedtls_config[MEM_BLOCOS(MEM_TLS_BLOCOS_CONFIG, 64) / 8];
+static uint64_t mem_arena_display[MEM_BLOCOS(1, MEM_DISPLAY_BLOCO) / 8];
+
+typedef struct {
+    uint8_t *base;
+    uint32_t tam;               // Carga útil de cada bloco, sem o cabeçalho
+    uint32_t livres;            // Bit i ligado: bloco i livre
+    uint8_t n, usados, pico;
+} mem_classe_t;
+
+typedef struct {
+    mem_classe_t classe[MEM_CLASSES_MAX];
+    uint8_t n;
+} mem_vaga_t;
+
+static mem_vaga_t vagas[MEM_VAGAS];
+static unsigned vaga_tls;               // Vaga das alocações do mbedTLS (mem_diag_tls_sessao)
+
+/**
+ * @brief Divide 'base' nos blocos das classes 'def', em sequência.
+ */
+static void mem_vaga_monta(mem_vaga_t *v, void *base, const mem_classe_def_t *def, int n) {
+    uint8_t *p = base;
+    v->n = (uint8_t)n;
+    for (int i = 0; i < n; i++) {
+        mem_classe_t *k = &v->classe[i];
+        k->base = p;
+        k->tam = MEM_ALINHA(def[i].tam);
+        k->n = def[i].n;
+        k->livres = k->n < 32 ? (1u << k->n) - 1u : UINT32_MAX;
+        p += MEM_BLOCOS(def[i].n, def[i].tam);
+    }
+}
+
+static void mem_vagas_monta(void) {
+    for (int s = 0; s < MEM_TLS_SESSOES; s++) {
+        mem_vaga_monta(&vagas[s], mem_arena_mbedtls[s], mem_classes_tls, sizeof(mem_classes_tls) / sizeof(mem_classes_tls[0]));
+    }
+    mem_vaga_monta(&vagas[MEM_TLS_CONFIG], mem_arena_mbedtls_config, mem_classes_config, sizeof(mem_classes_config) / sizeof(mem_classes_config[0]));
+    mem_vaga_monta(&vagas[MEM_VAGA_DISPLAY], mem_arena_display, mem_classes_display, sizeof(mem_classes_display) / sizeof(mem_classes_display[0]));
+}
+
+void mem_diag_tls_sessao(unsigned vaga) {
+    if (vaga > MEM_TLS_CONFIG) panic("[MEM] vaga TLS %u inexistente", vaga);
+    vaga_tls = vaga;
+}
+
+/**
+ * @brief Bloco livre da menor classe que comporta 'tam', subindo de classe se a justa
+ * estiver cheia. O custo é fixo: uma passada pelas classes e um ctz no bitmap.
+ */
+static mem_cabecalho_t *mem_vaga_aloca(mem_subsistema_t sub, size_t tam) {
+    mem_vaga_t *v;
+    switch (sub) {
+    case MEM_MBEDTLS: v = &vagas[vaga_tls]; break;
+    case MEM_DISPLAY: v = &vagas[MEM_VAGA_DISPLAY]; break;
+    default: return NULL;               // lwIP tem os próprios pools
+    }
+
+    uint32_t irq = mem_trava();
+    for (int i = 0; i < v->n; i++) {
+        mem_classe_t *k = &v->classe[i];
+        if (k->tam < tam || k->livres == 0) continue;
+
+        unsigned b = (unsigned)__builtin_ctz(k->livres);
+        k->livres &= ~(1u << b);
+        if (++k->usados > k->pico) k->pico = k->usados;
+        mem_destrava(irq);
+
+        mem_cabecalho_t *c = (mem_cabecalho_t *)(k->base + b * (k->tam + sizeof(*c)));
+        c->tam = k->tam;
+        return c;
+    }
+    mem_destrava(irq);
+    return NULL;
+}
+
+/**
+ * @brief Devolve o bloco à sua classe, achada pelo endereço. Falso se não for de nenhum pool.
+ */
+static bool mem_vaga_libera(mem_cabecalho_t *c) {
+    uint8_t *p = (uint8_t *)c;
+    for (int s = 0; s < MEM_VAGAS; s++) {
+        for (int i = 0; i < vagas[s].n; i++) {
+            mem_classe_t *k = &vagas[s].classe[i];
+            uint32_t passo = k->tam + sizeof(*c);
+            if (p < k->base || p >= k->base + k->n * passo) continue;
+
+            unsigned b = (unsigned)((p - k->base) / passo);
+            uint32_t irq = mem_trava();
+            k->livres |= 1u << b;
+            k->usados--;
+            mem_destrava(irq);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Nenhum malloc da newlib no modo estático: quem chegar aqui ficou fora dos pools.
+ */
+void *__wrap__malloc_r(struct _reent *r, size_t tam) {
+    (void)r;
+    panic("[MEM] malloc(%u) com MEM_ESTATICA (chamado de %p)", (unsigned)tam, __builtin_return_address(0));
+}
+
+/**
+ * @brief Rede de segurança para o que chegar ao heap por outro caminho (_calloc_r, _realloc_r).
+ */
+void *__wrap__sbrk(ptrdiff_t incr) {
+    panic("[MEM] sbrk(%d) com MEM_ESTATICA (chamado de %p)", (int)incr, __builtin_return_address(0));
+}
+#endif
+
+/**
+ * @brief Preenche [de, ate) com o padrão das pilhas.
+ */
+static void mem_pinta(uint32_t *de, uint32_t *ate) {
+    while (de < ate) *de++ = MEM_TINTA;
+}
+
+/**
+ * @brief Profundidade máxima de uma pilha: do topo até a primeira palavra sem o padrão,
+ * procurando a partir do fundo. Pilha estourada (fundo sobrescrito) conta inteira.
+ */
+static uint32_t mem_marca_dagua(const uint32_t *fundo, const uint32_t *topo) {
+    const uint32_t *p = fundo;
+    while (p < topo && *p == MEM_TINTA) p++;
+    return (uint32_t)((topo - p) * sizeof(uint32_t));
+}
+
+void __attribute__((noinline)) mem_diag_init(void) {
+    uint32_t *sp;
+    __asm volatile ("mov %0, sp" : "=r"(sp));
+
+    // Core 0: só abaixo do quadro atual. Core 1 ainda está parado na bootrom, mas o
+    // topo da sua pilha fica de fora por garantia.
+    mem_pinta(__StackBottom, sp - MEM_FOLGA / sizeof(uint32_t));
+    if (__StackOneTop - __StackOneBottom > MEM_FOLGA / (int)sizeof(uint32_t)) {
+        mem_pinta(__StackOneBottom, __StackOneTop - MEM_FOLGA / sizeof(uint32_t));
+    }
+
+    mem_spin = spin_lock_instance(spin_lock_claim_unused(true));
+#if MEM_ESTATICA
+    mem_vagas_monta();
+#endif
+}
+
+/**
+ * @brief Contabiliza um bloco de 'tam' bytes alocado (aloca = true) ou liberado no
+ * subsistema. O sentido vem do parâmetro: blocos de 0 bytes também contam.
+ */
+static void mem_conta(mem_subsistema_t sub, uint32_t tam, bool aloca) {
+    uint32_t irq = mem_trava();
+    mem_uso_t *u = &uso[sub];
+    if (aloca) {
+        u->atual += tam;
+        total_atual += tam;
+        u->blocos++;
+        if (u->atual > u->pico) u->pico = u->atual;
+        if (total_atual > pico_total) pico_total = total_atual;
+    } else {
+        u->atual -= tam;
+        total_atual -= tam;
+        u->blocos--;
+    }
+    mem_destrava(irq);
+}
+
+static void mem_falha(mem_subsistema_t sub) {
+    uint32_t irq = mem_trava();
+    uso[sub].falhas++;
+    mem_destrava(irq);
+}
+
+void *mem_diag_malloc(mem_subsistema_t sub, size_t tam) {
+#if MEM_ESTATICA
+    mem_cabecalho_t *c = mem_vaga_aloca(sub, tam);
+#else
+    mem_cabecalho_t *c = tam <= UINT32_MAX - sizeof(*c) ? malloc(sizeof(*c) + tam) : NULL;
+    if (c) c->tam = (uint32_t)tam;
+#endif
+    if (c == NULL) {
+        mem_falha(sub);
+        return NULL;
+    }
+    c->marca = MEM_MARCA | sub;
+    mem_conta(sub, c->tam, true);
+    return c + 1;
+}
+
+void *mem_diag_calloc(mem_subsistema_t sub, size_t n, size_t tam) {
+    if (tam != 0 && n > SIZE_MAX / tam) {
+        mem_falha(sub);
+        return NULL;
+    }
+    void *p = mem_diag_malloc(sub, n * tam);
+    if (p) memset(p, 0, n * tam);
+    return p;
+}
+
+void mem_diag_free(void *p) {
+    if (p == NULL) return;
+
+    mem_cabecalho_t *c = (mem_cabecalho_t *)p - 1;
+    uint32_t sub = c->marca ^ MEM_MARCA;
+    if (sub >= MEM_SUBSISTEMAS) {
+        // Alocado antes dos ganchos, ou fora deles: devolve como veio. No modo estático
+        // não há de onde ter vindo (o malloc é bloqueado), então só conta.
+        sem_cabecalho++;
+#if !MEM_ESTATICA
+        free(p);
+#endif
+        return;
+    }
+#if MEM_ESTATICA
+    c->marca = 0;
+    if (!mem_vaga_libera(c)) {
+        sem_cabecalho++;
+        return;
+    }
+    mem_conta((mem_subsistema_t)sub, c->tam, false);
+#else
+    mem_conta((mem_subsistema_t)sub, c->tam, false);
+    c->marca = 0;
+    free(c);
+#endif
+}
+
+void mem_diag_snapshot(mem_diag_t *out) {
+    struct mallinfo mi = mallinfo();
+
+    uint32_t irq = mem_trava();
+    memcpy(out->sub, uso, sizeof(out->sub));
+    out->pico_total = pico_total;
+    out->sem_cabecalho = sem_cabecalho;
+    mem_destrava(irq);
+#if MEM_ESTATICA
+    out->sub[MEM_MBEDTLS].capacidade = sizeof(mem_arena_mbedtls) + sizeof(mem_arena_mbedtls_config);
+    out->sub[MEM_DISPLAY].capacidade = sizeof(mem_arena_display);
+#endif
+
+    out->heap_total = (uint32_t)(&__StackLimit - &end);
+    out->heap_uso = (uint32_t)mi.uordblks;
+    out->heap_arena = (uint32_t)mi.arena;
+
+    out->pilha[0].tamanho = (uint32_t)((__StackTop - __StackBottom) * sizeof(uint32_t));
+    out->pilha[0].usado = mem_marca_dagua(__StackBottom, __StackTop);
+    out->pilha[1].tamanho = (uint32_t)((__StackOneTop - __StackOneBottom) * sizeof(uint32_t));
+    out->pilha[1].usado = out->pilha[1].tamanho ? mem_marca_dagua(__StackOneBottom, __StackOneTop) : 0;
+}
+
+void mem_diag_relata(void) {
+    mem_diag_t d;
+    mem_diag_snapshot(&d);
+
+    printf("[MEM] heap: %lu de %lu bytes em uso (arena %lu); pico somado dos subsistemas %lu\n",
+           (unsigned long)d.heap_uso, (unsigned long)d.heap_total, (unsigned long)d.heap_arena,
+           (unsigned long)d.pico_total);
+    for (int s = 0; s < MEM_SUBSISTEMAS; s++) {
+#if MEM_ESTATICA
+        if (s == MEM_LWIP) {
+            printf("[MEM] %-8s pools próprios (MEM_SIZE e MEMP_NUM_* em lwipopts.h)\n", mem_diag_nome(MEM_LWIP));
+            continue;
+        }
+#endif
+        printf("[MEM] %-8s %lu bytes em %lu blocos, pico %lu", mem_diag_nome((mem_subsistema_t)s),
+               (unsigned long)d.sub[s].atual, (unsigned long)d.sub[s].blocos, (unsigned long)d.sub[s].pico);
+        if (d.sub[s].capacidade) printf(" de %lu (pools)", (unsigned long)d.sub[s].capacidade);
+        printf(", %lu falhas\n", (unsigned long)d.sub[s].falhas);
+    }
+#if MEM_ESTATICA
+    // Uso e pico de cada classe (blocos de N bytes), para ajustar os MEM_TLS_BLOCOS_*
+    for (int v = 0; v < MEM_VAGAS; v++) {
+        if (v == MEM_VAGA_DISPLAY) continue;
+        if (v == MEM_TLS_CONFIG) printf("[MEM] tls config:");
+        else printf("[MEM] tls sessão %d:", v);
+        for (int i = 0; i < vagas[v].n; i++) {
+            const mem_classe_t *k = &vagas[v].classe[i];
+            printf(" %lu:%u/%u(pico %u)", (unsigned long)k->tam, k->usados, k->n, k->pico);
+        }
+        printf("\n");
+    }
+#endif
+    for (int core = 0; core < 2; core++) {
+        const mem_pilha_t *p = &d.pilha[core];
+        if (p->tamanho == 0) {
+            printf("[MEM] pilha do core %d: não reservada\n", core);
+        } else {
+            printf("[MEM] pilha do core %d: %lu de %lu bytes%s\n", core, (unsigned long)p->usado,
+                   (unsigned long)p->tamanho, p->usado >= p->tamanho ? " (ESTOUROU)" : "");
+        }
+    }
+    if (d.sem_cabecalho) {
+        printf("[MEM] %lu blocos liberados sem cabeçalho (alocados fora dos wrappers)\n",
+               (unsigned long)d.sem_cabecalho);
+    }
+}
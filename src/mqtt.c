@@ -1,6 +1,13 @@
 #include "mqtt.h"
 #include "pico_net.h"
 #include "shared_vars.h"
+#include "device_state.h"
+#include "rng.h"
+#include "boot_trace.h"
+#include "broker.h"
+#include "binlog.h"
+#include "xip_cache.h"
+#include "mem_diag.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -9,34 +16,77 @@
 #include "pico/cyw43_arch.h"
 #include "mbedtls/ssl.h"
 #include "mbedtls/ctr_drbg.h"
-#include "mbedtls/entropy.h"
 #include "mbedtls/error.h"
 #include "mbedtls/debug.h"
+#include "mbedtls/platform.h"
+#include "mbedtls/net_sockets.h"
+
+// --- Timeouts de cada etapa da conexão ---
+#define MQTT_TCP_TIMEOUT_MS       10000
+#define MQTT_HANDSHAKE_TIMEOUT_MS 10000
+#define MQTT_CONNACK_TIMEOUT_MS   5000
+// Espera antes de lançar o próximo candidato da corrida de brokers (happy eyeballs)
+#define MQTT_ESCALONAMENTO_MS     300
+
+// --- Tipos de pacote MQTT (nibble superior do primeiro byte) ---
+#define MQTT_PKT_CONNACK  0x20
+#define MQTT_PKT_PINGRESP 0xD0
+
+// --- Propriedades MQTT 5 usadas pelo cliente ---
+#define MQTT_PROP_RECEIVE_MAXIMUM     0x21
+#define MQTT_PROP_TOPIC_ALIAS_MAXIMUM 0x22
+#define MQTT_PROP_TOPIC_ALIAS         0x23
+
+// CONNACK: "protocolo não suportado" em v3.1.1 (código 0x01) e em MQTT 5 (reason code 0x84)
+#define MQTT_CONNACK_V311_BAD_PROTOCOL 0x01
+#define MQTT_CONNACK_V5_BAD_PROTOCOL   0x84
 
 // --- Variáveis Estáticas do Módulo ---
 static const unsigned char psk[] = { 0xAB, 0xCD, 0x72, 0xEF, 0x12, 0x34 };
-static mbedtls_ssl_context ssl;
+// Configuração TLS somente-leitura após mqtt_init(), compartilhada por todos os clientes
 static mbedtls_ssl_config conf;
-static pico_net_context server_fd;
-static mbedtls_ctr_drbg_context ctr_drbg;
-static mbedtls_entropy_context entropy;
+static const int ciphersuites[] = { MBEDTLS_TLS_PSK_WITH_AES_128_CBC_SHA256, 0 };
+static bool conf_ready = false;
+// Clientes do firmware (API mqtt_connect/mqtt_publish): BROKER_CORRIDA disputam cada
+// conexão e device_client aponta para o vencedor
+static mqtt_client_t device_clients[BROKER_CORRIDA];
+static mqtt_client_t *device_client = &device_clients[0];
+static reconnect_class_t device_failure = RECONNECT_TCP;
+static bool brokers_ready = false;
 
 // --- Protótipos de Funções Privadas ---
-static int mqtt_send_packet(const uint8_t *buf, size_t len);
+static int mqtt_send_packet(mqtt_client_t *c, const uint8_t *buf, size_t len);
+static size_t mqtt_encode_rl(uint8_t *dst, size_t len);
+static bool mqtt_send_connect(mqtt_client_t *c);
+static int mqtt_read_packet(mqtt_client_t *c);
+static void mqtt_fail_estado(mqtt_client_t *c);
 static void my_debug(void *ctx, int level, const char *file, int line, const char *str);
-static void mqtt_cleanup(void);
+static void mqtt_cleanup(mqtt_client_t *c);
+static void mqtt_fallback_v311(mqtt_client_t *c);
+static bool mqtt_fechado_apos_connect(const mqtt_client_t *c);
+static void mqtt_parse_connack_props(mqtt_client_t *c);
+
+// Registra a falha no log binário e marca o cliente como FAILED. O motivo (literal) entra
+// no próprio formato, sem o corte de BINLOG_STR_MAX. Do mbedTLS vai só o código, sem o
+// mbedtls_strerror(), que formataria o texto no caminho da conexão (ver mbedtls/error.h).
+#define mqtt_fail(c, motivo, ret) do {                                  \
+        int ret_ = (ret);                                               \
+        if (ret_ != 0) LOG_ERRO("[MQTT] " motivo ": -0x%x", -ret_);     \
+        else LOG_ERRO("[MQTT] " motivo ".");                            \
+        mqtt_fail_estado(c);                                            \
+    } while (0)
 
 // --- Implementações ---
 
 /**
- * @brief Envia um pacote MQTT genérico pela conexão TLS.
+ * @brief Escreve os bytes na conexão TLS (um registro por chamada, até 16 KB).
  */
-static int mqtt_send_packet(const uint8_t *buf, size_t len) {
+static int RAM_QUENTE(mqtt_tls_write)(mqtt_client_t *c, const uint8_t *buf, size_t len) {
     int ret;
     size_t sent = 0;
 
     while (sent < len) {
-        ret = mbedtls_ssl_write(&ssl, buf + sent, len - sent);
+        ret = mbedtls_ssl_write(&c->ssl, buf + sent, len - sent);
         if (ret > 0) {
             sent += ret;
             continue;
@@ -45,131 +95,693 @@ static int mqtt_send_packet(const uint8_t *buf, size_t len) {
             cyw43_arch_poll(); // Permite que a rede processe
             continue;
         }
-        printf("[MQTT] Erro em mbedtls_ssl_write: -0x%x\n", -ret);
+        LOG_ERRO("[MQTT] Erro em mbedtls_ssl_write: -0x%x", -ret);
         return -1; // Falha
     }
     return (int)sent;
 }
 
 /**
- * @brief Publica uma mensagem em um tópico MQTT.
+ * @brief Envia um pacote MQTT genérico: direto na conexão TLS ou, com cork, para tx_buf.
  */
-bool mqtt_publish(const char *topic, const char *payload) {
-    if (!g_mqtt_connected) {
-        printf("[MQTT] Não é possível publicar: desconectado.\n");
+static int RAM_QUENTE(mqtt_send_packet)(mqtt_client_t *c, const uint8_t *buf, size_t len) {
+    if (!c->corked) {
+        return mqtt_tls_write(c, buf, len);
+    }
+    // Não cabe no que sobrou: esvazia antes; maior que o buffer inteiro: vai sozinho
+    if (c->tx_len + len > sizeof(c->tx_buf) && !mqtt_client_flush(c)) {
+        return -1;
+    }
+    if (len > sizeof(c->tx_buf)) {
+        return mqtt_tls_write(c, buf, len);
+    }
+    memcpy(&c->tx_buf[c->tx_len], buf, len);
+    c->tx_len += (uint16_t)len;
+    c->tx_pacotes++;
+    return (int)len;
+}
+
+void mqtt_client_cork(mqtt_client_t *c) {
+    // Perfil de latência: nenhum pacote espera pelos seguintes
+    if (c->transporte == PICO_NET_LATENCIA) return;
+    c->corked = true;
+}
+
+/**
+ * @brief Envia o que o cork acumulou como um único registro TLS.
+ */
+bool RAM_QUENTE(mqtt_client_flush)(mqtt_client_t *c) {
+    size_t len = c->tx_len;
+    unsigned pacotes = c->tx_pacotes;
+
+    if (len == 0) return true;
+    c->tx_len = 0;
+    c->tx_pacotes = 0;
+    if (c->state != MQTT_STATE_CONNECTED) return false;
+
+    if (mqtt_tls_write(c, c->tx_buf, len) < 0) {
+        c->state = MQTT_STATE_FAILED;
+        c->failure_stage = RECONNECT_TCP;
         return false;
     }
+    if (pacotes > 1) {
+        LOG_DEBUG("[MQTT] %u pacotes em um registro TLS (%u bytes).", pacotes, (unsigned)len);
+    }
+    return true;
+}
+
+bool mqtt_client_uncork(mqtt_client_t *c) {
+    c->corked = false;
+    return mqtt_client_flush(c);
+}
+
+/**
+ * @brief Lê um pacote MQTT sem bloquear.
+ *
+ * Retorna 1 quando um pacote completo está em rx_type/rx_len/rx_buf, 0 se ainda
+ * faltam bytes e -1 se a conexão caiu. Corpos maiores que MQTT_RX_BUF_SIZE são
+ * lidos e descartados além desse limite.
+ */
+static int mqtt_read_packet(mqtt_client_t *c) {
+    int ret;
+
+    if (c->rx_complete) {
+        // O pacote anterior já foi consumido; começa o próximo
+        c->rx_complete = false;
+        c->rx_hdr_done = false;
+        c->rx_hdr_len = 0;
+        c->rx_len = 0;
+        c->rx_got = 0;
+    }
+
+    // Cabeçalho fixo: 1 byte de tipo + Remaining Length (varint de até 4 bytes)
+    while (!c->rx_hdr_done) {
+        uint8_t b;
+        ret = mbedtls_ssl_read(&c->ssl, &b, 1);
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) return 0;
+        if (ret <= 0) {
+            c->rx_erro = ret;
+            return -1;
+        }
+
+        if (c->rx_hdr_len == 0) {
+            c->rx_type = b;
+        } else {
+            c->rx_len |= (uint32_t)(b & 0x7F) << (7 * (c->rx_hdr_len - 1));
+            if (!(b & 0x80)) {
+                c->rx_hdr_done = true;
+            } else if (c->rx_hdr_len == 4) {
+                return -1; // Remaining Length malformado
+            }
+        }
+        c->rx_hdr_len++;
+    }
+
+    // Corpo
+    while (c->rx_got < c->rx_len) {
+        uint8_t discard[16];
+        uint8_t *dst;
+        size_t want = c->rx_len - c->rx_got;
+
+        if (c->rx_got < MQTT_RX_BUF_SIZE) {
+            dst = &c->rx_buf[c->rx_got];
+            if (want > MQTT_RX_BUF_SIZE - c->rx_got) want = MQTT_RX_BUF_SIZE - c->rx_got;
+        } else {
+            dst = discard;
+            if (want > sizeof(discard)) want = sizeof(discard);
+        }
+
+        ret = mbedtls_ssl_read(&c->ssl, dst, want);
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) return 0;
+        if (ret <= 0) {
+            c->rx_erro = ret;
+            return -1;
+        }
+        c->rx_got += ret;
+    }
+
+    c->rx_complete = true;
+    return 1;
+}
+
+/**
+ * @brief Codifica o Remaining Length (varint de até 4 bytes). Retorna quantos bytes usou.
+ */
+static size_t RAM_QUENTE(mqtt_encode_rl)(uint8_t *dst, size_t len) {
+    size_t n = 0;
+    do {
+        uint8_t b = len & 0x7F;
+        len >>= 7;
+        dst[n++] = len ? (b | 0x80) : b;
+    } while (len && n < 4);
+    return n;
+}
+
+/**
+ * @brief Publica uma mensagem em um tópico MQTT montado em tempo de execução.
+ */
+bool mqtt_client_publish(mqtt_client_t *c, const char *topic, const char *payload) {
+    if (c->state != MQTT_STATE_CONNECTED) {
+        LOG_AVISO("[MQTT] Não é possível publicar: desconectado.");
+        return false;
+    }
+
+    size_t topic_len = strlen(topic);
+    size_t payload_len = strlen(payload);
+    size_t props_len = c->protocol_version == MQTT_VERSAO_5 ? 1 : 0;
+    size_t remaining_length = 2 + topic_len + props_len + payload_len;
 
     // Limite simples para o tamanho do pacote
     uint8_t packet[256];
-    size_t pos = 0;
+    if (1 + 2 + remaining_length > sizeof(packet)) {
+        LOG_AVISO("[MQTT] Mensagem grande demais para '%s'.", topic);
+        return false;
+    }
 
-    // Cabeçalho Fixo do Publish (QoS 0)
+    // Cabeçalho Fixo do Publish (QoS 0) + Remaining Length
+    size_t pos = 0;
     packet[pos++] = 0x30;
-    size_t rl_pos = pos++; // Posição para o "Remaining Length"
+    pos += mqtt_encode_rl(&packet[pos], remaining_length);
 
     // Comprimento do Tópico + Tópico
-    size_t topic_len = strlen(topic);
     packet[pos++] = (topic_len >> 8) & 0xFF;
     packet[pos++] = topic_len & 0xFF;
     memcpy(&packet[pos], topic, topic_len);
     pos += topic_len;
 
+    // MQTT 5: propriedades (nenhuma)
+    if (props_len) {
+        packet[pos++] = 0x00;
+    }
+
     // Payload (mensagem)
-    size_t payload_len = strlen(payload);
     memcpy(&packet[pos], payload, payload_len);
     pos += payload_len;
 
-    // Calcula e insere o "Remaining Length"
-    size_t remaining_length = pos - 2;
-    packet[rl_pos] = remaining_length;
-
     // Envia o pacote completo
-    printf("[MQTT] Publicando '%s' em '%s'\n", payload, topic);
-    if (mqtt_send_packet(packet, pos) > 0) {
+    LOG_INFO("[MQTT] Publicando '%s' em '%s'", payload, topic);
+    if (mqtt_send_packet(c, packet, pos) > 0) {
         return true;
     }
-    
+
     // Se o envio falhar, assume que a conexão caiu
-    g_mqtt_connected = false;
+    c->state = MQTT_STATE_FAILED;
+    c->failure_stage = RECONNECT_TCP;
     return false;
 }
 
 /**
- * @brief Estabelece a conexão com o broker MQTT.
+ * @brief Alias já atribuído ao tópico nesta conexão (0 = nenhum).
  */
-bool mqtt_connect(void) {
+static uint16_t RAM_QUENTE(mqtt_topic_alias)(const mqtt_client_t *c, const mqtt_topic_t *topic) {
+    for (uint16_t i = 0; i < c->alias_count; i++) {
+        if (c->aliases[i] == topic) return i + 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Tamanho que o PUBLISH teria em v3.1.1 (base para medir a economia dos aliases).
+ */
+static size_t RAM_QUENTE(mqtt_publish_size_v311)(const mqtt_topic_t *topic, size_t len) {
+    size_t remaining_length = 2 + topic->topic_len + len;
+    return 1 + (remaining_length < 128 ? 1 : 2) + remaining_length;
+}
+
+/**
+ * @brief Publica em um tópico fixo (ver mqtt_topics.h).
+ *
+ * O prefixo e o tópico já estão no buffer do descritor; só o payload é copiado
+ * (em MQTT 5, precedido das propriedades). O Remaining Length ocupa 1 byte (< 128)
+ * ou 2 bytes; no primeiro caso o cabeçalho é escrito um byte adiante e o envio
+ * começa em buf + 1.
+ *
+ * Em MQTT 5, a primeira publicação num tópico associa a ele um alias (se o broker
+ * permitir); as seguintes enviam o tópico vazio e só o alias, montadas numa pilha
+ * pequena sem tocar nos bytes do tópico.
+ */
+bool RAM_QUENTE(mqtt_client_publish_topic)(mqtt_client_t *c, const mqtt_topic_t *topic, const uint8_t *payload, size_t len) {
+    if (c->state != MQTT_STATE_CONNECTED) {
+        LOG_AVISO("[MQTT] Não é possível publicar: desconectado.");
+        return false;
+    }
+    if (len > MQTT_TOPIC_MAX_PAYLOAD) {
+        LOG_AVISO("[MQTT] Payload grande demais (%u bytes).", (unsigned)len);
+        return false;
+    }
+
+    uint16_t alias = 0;
+    bool new_alias = false;
     int ret;
-    char error_buf[100]; // Buffer para mensagens de erro
 
-    // 1. Inicializa todas as estruturas necessárias
-    pico_net_init(&server_fd);
-    mbedtls_ssl_init(&ssl);
-    mbedtls_ssl_config_init(&conf);
-    mbedtls_ctr_drbg_init(&ctr_drbg);
-    mbedtls_entropy_init(&entropy);
+    if (c->protocol_version == MQTT_VERSAO_5) {
+        alias = mqtt_topic_alias(c, topic);
+        if (!alias && c->alias_count < c->topic_alias_max && c->alias_count < MQTT_MAX_TOPIC_ALIASES) {
+            c->aliases[c->alias_count++] = topic;
+            alias = c->alias_count;
+            new_alias = true;
+        }
+    }
 
-    if ((ret = mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy, NULL, 0)) != 0) {
-        printf("[MQTT] Falha em mbedtls_ctr_drbg_seed: -0x%x\n", -ret);
-        goto error;
+    if (alias && !new_alias) {
+        // Tópico vazio + propriedade Topic Alias
+        uint8_t packet[3 + 2 + 4 + MQTT_TOPIC_MAX_PAYLOAD];
+        size_t remaining_length = 2 + 4 + len;
+        size_t pos = 0;
+
+        packet[pos++] = 0x30;
+        pos += mqtt_encode_rl(&packet[pos], remaining_length);
+        packet[pos++] = 0x00;
+        packet[pos++] = 0x00;
+        packet[pos++] = 3;                     // Comprimento das propriedades
+        packet[pos++] = MQTT_PROP_TOPIC_ALIAS;
+        packet[pos++] = alias >> 8;
+        packet[pos++] = alias & 0xFF;
+        memcpy(&packet[pos], payload, len);
+        pos += len;
+
+        size_t saved = mqtt_publish_size_v311(topic, len) - pos;
+        c->bytes_saved += saved;
+        LOG_INFO("[MQTT] Publicando %u bytes via alias %u (%u bytes a menos que v3.1.1)",
+               (unsigned)len, alias, (unsigned)saved);
+        ret = mqtt_send_packet(c, packet, pos);
+    } else {
+        uint8_t *buf = topic->buf;
+        size_t body_end = MQTT_TOPIC_PREFIX_LEN + topic->topic_len;
+        size_t props_len = 0;
+        uint8_t *start;
+
+        if (c->protocol_version == MQTT_VERSAO_5) {
+            // Propriedades: só o alias que está sendo associado, ou nenhuma
+            if (alias) {
+                buf[body_end + 0] = 3;
+                buf[body_end + 1] = MQTT_PROP_TOPIC_ALIAS;
+                buf[body_end + 2] = alias >> 8;
+                buf[body_end + 3] = alias & 0xFF;
+                props_len = 4;
+            } else {
+                buf[body_end] = 0;
+                props_len = 1;
+            }
+        }
+
+        c->bytes_saved -= (int32_t)props_len;   // Sem alias, v5 só acrescenta as propriedades
+
+        size_t remaining_length = 2 + topic->topic_len + props_len + len;
+        memcpy(&buf[body_end + props_len], payload, len);
+        if (remaining_length < 128) {
+            buf[1] = 0x30;
+            buf[2] = (uint8_t)remaining_length;
+            start = &buf[1];
+        } else {
+            buf[0] = 0x30;
+            buf[1] = (uint8_t)(remaining_length & 0x7F) | 0x80;
+            buf[2] = (uint8_t)(remaining_length >> 7);
+            start = &buf[0];
+        }
+
+        if (new_alias) {
+            LOG_INFO("[MQTT] Publicando %u bytes em '%.*s' (alias %u associado)",
+                   (unsigned)len, topic->topic_len, (const char *)&buf[MQTT_TOPIC_PREFIX_LEN], alias);
+        } else {
+            LOG_INFO("[MQTT] Publicando %u bytes em '%.*s'", (unsigned)len, topic->topic_len, (const char *)&buf[MQTT_TOPIC_PREFIX_LEN]);
+        }
+        ret = mqtt_send_packet(c, start, &buf[body_end + props_len + len] - start);
     }
 
-    // 2. Conecta via TCP usando a camada de rede (pico_net)
-    printf("[MQTT] Conectando TCP a %s:%s...\n", BROKER_HOST, BROKER_PORT);
-    if (!pico_net_connect(&server_fd, BROKER_HOST, atoi(BROKER_PORT))) {
-        printf("[MQTT] Falha na conexão TCP.\n");
-        goto error;
+    if (ret > 0) {
+        return true;
     }
-    absolute_time_t timeout = make_timeout_time_ms(10000); // 10s timeout
-    while (server_fd.state == CONN_CONNECTING && !time_reached(timeout)) {
-        cyw43_arch_poll();
+
+    c->state = MQTT_STATE_FAILED;
+    c->failure_stage = RECONNECT_TCP;
+    return false;
+}
+
+/**
+ * @brief Envia um PINGREQ.
+ */
+bool mqtt_client_ping(mqtt_client_t *c) {
+    static const uint8_t pingreq[] = { 0xC0, 0x00 };
+
+    if (c->state != MQTT_STATE_CONNECTED) return false;
+    // Medida de round-trip: não pode esperar o uncork
+    if (mqtt_send_packet(c, pingreq, sizeof(pingreq)) > 0 && mqtt_client_flush(c)) return true;
+
+    c->state = MQTT_STATE_FAILED;
+    c->failure_stage = RECONNECT_TCP;
+    return false;
+}
+
+/**
+ * @brief Consome os pacotes recebidos numa sessão ativa.
+ */
+int mqtt_client_process_input(mqtt_client_t *c) {
+    int pingresps = 0;
+    int ret;
+
+    if (c->state != MQTT_STATE_CONNECTED) return -1;
+
+    while ((ret = mqtt_read_packet(c)) == 1) {
+        if ((c->rx_type & 0xF0) == MQTT_PKT_PINGRESP) {
+            pingresps++;
+        }
+        // Demais pacotes não são esperados numa sessão só de publicação (QoS 0)
     }
-    if (server_fd.state != CONN_CONNECTED) {
-        printf("[MQTT] Timeout/falha na conexão TCP.\n");
-        goto error;
+    if (ret < 0) {
+        c->state = MQTT_STATE_FAILED;
+        c->failure_stage = RECONNECT_TCP;
+        return -1;
     }
+    return pingresps;
+}
+
+#if defined(MBEDTLS_PLATFORM_MEMORY)
+// Contexto SSL e buffers de registro contados como subsistema próprio no heap
+static void *mqtt_tls_calloc(size_t n, size_t tam) {
+    return mem_diag_calloc(MEM_MBEDTLS, n, tam);
+}
+
+static void mqtt_tls_free(void *p) {
+    mem_diag_free(p);
+}
+#endif
+
+#if MEM_ESTATICA
+// Uma vaga TLS fixa por candidato da corrida, com os registros do tamanho configurado
+_Static_assert(MEM_TLS_SESSOES >= BROKER_CORRIDA, "MEM_TLS_SESSOES menor que BROKER_CORRIDA");
+_Static_assert(MEM_TLS_ENTRADA_LEN >= MBEDTLS_SSL_IN_CONTENT_LEN, "MEM_TLS_ENTRADA_LEN menor que o registro de entrada");
+_Static_assert(MEM_TLS_SAIDA_LEN >= MBEDTLS_SSL_OUT_CONTENT_LEN, "MEM_TLS_SAIDA_LEN menor que o registro de saída");
+#endif
 
-    // 3. Configura o SSL/TLS
+/**
+ * @brief Prepara o DRBG e a configuração TLS (PSK, ciphersuite) uma única vez.
+ *
+ * Tudo o que não depende da rede sai do caminho de conexão e pode rodar no
+ * boot enquanto o Wi-Fi ainda está associando.
+ */
+bool mqtt_init(void) {
+    int ret;
+
+    if (conf_ready) return true;
+#if defined(MBEDTLS_PLATFORM_MEMORY)
+    // Antes de qualquer alocação do mbedTLS: todo bloco precisa do cabeçalho do mem_diag
+    mbedtls_platform_set_calloc_free(mqtt_tls_calloc, mqtt_tls_free);
+#endif
+    if (!rng_init()) return false;
+
+    mbedtls_ssl_config_init(&conf);
     if ((ret = mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT)) != 0) {
         printf("[MQTT] Falha em mbedtls_ssl_config_defaults: -0x%x\n", -ret);
         goto error;
     }
-    mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &ctr_drbg);
+    mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, rng_drbg());
+    mem_diag_tls_sessao(MEM_TLS_CONFIG);   // Cópias da PSK e da identidade
 
-    // 4. Configura a autenticação PSK (Pre-Shared Key)
+    // Autenticação PSK (Pre-Shared Key)
     if ((ret = mbedtls_ssl_conf_psk(&conf, psk, sizeof(psk), (const unsigned char *)PSK_IDENTITY, strlen(PSK_IDENTITY))) != 0) {
         printf("[MQTT] Falha em mbedtls_ssl_conf_psk: -0x%x\n", -ret);
         goto error;
     }
-    const int ciphersuite[] = { MBEDTLS_TLS_PSK_WITH_AES_128_CBC_SHA256, 0 };
-    mbedtls_ssl_conf_ciphersuites(&conf, ciphersuite);
-    
-    // 5. Associa a configuração SSL e os callbacks de rede
-    if ((ret = mbedtls_ssl_setup(&ssl, &conf)) != 0) {
-        printf("[MQTT] Falha em mbedtls_ssl_setup: -0x%x\n", -ret);
-        goto error;
+    mbedtls_ssl_conf_ciphersuites(&conf, ciphersuites);
+
+    conf_ready = true;
+    return true;
+
+error:
+    mbedtls_ssl_config_free(&conf);
+    return false;
+}
+
+/**
+ * @brief Configura um cliente. Não abre conexão.
+ */
+void mqtt_client_init(mqtt_client_t *c, const char *host, uint16_t port, const char *client_id) {
+    memset(c, 0, sizeof(*c));
+    c->host = host;
+    c->port = port;
+    snprintf(c->client_id, sizeof(c->client_id), "%s", client_id);
+    c->protocol_version = MQTT_VERSAO;
+    c->transporte = MQTT_TRANSPORTE;
+    c->state = MQTT_STATE_IDLE;
+    c->failure_stage = RECONNECT_TCP;
+}
+
+/**
+ * @brief Troca o perfil de transporte; na sessão aberta, envia antes o que o cork acumulou.
+ */
+void mqtt_client_set_transport(mqtt_client_t *c, pico_net_perfil_t perfil) {
+    c->transporte = perfil;
+    if (perfil == PICO_NET_LATENCIA && c->corked) {
+        mqtt_client_uncork(c);
+    }
+    if (c->session_open) {
+        pico_net_set_profile(&c->net, perfil);
     }
-    mbedtls_ssl_set_bio(&ssl, &server_fd, (mbedtls_ssl_send_t *)pico_net_send, (mbedtls_ssl_recv_t *)pico_net_recv, NULL);
+}
+
+/**
+ * @brief Aloca a sessão e dispara a conexão TCP sem bloquear.
+ */
+bool mqtt_client_start(mqtt_client_t *c) {
+    int ret;
+
+    // Uma sessão anterior (ex.: publicação que falhou) é liberada antes de recomeçar
+    mqtt_client_close(c);
 
-    // 6. Realiza o Handshake TLS
-    printf("[MQTT] Realizando handshake TLS...\n");
-    timeout = make_timeout_time_ms(10000);
-    while ((ret = mbedtls_ssl_handshake(&ssl)) != 0) {
-        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
-            mbedtls_strerror(ret, error_buf, sizeof(error_buf));
-            printf("[MQTT] Handshake falhou: -0x%x -> %s\n", -ret, error_buf);
-            goto error;
+    // Aliases e limites valem só para a conexão em que foram negociados
+    c->fallback = false;
+    c->topic_alias_max = 0;
+    c->receive_max = 0xFFFF;
+    c->alias_count = 0;
+
+    c->failure_stage = RECONNECT_TLS;
+    if (!mqtt_init()) {
+        c->state = MQTT_STATE_FAILED;
+        return false;
+    }
+
+    // 1. Inicializa as estruturas da sessão
+    pico_net_init(&c->net);
+    pico_net_set_profile(&c->net, c->transporte);
+    mbedtls_ssl_init(&c->ssl);
+    c->session_open = true;
+
+    // 2. Associa a configuração SSL (pronta desde mqtt_init) e os callbacks de rede
+    mem_diag_tls_sessao(c->tls_sessao);
+    if ((ret = mbedtls_ssl_setup(&c->ssl, &conf)) != 0) {
+        mqtt_fail(c, "mbedtls_ssl_setup", ret);
+        return false;
+    }
+    mbedtls_ssl_set_bio(&c->ssl, &c->net, (mbedtls_ssl_send_t *)pico_net_send, (mbedtls_ssl_recv_t *)pico_net_recv, NULL);
+
+    // 3. Conecta via TCP usando a camada de rede (pico_net)
+    c->failure_stage = RECONNECT_TCP;
+    LOG_INFO("[MQTT] Conectando TCP a %s:%u...", c->host, c->port);
+    if (!pico_net_connect(&c->net, c->host, c->port)) {
+        mqtt_fail(c, "falha na conexão TCP", 0);
+        return false;
+    }
+    c->state = MQTT_STATE_TCP_CONNECTING;
+    c->deadline = make_timeout_time_ms(MQTT_TCP_TIMEOUT_MS);
+    return true;
+}
+
+/**
+ * @brief Avança a conexão uma etapa, sem bloquear.
+ */
+mqtt_state_t mqtt_client_step(mqtt_client_t *c) {
+    int ret;
+
+    mem_diag_tls_sessao(c->tls_sessao);    // O handshake aloca na vaga deste cliente
+
+    switch (c->state) {
+    case MQTT_STATE_TCP_CONNECTING:
+        if (c->net.state == CONN_RESOLVING || c->net.state == CONN_CONNECTING) {
+            if (time_reached(c->deadline)) mqtt_fail(c, "timeout na conexão TCP", 0);
+            break;
+        }
+        if (c->net.state != CONN_CONNECTED) {
+            mqtt_fail(c, "falha na conexão TCP", 0);
+            break;
         }
-        if (time_reached(timeout)) {
-            printf("[MQTT] Timeout no handshake.\n");
-            goto error;
+        boot_trace_mark("tcp_conectado");
+        c->failure_stage = RECONNECT_TLS; // Daqui em diante, falhas são da sessão segura
+        LOG_INFO("[MQTT] Realizando handshake TLS...");
+        c->state = MQTT_STATE_TLS_HANDSHAKE;
+        c->deadline = make_timeout_time_ms(MQTT_HANDSHAKE_TIMEOUT_MS);
+        // fallthrough - começa o handshake imediatamente
+
+    case MQTT_STATE_TLS_HANDSHAKE:
+        ret = mbedtls_ssl_handshake(&c->ssl);
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            if (time_reached(c->deadline)) mqtt_fail(c, "timeout no handshake", 0);
+            break;
+        }
+        if (ret != 0) {
+            mqtt_fail(c, "handshake falhou", ret);
+            break;
+        }
+        LOG_INFO("[MQTT] Handshake TLS bem-sucedido!");
+        boot_trace_mark("tls_ok");
+
+        if (!mqtt_send_connect(c)) {
+            mqtt_fail(c, "falha ao enviar pacote CONNECT", 0);
+            break;
+        }
+        LOG_INFO("[MQTT] Pacote CONNECT enviado. Aguardando CONNACK...");
+        c->state = MQTT_STATE_WAIT_CONNACK;
+        c->deadline = make_timeout_time_ms(MQTT_CONNACK_TIMEOUT_MS);
+        // fallthrough - o CONNACK pode já ter chegado
+
+    case MQTT_STATE_WAIT_CONNACK:
+        ret = mqtt_read_packet(c);
+        if (ret == 0) {
+            if (time_reached(c->deadline)) mqtt_fail(c, "timeout esperando por CONNACK", 0);
+            break;
+        }
+        if (ret < 0) {
+            // Brokers só v3.1.1 costumam fechar a conexão ao receber um CONNECT v5. Alerta
+            // TLS, reset ou erro de leitura não dizem nada da versão: não rebaixam o broker.
+            if (c->protocol_version == MQTT_VERSAO_5 && mqtt_fechado_apos_connect(c)) mqtt_fallback_v311(c);
+            mqtt_fail(c, "falha ao ler CONNACK", c->rx_erro);
+            break;
+        }
+        // CONNACK: 0x20 <RL> <flags> <código> [propriedades, em MQTT 5]
+        if (c->rx_type == MQTT_PKT_CONNACK && c->rx_len >= 2 && c->rx_buf[1] == 0x00) {
+            if (c->protocol_version == MQTT_VERSAO_5) {
+                mqtt_parse_connack_props(c);
+                LOG_INFO("[MQTT] Conexão MQTT 5 estabelecida! (Topic Alias Maximum: %u, Receive Maximum: %u)",
+                       c->topic_alias_max, c->receive_max);
+            } else {
+                LOG_INFO("[MQTT] Conexão MQTT estabelecida!");
+            }
+            boot_trace_mark("mqtt_connack");
+            c->state = MQTT_STATE_CONNECTED;
+        } else {
+            LOG_ERRO("[MQTT] CONNACK inválido (código: 0x%02x). Conexão rejeitada.", c->rx_buf[1]);
+            if (c->protocol_version == MQTT_VERSAO_5 &&
+                (c->rx_buf[1] == MQTT_CONNACK_V311_BAD_PROTOCOL || c->rx_buf[1] == MQTT_CONNACK_V5_BAD_PROTOCOL)) {
+                mqtt_fallback_v311(c);
+            }
+            mqtt_fail(c, "CONNACK rejeitado", 0);
+        }
+        break;
+
+    default:
+        break;
+    }
+    return c->state;
+}
+
+/**
+ * @brief Estabelece a conexão com o broker, bloqueando até concluir ou falhar.
+ */
+bool mqtt_client_connect(mqtt_client_t *c) {
+    if (!mqtt_client_start(c)) return false;
+
+    while (c->state != MQTT_STATE_CONNECTED && c->state != MQTT_STATE_FAILED) {
+        cyw43_arch_poll(); // Permite que a rede trabalhe
+        mqtt_client_step(c);
+    }
+
+    // Recusado em MQTT 5: tenta de novo na hora, já em v3.1.1
+    if (c->state == MQTT_STATE_FAILED && c->fallback) {
+        return mqtt_client_connect(c);
+    }
+    return c->state == MQTT_STATE_CONNECTED;
+}
+
+/**
+ * @brief O broker fechou a conexão de forma ordenada (FIN ou close_notify) sem mandar
+ * nenhum byte de resposta ao CONNECT. Um reset chega como CONN_FAILED no pico_net.
+ */
+static bool mqtt_fechado_apos_connect(const mqtt_client_t *c) {
+    if (c->rx_hdr_len != 0) return false;
+    if (c->rx_erro == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) return true;
+    return (c->rx_erro == 0 || c->rx_erro == MBEDTLS_ERR_NET_CONN_RESET) && c->net.state == CONN_CLOSING;
+}
+
+/**
+ * @brief Passa o cliente para v3.1.1 depois de o broker recusar o CONNECT v5.
+ */
+static void mqtt_fallback_v311(mqtt_client_t *c) {
+    LOG_AVISO("[MQTT] Broker não aceitou MQTT 5. Usando v3.1.1 nas próximas conexões.");
+    c->protocol_version = MQTT_VERSAO_311;
+    c->fallback = true;
+}
+
+/**
+ * @brief Lê as propriedades do CONNACK v5 que o cliente usa.
+ *
+ * Formato: <flags> <reason> <comprimento (varint)> <propriedades...>. As demais
+ * propriedades são puladas pelo tamanho do seu tipo. Se o CONNACK não coube
+ * inteiro em rx_buf, só a parte recebida é analisada.
+ */
+static void mqtt_parse_connack_props(mqtt_client_t *c) {
+    size_t n = c->rx_len < MQTT_RX_BUF_SIZE ? c->rx_len : MQTT_RX_BUF_SIZE;
+    const uint8_t *p = c->rx_buf;
+    size_t pos = 2;
+    uint32_t props_len = 0;
+    int shift = 0;
+
+    while (pos < n) {
+        uint8_t b = p[pos++];
+        props_len |= (uint32_t)(b & 0x7F) << shift;
+        shift += 7;
+        if (!(b & 0x80) || shift > 21) break;
+    }
+    if (pos + props_len < n) n = pos + props_len;
+
+    while (pos < n) {
+        uint8_t id = p[pos++];
+        size_t size;
+
+        switch (id) {
+        case MQTT_PROP_RECEIVE_MAXIMUM:
+        case MQTT_PROP_TOPIC_ALIAS_MAXIMUM:
+            if (pos + 2 > n) return;
+            if (id == MQTT_PROP_RECEIVE_MAXIMUM) {
+                c->receive_max = (uint16_t)(p[pos] << 8 | p[pos + 1]);
+            } else {
+                c->topic_alias_max = (uint16_t)(p[pos] << 8 | p[pos + 1]);
+            }
+            size = 2;
+            break;
+        case 0x01: case 0x17: case 0x19: case 0x24: case 0x25: case 0x28: case 0x29: case 0x2A:
+            size = 1;           // Byte
+            break;
+        case 0x13:
+            size = 2;           // Server Keep Alive
+            break;
+        case 0x02: case 0x11: case 0x18: case 0x27:
+            size = 4;           // Inteiro de 4 bytes
+            break;
+        case 0x0B:              // Varint
+            size = 1;
+            while (pos + size <= n && (p[pos + size - 1] & 0x80)) size++;
+            break;
+        case 0x03: case 0x08: case 0x09: case 0x12: case 0x15: case 0x16: case 0x1A: case 0x1C: case 0x1F:
+            if (pos + 2 > n) return;
+            size = 2 + (size_t)(p[pos] << 8 | p[pos + 1]); // String/binário com prefixo de tamanho
+            break;
+        case 0x26:              // Par de strings
+            if (pos + 2 > n) return;
+            size = 2 + (size_t)(p[pos] << 8 | p[pos + 1]);
+            if (pos + size + 2 > n) return;
+            size += 2 + (size_t)(p[pos + size] << 8 | p[pos + size + 1]);
+            break;
+        default:
+            return;             // Propriedade desconhecida: não dá para saber o tamanho
         }
-        cyw43_arch_poll();
+        pos += size;
     }
-    printf("[MQTT] Handshake TLS bem-sucedido!\n");
+}
 
-    // 7. Envia o pacote MQTT CONNECT
-    printf("[MQTT] Enviando pacote CONNECT...\n");
+/**
+ * @brief Monta e envia o pacote MQTT CONNECT.
+ */
+static bool mqtt_send_connect(mqtt_client_t *c) {
     uint8_t packet[128];
     size_t pos = 0;
 
@@ -185,7 +797,7 @@ bool mqtt_connect(void) {
     pos += strlen(proto_name);
 
     // Cabeçalho Variável: Nível do Protocolo
-    packet[pos++] = 4; // MQTT v3.1.1
+    packet[pos++] = c->protocol_version;
 
     // Cabeçalho Variável: Flags de Conexão
     packet[pos++] = 0x02; // Apenas Clean Session = 1
@@ -194,76 +806,239 @@ bool mqtt_connect(void) {
     packet[pos++] = 0x00; // Keep Alive MSB
     packet[pos++] = 60;   // Keep Alive LSB
 
+    // MQTT 5: propriedades do CONNECT (nenhuma; o broker anuncia os limites no CONNACK)
+    if (c->protocol_version == MQTT_VERSAO_5) {
+        packet[pos++] = 0x00;
+    }
+
     // Payload: Client ID
-    size_t client_id_len = strlen(DEVICE_ID);
+    size_t client_id_len = strlen(c->client_id);
     packet[pos++] = (client_id_len >> 8) & 0xFF; // Comprimento MSB
     packet[pos++] = client_id_len & 0xFF;        // Comprimento LSB
-    memcpy(&packet[pos], DEVICE_ID, client_id_len);
+    memcpy(&packet[pos], c->client_id, client_id_len);
     pos += client_id_len;
 
     // Atualiza o campo "Remaining Length" que deixamos em branco
     packet[rl_pos] = pos - 2;
 
-    if (mqtt_send_packet(packet, pos) <= 0) {
-        printf("[MQTT] Falha ao enviar pacote CONNECT.\n");
-        goto error;
+    return mqtt_send_packet(c, packet, pos) > 0;
+}
+
+/**
+ * @brief Libera a sessão e marca o cliente como FAILED (o log fica na macro mqtt_fail).
+ */
+static void mqtt_fail_estado(mqtt_client_t *c) {
+    mqtt_cleanup(c); // Libera todos os recursos em caso de falha
+    c->state = MQTT_STATE_FAILED;
+}
+
+/**
+ * @brief Encerra a sessão do cliente (ex.: após a queda do link Wi-Fi).
+ */
+void mqtt_client_close(mqtt_client_t *c) {
+    if (c->state == MQTT_STATE_CONNECTED) {
+        mqtt_client_flush(c);   // O que o cork acumulou sai antes do close_notify
+    }
+    if (c->session_open) {
+        mqtt_cleanup(c);
+    }
+    c->state = MQTT_STATE_IDLE;
+}
+
+/**
+ * @brief Libera todos os recursos de rede e TLS.
+ */
+static void mqtt_cleanup(mqtt_client_t *c) {
+    LOG_INFO("[MQTT] Limpando recursos...");
+    mbedtls_ssl_close_notify(&c->ssl);
+    pico_net_close(&c->net);
+    mbedtls_ssl_free(&c->ssl);
+    c->session_open = false;
+    c->rx_complete = false;
+    c->rx_hdr_done = false;
+    c->rx_hdr_len = 0;
+    c->rx_len = 0;
+    c->rx_got = 0;
+    c->rx_erro = 0;
+    c->corked = false;
+    c->tx_len = 0;
+    c->tx_pacotes = 0;
+}
+
+// --- API do dispositivo ---
+
+/**
+ * @brief Lança o candidato k da corrida contra o broker b da lista.
+ */
+static bool mqtt_race_start(int k, int b) {
+    const broker_t *br = broker_get(b);
+    mqtt_client_t *c = &device_clients[k];
+
+    mqtt_client_init(c, br->host, br->port, DEVICE_ID);
+    c->protocol_version = br->protocol_version;
+    c->tls_sessao = (uint8_t)k;
+    return mqtt_client_start(c);
+}
+
+/**
+ * @brief Registra a falha do candidato k (broker b) e guarda a etapa mais avançada
+ * alcançada entre todos, que decide o orçamento de reconexão.
+ */
+static void mqtt_race_failed(int k, int b) {
+    broker_report_failure(b);
+    if (device_clients[k].failure_stage == RECONNECT_TLS) device_failure = RECONNECT_TLS;
+}
+
+/**
+ * @brief Estabelece a conexão com o broker MQTT. Os melhores candidatos da lista
+ * disputam em paralelo: o primeiro é lançado na hora e o seguinte após
+ * MQTT_ESCALONAMENTO_MS (ou assim que o anterior falhar). Vence o primeiro a
+ * concluir TLS + CONNACK; os demais são encerrados sem penalidade.
+ */
+bool mqtt_connect(void) {
+    int cand[BROKER_CORRIDA];
+    bool ativo[BROKER_CORRIDA] = { false };
+    int iniciados = 0;
+    int vencedor = -1;
+
+    for (int k = 0; k < BROKER_CORRIDA; k++) {
+        mqtt_client_close(&device_clients[k]);
+    }
+    if (!brokers_ready) {
+        brokers_ready = broker_init();
+    }
+    device_failure = RECONNECT_TCP;
+    if (!brokers_ready) {
+        device_state_set_mqtt(false);
+        return false;
     }
 
-    // 8. Aguarda o CONNACK do broker
-    printf("[MQTT] Pacote CONNECT enviado. Aguardando CONNACK...\n");
-    uint8_t connack_resp[4];
-    timeout = make_timeout_time_ms(5000); // Timeout de 5s para a resposta
-    int bytes_read = 0;
+    int n = broker_candidates(cand, BROKER_CORRIDA);
+    uint64_t inicio = time_us_64();
+    absolute_time_t proximo = get_absolute_time();
 
-    // Loop não-bloqueante para ler a resposta completa
-    while (bytes_read < sizeof(connack_resp) && !time_reached(timeout)) {
-        ret = mbedtls_ssl_read(&ssl, connack_resp + bytes_read, sizeof(connack_resp) - bytes_read);
-        if (ret > 0) {
-            bytes_read += ret;
-        } else if (ret != MBEDTLS_ERR_SSL_WANT_READ) {
-            mbedtls_strerror(ret, error_buf, sizeof(error_buf));
-            printf("[MQTT] Falha ao ler CONNACK: -0x%x -> %s\n", -ret, error_buf);
-            goto error;
+    while (vencedor < 0) {
+        int em_curso = 0;
+        for (int k = 0; k < iniciados; k++) {
+            if (ativo[k]) em_curso++;
+        }
+
+        // Próximo candidato: no horário, ou já se todos os lançados falharam
+        if (iniciados < n && (em_curso == 0 || time_reached(proximo))) {
+            int k = iniciados++;
+            if (mqtt_race_start(k, cand[k])) {
+                ativo[k] = true;
+            } else {
+                mqtt_race_failed(k, cand[k]);
+            }
+            proximo = make_timeout_time_ms(MQTT_ESCALONAMENTO_MS);
+            continue;
         }
+        if (em_curso == 0) break;   // Todos falharam
+
         cyw43_arch_poll(); // Permite que a rede trabalhe
+        for (int k = 0; k < iniciados && vencedor < 0; k++) {
+            if (!ativo[k]) continue;
+            mqtt_client_t *c = &device_clients[k];
+            mqtt_state_t st = mqtt_client_step(c);
+
+            if (st == MQTT_STATE_CONNECTED) {
+                vencedor = k;
+            } else if (st == MQTT_STATE_FAILED) {
+                // Recusado em MQTT 5: o broker passa a usar v3.1.1 e o candidato recomeça
+                if (c->fallback) {
+                    broker_get(cand[k])->protocol_version = MQTT_VERSAO_311;
+                    if (mqtt_race_start(k, cand[k])) continue;
+                }
+                ativo[k] = false;
+                mqtt_race_failed(k, cand[k]);
+            }
+        }
     }
 
-    if (bytes_read < sizeof(connack_resp)) {
-        printf("[MQTT] Timeout esperando por CONNACK.\n");
-        goto error;
+    if (vencedor < 0) {
+        device_state_set_mqtt(false);
+        return false;
     }
-    
-    // Agora verifica a resposta recebida
-    if (connack_resp[0] == 0x20 && connack_resp[1] == 0x02 && connack_resp[3] == 0x00) {
-        printf("[MQTT] Conexão MQTT estabelecida!\n");
-        g_mqtt_connected = true;
-        return true; // Sucesso!
-    } else {
-        printf("[MQTT] CONNACK inválido (código: 0x%02x). Conexão rejeitada.\n", connack_resp[3]);
-        goto error;
+
+    for (int k = 0; k < iniciados; k++) {
+        if (k != vencedor) mqtt_client_close(&device_clients[k]);
+    }
+    device_client = &device_clients[vencedor];
+    broker_report_success(cand[vencedor], (uint32_t)((time_us_64() - inicio) / 1000));
+    device_state_set_mqtt(true);
+    return true;
+}
+
+/**
+ * @brief Publica uma mensagem em um tópico MQTT.
+ */
+bool mqtt_publish(const char *topic, const char *payload) {
+    if (!device_state_mqtt_conectado()) {
+        LOG_AVISO("[MQTT] Não é possível publicar: desconectado.");
+        return false;
+    }
+    if (mqtt_client_publish(device_client, topic, payload)) {
+        return true;
     }
 
-error:
-    mqtt_cleanup(); // Libera todos os recursos em caso de falha
+    // Se o envio falhar, assume que a conexão caiu
+    device_state_set_mqtt(device_client->state == MQTT_STATE_CONNECTED);
     return false;
 }
 
 /**
- * @brief Libera todos os recursos de rede e TLS.
+ * @brief Publica um payload em um tópico fixo.
  */
-static void mqtt_cleanup(void) {
-    printf("[MQTT] Limpando recursos...\n");
-    mbedtls_ssl_close_notify(&ssl);
-    pico_net_close(&server_fd);
-    mbedtls_ssl_free(&ssl);
-    mbedtls_ssl_config_free(&conf);
-    mbedtls_ctr_drbg_free(&ctr_drbg);
-    mbedtls_entropy_free(&entropy);
-    g_mqtt_connected = false;
+bool mqtt_publish_topic(const mqtt_topic_t *topic, const uint8_t *payload, size_t len) {
+    if (!device_state_mqtt_conectado()) {
+        LOG_AVISO("[MQTT] Não é possível publicar: desconectado.");
+        return false;
+    }
+    if (mqtt_client_publish_topic(device_client, topic, payload, len)) {
+        return true;
+    }
+
+    // Se o envio falhar, assume que a conexão caiu
+    device_state_set_mqtt(device_client->state == MQTT_STATE_CONNECTED);
+    return false;
+}
+
+void mqtt_cork(void) {
+    if (device_client->state == MQTT_STATE_CONNECTED) {
+        mqtt_client_cork(device_client);
+    }
+}
+
+bool mqtt_flush(void) {
+    bool ok = mqtt_client_flush(device_client);
+    device_state_set_mqtt(device_client->state == MQTT_STATE_CONNECTED);
+    return ok;
+}
+
+bool mqtt_uncork(void) {
+    bool ok = mqtt_client_uncork(device_client);
+    device_state_set_mqtt(device_client->state == MQTT_STATE_CONNECTED);
+    return ok;
+}
+
+/**
+ * @brief Classe da falha da última chamada malsucedida a mqtt_connect().
+ */
+reconnect_class_t mqtt_last_failure(void) {
+    return device_failure;
+}
+
+/**
+ * @brief Encerra a sessão com o broker (ex.: após a queda do link Wi-Fi).
+ */
+void mqtt_disconnect(void) {
+    mqtt_client_close(device_client);
+    device_state_set_mqtt(false);
 }
 
 // Opcional: callback de debug do mbedTLS
 static void my_debug(void *ctx, int level, const char *file, int line, const char *str) {
     // Para depuração intensa, você pode habilitar isso
     printf("mbedTLS: %s:%04d: %s", file, line, str);
-}
\ No newline at end of file
+}
@@ -0,0 +1,7 @@
+#include "mqtt_topics.h"
+#include "shared_vars.h"
+
+MQTT_TOPIC_DEFINE(mqtt_topic_temperatura, MQTT_TOPICO_TEMPERATURA, MQTT_FORMATO_TEMPERATURA);
+MQTT_TOPIC_DEFINE(mqtt_topic_botao_a, MQTT_TOPICO_BOTAO_A, MQTT_FORMATO_BOTOES);
+MQTT_TOPIC_DEFINE(mqtt_topic_botao_b, MQTT_TOPICO_BOTAO_B, MQTT_FORMATO_BOTOES);
+MQTT_TOPIC_DEFINE(mqtt_topic_diag_memoria, MQTT_TOPICO_DIAG_MEMORIA, MQTT_FORMATO_DIAG);
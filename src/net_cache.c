@@ -0,0 +1,76 @@
+#include "net_cache.h"
+#include "shared_vars.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+// Último setor da flash, longe do binário do firmware
+#define NET_CACHE_FLASH_OFFSET  (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define NET_CACHE_MAGIC         0x4E434331u // "NCC1"
+
+// Layout gravado na flash: cabeçalho + dados + checksum
+typedef struct {
+    uint32_t magic;
+    net_cache_t data;
+    uint32_t checksum;
+} net_cache_record_t;
+
+// FNV-1a de 32 bits, suficiente para detectar setor apagado ou gravação interrompida
+static uint32_t fnv1a(const void *buf, size_t len) {
+    const uint8_t *p = (const uint8_t *)buf;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t net_cache_ssid_hash(void) {
+    return fnv1a(WIFI_SSID, strlen(WIFI_SSID));
+}
+
+static const net_cache_record_t *net_cache_flash(void) {
+    return (const net_cache_record_t *)(XIP_BASE + NET_CACHE_FLASH_OFFSET);
+}
+
+bool net_cache_load(net_cache_t *out) {
+    const net_cache_record_t *rec = net_cache_flash();
+
+    if (rec->magic != NET_CACHE_MAGIC) return false;
+    if (rec->checksum != fnv1a(&rec->data, sizeof(rec->data))) return false;
+    if (rec->data.ssid_hash != net_cache_ssid_hash()) return false;
+
+    memcpy(out, &rec->data, sizeof(*out));
+    return true;
+}
+
+bool net_cache_store(const net_cache_t *cache) {
+    const net_cache_record_t *current = net_cache_flash();
+    if (current->magic == NET_CACHE_MAGIC && memcmp(&current->data, cache, sizeof(*cache)) == 0) {
+        return true; // Nada mudou, poupa um ciclo de apagamento da flash
+    }
+
+    // A gravação é feita em páginas inteiras
+    static uint8_t page[FLASH_PAGE_SIZE] __attribute__((aligned(4)));
+    memset(page, 0xFF, sizeof(page));
+
+    net_cache_record_t rec;
+    rec.magic = NET_CACHE_MAGIC;
+    rec.data = *cache;
+    rec.checksum = fnv1a(&rec.data, sizeof(rec.data));
+    memcpy(page, &rec, sizeof(rec));
+
+    // Nenhum código pode executar da flash (XIP) durante o apagamento/gravação
+    uint32_t irq = save_and_disable_interrupts();
+    flash_range_erase(NET_CACHE_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(NET_CACHE_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
+    restore_interrupts(irq);
+
+    printf("[NET_CACHE] Cache de rede gravado na flash (canal %d).\n", cache->channel);
+    return true;
+}
@@ -0,0 +1,143 @@
+#include "payload.h"
+#include "cbor.h"
+
+#include <stdio.h>
+
+/**
+ * @brief Converte o retorno do snprintf em tamanho escrito (0 se truncou).
+ */
+static size_t payload_text_len(int n, size_t cap) {
+    return (n < 0 || (size_t)n >= cap) ? 0 : (size_t)n;
+}
+
+size_t payload_valores(const mqtt_topic_t *topic, const char *nome, uint8_t chave,
+                       const float *valores, const uint64_t *t_ms, size_t n,
+                       uint8_t *buf, size_t cap) {
+    cbor_writer_t w;
+    size_t o = 0;
+
+    if (n == 0) return 0;
+    float ultimo = valores[n - 1];
+    // Sem horário da primeira amostra (relógio não sincronizado na captura ou na publicação)
+    // o payload sai sem timestamps
+    bool com_tempo = t_ms != NULL && t_ms[0] != 0;
+
+    switch (topic->format) {
+    case MQTT_FORMATO_CBOR:
+        cbor_writer_init(&w, buf, cap);
+        cbor_put_map(&w, com_tempo ? (n > 1 ? 3 : 2) : 1);
+        if (com_tempo) {
+            cbor_put_uint(&w, PAYLOAD_CHAVE_TIMESTAMP);
+            cbor_put_uint(&w, t_ms[0]);
+        }
+        cbor_put_uint(&w, chave);
+        if (n > 1) cbor_put_array(&w, n);
+        for (size_t i = 0; i < n; i++) {
+            cbor_put_float(&w, valores[i]);
+        }
+        if (com_tempo && n > 1) {
+            // Intervalos em vez de horários absolutos: 1–3 bytes cada em vez de 9
+            cbor_put_uint(&w, PAYLOAD_CHAVE_INTERVALOS);
+            cbor_put_array(&w, n - 1);
+            for (size_t i = 1; i < n; i++) {
+                cbor_put_uint(&w, t_ms[i] > t_ms[i - 1] ? t_ms[i] - t_ms[i - 1] : 0);
+            }
+        }
+        return cbor_writer_finish(&w);
+    case MQTT_FORMATO_JSON:
+        if (t_ms != NULL && t_ms[n - 1] != 0) {
+            return payload_text_len(snprintf((char *)buf, cap, "{\"%s\":%.2f,\"ts\":%llu}", nome, ultimo,
+                                             (unsigned long long)t_ms[n - 1]), cap);
+        }
+        return payload_text_len(snprintf((char *)buf, cap, "{\"%s\":%.2f}", nome, ultimo), cap);
+    default:
+        // Uma linha por amostra, "valor horário"; amostra sem horário leva só o valor
+        for (size_t i = 0; i < n; i++) {
+            const char *sep = i ? "\n" : "";
+            int r = (t_ms != NULL && t_ms[i] != 0)
+                        ? snprintf((char *)buf + o, cap - o, "%s%.2f %llu", sep, valores[i], (unsigned long long)t_ms[i])
+                        : snprintf((char *)buf + o, cap - o, "%s%.2f", sep, valores[i]);
+            if (payload_text_len(r, cap - o) == 0) return 0;
+            o += (size_t)r;
+        }
+        return o;
+    }
+}
+
+size_t payload_temperatura(const mqtt_topic_t *topic, float celsius, uint8_t *buf, size_t cap) {
+    return payload_valores(topic, "temperatura", PAYLOAD_CHAVE_TEMPERATURA, &celsius, NULL, 1, buf, cap);
+}
+
+size_t payload_botao(const mqtt_topic_t *topic, bool pressionado, uint64_t t_ms, uint8_t *buf, size_t cap) {
+    const char *estado = pressionado ? "pressionado" : "liberado";
+    cbor_writer_t w;
+
+    switch (topic->format) {
+    case MQTT_FORMATO_CBOR:
+        cbor_writer_init(&w, buf, cap);
+        cbor_put_map(&w, t_ms ? 2 : 1);
+        if (t_ms) {
+            cbor_put_uint(&w, PAYLOAD_CHAVE_TIMESTAMP);
+            cbor_put_uint(&w, t_ms);
+        }
+        cbor_put_uint(&w, PAYLOAD_CHAVE_ESTADO);
+        cbor_put_bool(&w, pressionado);
+        return cbor_writer_finish(&w);
+    case MQTT_FORMATO_JSON:
+        if (t_ms) {
+            return payload_text_len(snprintf((char *)buf, cap, "{\"estado\":\"%s\",\"ts\":%llu}", estado,
+                                             (unsigned long long)t_ms), cap);
+        }
+        return payload_text_len(snprintf((char *)buf, cap, "{\"estado\":\"%s\"}", estado), cap);
+    default:
+        return payload_text_len(snprintf((char *)buf, cap, "%s", estado), cap);
+    }
+}
+
+size_t payload_memoria(const mqtt_topic_t *topic, const mem_diag_t *d, uint8_t *buf, size_t cap) {
+    cbor_writer_t w;
+    size_t o = 0;
+    int n;
+
+    switch (topic->format) {
+    case MQTT_FORMATO_CBOR:
+        cbor_writer_init(&w, buf, cap);
+        cbor_put_map(&w, 3);
+        cbor_put_uint(&w, PAYLOAD_CHAVE_MEMORIA);
+        cbor_put_array(&w, MEM_SUBSISTEMAS);
+        for (int s = 0; s < MEM_SUBSISTEMAS; s++) {
+            cbor_put_array(&w, 3);
+            cbor_put_uint(&w, d->sub[s].atual);
+            cbor_put_uint(&w, d->sub[s].pico);
+            cbor_put_uint(&w, d->sub[s].falhas);
+        }
+        cbor_put_uint(&w, PAYLOAD_CHAVE_HEAP);
+        cbor_put_array(&w, 2);
+        cbor_put_uint(&w, d->heap_uso);
+        cbor_put_uint(&w, d->heap_total);
+        cbor_put_uint(&w, PAYLOAD_CHAVE_PILHAS);
+        cbor_put_array(&w, 2);
+        cbor_put_uint(&w, d->pilha[0].usado);
+        cbor_put_uint(&w, d->pilha[1].usado);
+        return cbor_writer_finish(&w);
+    case MQTT_FORMATO_JSON:
+        if (cap == 0) return 0;
+        buf[o++] = '{';
+        for (int s = 0; s < MEM_SUBSISTEMAS && o < cap; s++) {
+            n = snprintf((char *)buf + o, cap - o, "\"%s\":[%lu,%lu,%lu],", mem_diag_nome((mem_subsistema_t)s),
+                         (unsigned long)d->sub[s].atual, (unsigned long)d->sub[s].pico,
+                         (unsigned long)d->sub[s].falhas);
+            if (payload_text_len(n, cap - o) == 0) return 0;
+            o += (size_t)n;
+        }
+        n = snprintf((char *)buf + o, cap - o, "\"heap\":[%lu,%lu],\"pilhas\":[%lu,%lu]}",
+                     (unsigned long)d->heap_uso, (unsigned long)d->heap_total,
+                     (unsigned long)d->pilha[0].usado, (unsigned long)d->pilha[1].usado);
+        if (payload_text_len(n, cap - o) == 0) return 0;
+        return o + (size_t)n;
+    default:
+        return payload_text_len(snprintf((char *)buf, cap, "heap %lu/%lu pilhas %lu/%lu",
+                                         (unsigned long)d->heap_uso, (unsigned long)d->heap_total,
+                                         (unsigned long)d->pilha[0].usado, (unsigned long)d->pilha[1].usado), cap);
+    }
+}
@@ -1,7 +1,11 @@
 #include "pico_net.h"
+#include "binlog.h"
+#include "xip_cache.h"
 #include "lwip/tcp.h"
 #include "lwip/dns.h"
 #include "lwip/err.h"
+#include "pico/time.h"
+#include <stdio.h>
 #include <string.h>
 #include "mbedtls/net_sockets.h"
 
@@ -12,7 +16,7 @@
  */
 
 // net_connected_cb: Callback chamada quando a conexão TCP é estabelecida com sucesso ou falha.
-// Ela atualiza o estado da conexão no contexto e notifica via printf se bem-sucedida. [web:5]
+// Ela atualiza o estado da conexão no contexto e registra no log binário se bem-sucedida. [web:5]
 static err_t net_connected_cb(void *arg, struct tcp_pcb *tpcb, err_t err);
 
 // net_recv_cb: Callback chamada quando dados são recebidos na conexão TCP.
@@ -20,9 +24,39 @@ static err_t net_connected_cb(void *arg, struct tcp_pcb *tpcb, err_t err);
 static err_t net_recv_cb(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
 
 // net_error_cb: Callback chamada em caso de erro na conexão TCP.
-// Ela atualiza o estado para falha e registra o erro via printf. [web:5]
+// Ela atualiza o estado para falha e registra o erro no log binário. [web:5]
 static void net_error_cb(void *arg, err_t err);
 
+// net_dns_cb: Callback chamada pelo lwIP com o resultado de uma consulta DNS (ou NULL
+// em caso de falha/timeout). Dispara a conexão TCP do contexto que pediu o nome.
+static void net_dns_cb(const char *name, const ip_addr_t *ipaddr, void *arg);
+
+/*
+ * Cache DNS.
+ * As respostas positivas ficam na tabela do próprio lwIP (DNS_TABLE_SIZE entradas), que
+ * respeita o TTL de cada registro: enquanto ele vale, dns_gethostbyname() responde na hora.
+ * O lwIP não guarda falhas, então os nomes que não resolveram ficam aqui por
+ * PICO_NET_DNS_NEGATIVO_MS, para que uma reconexão não espere de novo pelo timeout.
+ */
+#define PICO_NET_DNS_NEGATIVO       4
+#define PICO_NET_DNS_NEGATIVO_MS    30000
+#define PICO_NET_DNS_PENDENTES      4
+
+typedef struct {
+    char nome[DNS_MAX_NAME_LENGTH];
+    absolute_time_t ate;
+} dns_negativo_t;
+
+// Consulta em andamento. O slot sobrevive ao contexto (pico_net_close só o desliga),
+// porque o lwIP sempre chama net_dns_cb depois, com sucesso ou falha.
+typedef struct {
+    bool em_uso;
+    pico_net_context *ctx;
+} dns_pendente_t;
+
+static dns_negativo_t dns_negativos[PICO_NET_DNS_NEGATIVO];
+static dns_pendente_t dns_pendentes[PICO_NET_DNS_PENDENTES];
+
 /*
  * pico_net_init: Inicializa o contexto da rede (pico_net_context).
  * Limpa a memória do contexto, define o estado inicial como ocioso (CONN_IDLE),
@@ -36,38 +70,133 @@ void pico_net_init(pico_net_context *ctx) {
 }
 
 /*
- * pico_net_connect: Inicia uma conexão TCP com o host especificado pelo IP e porta.
- * Cria um novo PCB TCP usando tcp_new(), configura callbacks, converte o IP string para endereço,
- * e tenta conectar usando tcp_connect(). Retorna true se a conexão for iniciada com sucesso,
- * caso contrário, falha e fecha. [web:5]
+ * dns_negativo_vigente: Indica se 'nome' falhou há menos de PICO_NET_DNS_NEGATIVO_MS.
  */
-bool pico_net_connect(pico_net_context *ctx, const char *host_ip, uint16_t port) {
-    ip_addr_t target_ip;
-    ip4addr_aton(host_ip, &target_ip);
+static bool dns_negativo_vigente(const char *nome) {
+    for (int i = 0; i < PICO_NET_DNS_NEGATIVO; i++) {
+        dns_negativo_t *e = &dns_negativos[i];
+        if (e->nome[0] && !time_reached(e->ate) && strcmp(e->nome, nome) == 0) return true;
+    }
+    return false;
+}
+
+/*
+ * dns_negativo_registra: Guarda a falha de 'nome', reaproveitando a entrada do mesmo nome,
+ * uma vencida ou, na falta delas, a que vence primeiro.
+ */
+static void dns_negativo_registra(const char *nome) {
+    dns_negativo_t *alvo = &dns_negativos[0];
+    for (int i = 0; i < PICO_NET_DNS_NEGATIVO; i++) {
+        dns_negativo_t *e = &dns_negativos[i];
+        if (strcmp(e->nome, nome) == 0 || !e->nome[0] || time_reached(e->ate)) {
+            alvo = e;
+            break;
+        }
+        if (absolute_time_diff_us(e->ate, alvo->ate) > 0) alvo = e;
+    }
+    strncpy(alvo->nome, nome, sizeof(alvo->nome) - 1);
+    alvo->nome[sizeof(alvo->nome) - 1] = '\0';
+    alvo->ate = make_timeout_time_ms(PICO_NET_DNS_NEGATIVO_MS);
+}
 
+/*
+ * net_tcp_start: Cria o PCB e dispara o tcp_connect() para um endereço já resolvido.
+ * Em caso de falha, fecha o contexto e deixa o estado em CONN_FAILED.
+ */
+static bool net_tcp_start(pico_net_context *ctx, const ip_addr_t *target_ip, uint16_t port) {
     ctx->pcb = tcp_new();
-    if (!ctx->pcb) return false;
+    if (!ctx->pcb) {
+        ctx->state = CONN_FAILED;
+        return false;
+    }
 
     tcp_arg(ctx->pcb, ctx);
+    pico_net_set_profile(ctx, ctx->perfil);
     tcp_err(ctx->pcb, net_error_cb);
     tcp_recv(ctx->pcb, net_recv_cb);
 
     ctx->state = CONN_CONNECTING;
-    err_t err = tcp_connect(ctx->pcb, &target_ip, port, net_connected_cb);
+    err_t err = tcp_connect(ctx->pcb, target_ip, port, net_connected_cb);
     if (err != ERR_OK) {
-        ctx->state = CONN_FAILED;
         pico_net_close(ctx);
+        ctx->state = CONN_FAILED;
         return false;
     }
     return true;
 }
 
+/*
+ * pico_net_connect: Inicia uma conexão TCP com o host (IPv4 ou nome) e a porta.
+ * Um IPv4 conecta direto. Um nome vai ao DNS do lwIP: se a tabela dele tem uma resposta
+ * dentro do TTL, conecta na hora; senão o estado fica em CONN_RESOLVING e net_dns_cb
+ * continua a conexão quando a resposta chegar. Nunca bloqueia. Retorna false se a
+ * conexão não pôde ser iniciada (inclusive nome em cache negativo).
+ */
+bool pico_net_connect(pico_net_context *ctx, const char *host, uint16_t port) {
+    ip_addr_t target_ip;
+
+    if (ip4addr_aton(host, ip_2_ip4(&target_ip))) {
+        return net_tcp_start(ctx, &target_ip, port);
+    }
+
+    if (dns_negativo_vigente(host)) {
+        LOG_AVISO("[PICO_NET] %s falhou no DNS há pouco; não consulta de novo.", host);
+        ctx->state = CONN_FAILED;
+        return false;
+    }
+
+    dns_pendente_t *req = NULL;
+    for (int i = 0; i < PICO_NET_DNS_PENDENTES; i++) {
+        if (!dns_pendentes[i].em_uso) {
+            req = &dns_pendentes[i];
+            break;
+        }
+    }
+    if (!req) {
+        ctx->state = CONN_FAILED;
+        return false;
+    }
+
+    err_t err = dns_gethostbyname(host, &target_ip, net_dns_cb, req);
+    if (err == ERR_OK) {
+        return net_tcp_start(ctx, &target_ip, port);   // Resposta ainda dentro do TTL
+    }
+    if (err != ERR_INPROGRESS) {
+        LOG_ERRO("[PICO_NET] Falha ao consultar o DNS para %s: %d", host, err);
+        ctx->state = CONN_FAILED;
+        return false;
+    }
+
+    LOG_INFO("[PICO_NET] Resolvendo %s...", host);
+    req->em_uso = true;
+    req->ctx = ctx;
+    ctx->dns_req = req;
+    ctx->port = port;
+    ctx->state = CONN_RESOLVING;
+    return true;
+}
+
+/*
+ * pico_net_set_profile: Guarda o perfil e, se houver PCB, liga ou desliga o Nagle nele.
+ * No perfil de vazão o tcp_output() de cada escrita só transmite segmentos pequenos
+ * quando não há dados sem ACK; até lá eles se juntam aos próximos no mesmo segmento.
+ */
+void pico_net_set_profile(pico_net_context *ctx, pico_net_perfil_t perfil) {
+    ctx->perfil = perfil;
+    if (!ctx->pcb) return;
+    if (perfil == PICO_NET_LATENCIA) {
+        tcp_nagle_disable(ctx->pcb);
+    } else {
+        tcp_nagle_enable(ctx->pcb);
+    }
+}
+
 /*
  * pico_net_send: Envia dados através da conexão TCP estabelecida.
  * Verifica se o estado é conectado, usa tcp_write para enfileirar os dados com cópia,
  * e tcp_output para transmitir. Retorna o número de bytes enviados ou erros mapeados para mbedTLS. [web:5]
  */
-int pico_net_send(void *v_ctx, const unsigned char *buf, size_t len) {
+int RAM_QUENTE(pico_net_send)(void *v_ctx, const unsigned char *buf, size_t len) {
     pico_net_context *ctx = (pico_net_context *)v_ctx;
 
     if (ctx->state != CONN_CONNECTED) return MBEDTLS_ERR_NET_CONN_RESET;
@@ -86,7 +215,7 @@ int pico_net_send(void *v_ctx, const unsigned char *buf, size_t len) {
  * Se não há dados, retorna erro de leitura pendente ou reset. Copia do pbuf atual,
  * gerencia o offset e libera pbufs consumidos. Retorna o número de bytes copiados. [web:5][web:12]
  */
-int pico_net_recv(void *v_ctx, unsigned char *buf, size_t len) {
+int RAM_QUENTE(pico_net_recv)(void *v_ctx, unsigned char *buf, size_t len) {
     pico_net_context *net_ctx = (pico_net_context *)v_ctx;
 
     if (net_ctx->rx_buf == NULL) {
@@ -120,11 +249,11 @@ int pico_net_recv(void *v_ctx, unsigned char *buf, size_t len) {
  * Se p é NULL, indica fechamento remoto e atualiza estado para fechando.
  * Caso contrário, concatena o pbuf recebido ao buffer de recepção usando pbuf_cat. [web:5][web:12]
  */
-static err_t net_recv_cb(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+static err_t RAM_QUENTE(net_recv_cb)(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
     pico_net_context *ctx = (pico_net_context *)arg;
 
     if (p == NULL) {
-        printf("[PICO_NET] Conexão fechada pelo broker.\n");
+        LOG_INFO("[PICO_NET] Conexão fechada pelo broker.");
         ctx->state = CONN_CLOSING;
         return ERR_OK;
     }
@@ -143,6 +272,10 @@ static err_t net_recv_cb(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t
  * e reseta o estado e offset para ocioso. [web:5][web:12]
  */
 void pico_net_close(pico_net_context *ctx) {
+    if (ctx->dns_req) {
+        ((dns_pendente_t *)ctx->dns_req)->ctx = NULL;    // A resposta, se vier, é descartada
+        ctx->dns_req = NULL;
+    }
     if (ctx->pcb) {
         tcp_arg(ctx->pcb, NULL);
         tcp_err(ctx->pcb, NULL);
@@ -162,12 +295,12 @@ void pico_net_close(pico_net_context *ctx) {
 /*
  * net_connected_cb: Callback para o resultado da conexão TCP (de tcp_connect).
  * Se err é OK, estabelece o estado conectado e remove callback de envio.
- * Caso contrário, define estado como falhado. Notifica via printf em sucesso. [web:5]
+ * Caso contrário, define estado como falhado. Registra no log binário em sucesso. [web:5]
  */
 static err_t net_connected_cb(void *arg, struct tcp_pcb *tpcb, err_t err) {
     pico_net_context *ctx = (pico_net_context *)arg;
     if (err == ERR_OK) {
-        printf("[PICO_NET] Conexão TCP estabelecida!\n");
+        LOG_INFO("[PICO_NET] Conexão TCP estabelecida!");
         ctx->state = CONN_CONNECTED;
         tcp_sent(tpcb, NULL);
     } else {
@@ -178,10 +311,39 @@ static err_t net_connected_cb(void *arg, struct tcp_pcb *tpcb, err_t err) {
 
 /*
  * net_error_cb: Callback para erros na conexão TCP.
- * Atualiza o estado para falhado e imprime o código de erro. [web:5]
+ * Atualiza o estado para falhado e imprime o código de erro. Quando o lwIP chama o tcp_err,
+ * o PCB já foi liberado: o ponteiro é esquecido para pico_net_close não tocar nele. O rx_buf
+ * continua do contexto e sai no close. [web:5]
  */
 static void net_error_cb(void *arg, err_t err) {
     pico_net_context *ctx = (pico_net_context *)arg;
+    ctx->pcb = NULL;
     ctx->state = CONN_FAILED;
-    printf("[PICO_NET] Erro de rede: %d\n", err);
+    LOG_ERRO("[PICO_NET] Erro de rede: %d", err);
+}
+
+/*
+ * net_dns_cb: Recebe o resultado do DNS. Falhas entram no cache negativo; se o contexto
+ * que pediu o nome ainda está esperando, inicia a conexão TCP ou marca a falha.
+ */
+static void net_dns_cb(const char *name, const ip_addr_t *ipaddr, void *arg) {
+    dns_pendente_t *req = (dns_pendente_t *)arg;
+    pico_net_context *ctx = req->ctx;
+
+    req->em_uso = false;
+    req->ctx = NULL;
+    if (ipaddr == NULL) {
+        LOG_AVISO("[PICO_NET] DNS não resolveu %s.", name);
+        dns_negativo_registra(name);
+    } else {
+        LOG_INFO("[PICO_NET] %s -> %s", name, ipaddr_ntoa(ipaddr));
+    }
+
+    if (ctx == NULL || ctx->state != CONN_RESOLVING) return;
+    ctx->dns_req = NULL;
+    if (ipaddr == NULL) {
+        ctx->state = CONN_FAILED;
+        return;
+    }
+    net_tcp_start(ctx, ipaddr, ctx->port);
 }
@@ -0,0 +1,226 @@
+#include "power.h"
+#include "shared_vars.h"
+#include "device_state.h"
+#include "botoes.h"
+#include "sensors.h"
+#include "temperature.h"
+
+#include <stdio.h>
+
+#include "pico/cyw43_arch.h"
+#include "hardware/gpio.h"
+
+// --- Parâmetros do modo cíclico ---
+#define POWER_LOTE_MS           50000   // Intervalo entre rajadas (abaixo do keep-alive MQTT de 60 s)
+#define POWER_RAJADA_MS         500     // Rádio em desempenho após a rajada (ACKs TCP/TLS)
+#define POWER_SONO_MAX_MS       1000    // Sono máximo: Wi-Fi, NTP e reconexão são atendidos ao acordar
+#define POWER_DISPLAY_LIGADO_MS 10000   // Display aceso após um botão
+#define POWER_RELATORIO_MS      60000   // Intervalo do relatório de energia (nos dois modos)
+
+// --- Modelo de consumo (µA, em 3,3 V) ---
+// A placa não tem sensor de corrente: o firmware mede o tempo em cada estado e aplica
+// estas correntes. Valores típicos; calibre-os com um medidor USB em cada estado.
+#define POWER_TENSAO_MV             3300
+#define POWER_CPU_ATIVA_UA          22000   // RP2040 a 125 MHz executando
+#define POWER_CPU_SONO_UA           9000    // RP2040 em WFE, clocks ligados
+#define POWER_RADIO_DESEMPENHO_UA   35000   // CYW43439 associado, sem economia
+#define POWER_RADIO_ECONOMIA_UA     3000    // CYW43439 em PM2 (média, acordando nos beacons DTIM)
+#define POWER_DISPLAY_UA            9000    // SSD1306 ligado
+
+static ssd1306_t *display = NULL;
+
+static bool radio_desempenho = true;
+static bool link_anterior = false;
+static bool em_rajada = false;
+static absolute_time_t proximo_lote;
+static absolute_time_t fim_rajada;
+
+static bool display_ligado = true;
+static absolute_time_t display_ate;
+
+// Sinalizado pela interrupção dos botões (fonte de despertar)
+static volatile bool botao_evento = false;
+static async_when_pending_worker_t wake_worker;
+
+// Contabilidade da janela do relatório
+static uint64_t janela_inicio_us;
+static uint64_t marca_us;                   // Último instante contabilizado
+static uint64_t t_sono_us, t_radio_desempenho_us, t_display_us;
+static uint32_t amostras_inicio;
+static absolute_time_t proximo_relatorio;
+
+static bool power_ciclico(void) {
+    return POWER_MODO == POWER_MODO_CICLICO;
+}
+
+/**
+ * @brief Atribui o tempo desde a última marca ao rádio e ao display, conforme o estado atual.
+ */
+static void power_account(void) {
+    uint64_t agora = time_us_64();
+    uint64_t dt = agora - marca_us;
+    if (radio_desempenho) t_radio_desempenho_us += dt;
+    if (display_ligado) t_display_us += dt;
+    marca_us = agora;
+}
+
+/**
+ * @brief Troca o modo de economia do CYW43 (desempenho nas rajadas e conexões, PM2 no resto).
+ */
+static void power_set_radio(bool desempenho) {
+    power_account();
+    if (cyw43_wifi_pm(&cyw43_state, desempenho ? CYW43_PERFORMANCE_PM : CYW43_AGGRESSIVE_PM) != 0) {
+        printf("[POWER] Falha ao ajustar o modo de economia do rádio.\n");
+    }
+    radio_desempenho = desempenho;
+}
+
+static void power_set_display(bool ligado) {
+    if (display == NULL || ligado == display_ligado) return;
+    power_account();
+    if (ligado) ssd1306_poweron(display);
+    else ssd1306_poweroff(display);
+    display_ligado = ligado;
+}
+
+static void power_gpio_cb(uint gpio, uint32_t events) {
+    (void)gpio; (void)events;
+    botao_evento = true;
+    // Libera o cyw43_arch_wait_for_work_until() em power_wait()
+    async_context_set_work_pending(cyw43_arch_async_context(), &wake_worker);
+}
+
+static void power_wake_work(async_context_t *context, async_when_pending_worker_t *worker) {
+    (void)context; (void)worker;            // Basta acordar: o loop principal trata os botões
+}
+
+void power_init(ssd1306_t *disp) {
+    uint64_t agora = time_us_64();
+
+    display = disp;
+    janela_inicio_us = marca_us = agora;
+    amostras_inicio = sensors_samples_published();
+    proximo_relatorio = make_timeout_time_ms(POWER_RELATORIO_MS);
+
+    if (!power_ciclico()) {
+        printf("[POWER] Modo contínuo.\n");
+        return;
+    }
+
+    // Botões acordam a CPU nas duas bordas
+    wake_worker.do_work = power_wake_work;
+    async_context_add_when_pending_worker(cyw43_arch_async_context(), &wake_worker);
+    gpio_set_irq_enabled_with_callback(BUTTON_A_PIN, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, power_gpio_cb);
+    gpio_set_irq_enabled(BUTTON_B_PIN, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+
+    temperature_set_gating(true);
+    power_set_radio(false);
+    proximo_lote = make_timeout_time_ms(POWER_LOTE_MS);
+    display_ate = make_timeout_time_ms(POWER_DISPLAY_LIGADO_MS);
+
+    printf("[POWER] Modo cíclico: rajada a cada %u ms, display desliga após %u ms.\n",
+           POWER_LOTE_MS, POWER_DISPLAY_LIGADO_MS);
+}
+
+/**
+ * @brief Imprime o consumo estimado da janela e a energia por amostra publicada.
+ */
+static void power_report(void) {
+    power_account();
+
+    uint64_t total_us = marca_us - janela_inicio_us;
+    if (total_us == 0) return;
+    uint64_t ativo_us = total_us > t_sono_us ? total_us - t_sono_us : 0;
+    uint64_t radio_economia_us = total_us - t_radio_desempenho_us;
+
+    // µA × µs = pC; × mV = fJ
+    double carga_pc = (double)POWER_CPU_ATIVA_UA * ativo_us + (double)POWER_CPU_SONO_UA * t_sono_us +
+                      (double)POWER_RADIO_DESEMPENHO_UA * t_radio_desempenho_us +
+                      (double)POWER_RADIO_ECONOMIA_UA * radio_economia_us +
+                      (double)POWER_DISPLAY_UA * t_display_us;
+    double energia_mj = carga_pc * POWER_TENSAO_MV / 1e12;
+    uint32_t amostras = sensors_samples_published() - amostras_inicio;
+
+    printf("[POWER] %llu s: %lu amostras, ", (unsigned long long)(total_us / 1000000), (unsigned long)amostras);
+    if (amostras) printf("%.2f mJ/amostra", energia_mj / amostras);
+    else printf("%.2f mJ", energia_mj);
+    printf(" | CPU ativa %.1f%%, rádio em desempenho %.1f%%, display %.1f%% | média %.1f mA\n",
+           100.0 * ativo_us / total_us, 100.0 * t_radio_desempenho_us / total_us,
+           100.0 * t_display_us / total_us, carga_pc / total_us / 1000.0);
+
+    janela_inicio_us = marca_us;
+    t_sono_us = t_radio_desempenho_us = t_display_us = 0;
+    amostras_inicio += amostras;
+}
+
+void power_poll(void) {
+    if (time_reached(proximo_relatorio)) {
+        power_report();
+        proximo_relatorio = make_timeout_time_ms(POWER_RELATORIO_MS);
+    }
+    if (!power_ciclico()) return;
+
+    // Display: acende com qualquer botão e apaga depois de um tempo sem uso
+    if (botao_evento) {
+        botao_evento = false;
+        display_ate = make_timeout_time_ms(POWER_DISPLAY_LIGADO_MS);
+        power_set_display(true);
+    } else if (display_ligado && time_reached(display_ate)) {
+        power_set_display(false);
+    }
+
+    device_state_t st;
+    device_state_snapshot(&st);
+
+    // Rajada: abre o rádio, publica tudo o que acumulou e volta ao PM2
+    if (!em_rajada && time_reached(proximo_lote)) {
+        proximo_lote = make_timeout_time_ms(POWER_LOTE_MS);
+        if (st.mqtt_conectado) {
+            em_rajada = true;
+            fim_rajada = make_timeout_time_ms(POWER_RAJADA_MS);
+            sensors_request_publish();
+        }
+    } else if (em_rajada && time_reached(fim_rajada)) {
+        em_rajada = false;
+    }
+
+    // O modo do rádio vale por associação: reaplica quando o link volta. Durante a
+    // conexão ao broker também usa desempenho, senão o handshake TLS espera os beacons.
+    bool desempenho = em_rajada || (st.wifi_conectado && !st.mqtt_conectado);
+    if (st.wifi_conectado && (!link_anterior || desempenho != radio_desempenho)) {
+        power_set_radio(desempenho);
+    }
+    link_anterior = st.wifi_conectado;
+}
+
+bool power_can_publish(void) {
+    return !power_ciclico() || em_rajada;
+}
+
+bool power_display_on(void) {
+    return display_ligado;
+}
+
+void power_wait(absolute_time_t deadline) {
+    uint64_t t0 = time_us_64();
+
+    if (!power_ciclico()) {
+        cyw43_arch_poll();
+        sleep_ms(1); // Um pequeno delay para evitar 100% de uso da CPU
+        t_sono_us += time_us_64() - t0;
+        return;
+    }
+
+    // Prazo efetivo: o pedido, limitado pelo sono máximo e pelos prazos deste módulo
+    absolute_time_t limite = make_timeout_time_ms(em_rajada ? 1 : POWER_SONO_MAX_MS);
+    if (absolute_time_diff_us(deadline, limite) > 0) limite = deadline;
+    if (!em_rajada && absolute_time_diff_us(proximo_lote, limite) > 0) limite = proximo_lote;
+    if (display_ligado && absolute_time_diff_us(display_ate, limite) > 0) limite = display_ate;
+
+    // WFE até o prazo, até o cyw43 sinalizar trabalho ou até a interrupção de um botão
+    if (!botao_evento) {
+        cyw43_arch_wait_for_work_until(limite);
+    }
+    t_sono_us += time_us_64() - t0;
+    cyw43_arch_poll();
+}
@@ -0,0 +1,250 @@
+#include "pub_queue.h"
+#include "mqtt.h"
+#include "time_sync.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+// --- Profundidade e política de cada classe ---
+#define PUB_PROF_EVENTO         8
+#define PUB_PROF_TELEMETRIA     4
+#define PUB_PROF_DIAG           2
+#define PUB_MAX_POR_CICLO       4       // Publicações por chamada, para não segurar o loop
+#define PUB_RELATORIO_MS        60000   // Intervalo do relatório de latência
+#ifndef PUB_ESPERA_RELOGIO_MS
+#define PUB_ESPERA_RELOGIO_MS   3000    // Espera máxima pelo SNTP, após conectar, dos eventos montados no envio
+#endif
+
+typedef struct {
+    const mqtt_topic_t *topic;
+    uint64_t t_enq_us;
+    pub_monta_t monta;              // Não NULL: payload montado no envio, de dado e t_us
+    uint32_t dado;
+    uint64_t t_us;
+    uint16_t len;
+    uint8_t payload[MQTT_TOPIC_MAX_PAYLOAD];
+} pub_entry_t;
+
+typedef struct {
+    const char *nome;
+    uint8_t base;                   // Primeira posição da classe no pool
+    uint8_t profundidade;
+    pub_politica_t politica;
+} pub_classe_config_t;
+
+static const pub_classe_config_t classes[PUB_CLASSES] = {
+    [PUB_CLASSE_EVENTO]     = { "evento",     0, PUB_PROF_EVENTO, PUB_DESCARTA_ANTIGA },
+    [PUB_CLASSE_TELEMETRIA] = { "telemetria", PUB_PROF_EVENTO, PUB_PROF_TELEMETRIA, PUB_DESCARTA_NOVA },
+    [PUB_CLASSE_DIAG]       = { "diag",       PUB_PROF_EVENTO + PUB_PROF_TELEMETRIA, PUB_PROF_DIAG, PUB_SUBSTITUI_TOPICO },
+};
+
+static pub_entry_t pool[PUB_PROF_EVENTO + PUB_PROF_TELEMETRIA + PUB_PROF_DIAG];
+
+// Buffer circular de cada classe sobre o pool
+static uint8_t head[PUB_CLASSES];   // Mais antiga
+static uint8_t count[PUB_CLASSES];
+static pub_queue_stats_t stats[PUB_CLASSES];
+
+static absolute_time_t proximo_relatorio;
+static bool relatorio_agendado = false;
+
+static bool conectado = false;
+static absolute_time_t fim_espera_relogio;  // Até quando os eventos esperam pelo SNTP
+
+static pub_entry_t *pub_entry(pub_classe_t classe, uint8_t i) {
+    const pub_classe_config_t *cfg = &classes[classe];
+    return &pool[cfg->base + (head[classe] + i) % cfg->profundidade];
+}
+
+/**
+ * @brief Posição da nova mensagem da classe, conforme a política: a do mesmo tópico
+ * (PUB_SUBSTITUI_TOPICO) ou o fim da fila. NULL se a mensagem foi recusada.
+ */
+static pub_entry_t *pub_reserve(pub_classe_t classe, const mqtt_topic_t *topic) {
+    const pub_classe_config_t *cfg = &classes[classe];
+    pub_queue_stats_t *st = &stats[classe];
+
+    if (cfg->politica == PUB_SUBSTITUI_TOPICO) {
+        for (uint8_t i = 0; i < count[classe]; i++) {
+            pub_entry_t *e = pub_entry(classe, i);
+            if (e->topic == topic) {
+                // A versão antiga nunca vai sair: conta como descartada
+                st->enfileiradas++;
+                st->descartadas++;
+                return e;
+            }
+        }
+    }
+
+    if (count[classe] == cfg->profundidade) {
+        st->descartadas++;
+        if (cfg->politica != PUB_DESCARTA_ANTIGA) {
+            return NULL;
+        }
+        printf("[FILA] Classe %s cheia, descartando a mensagem mais antiga.\n", cfg->nome);
+        head[classe] = (head[classe] + 1) % cfg->profundidade;
+        count[classe]--;
+    }
+
+    pub_entry_t *e = pub_entry(classe, count[classe]);
+    count[classe]++;
+    st->enfileiradas++;
+    if (count[classe] > st->profundidade_max) st->profundidade_max = count[classe];
+    return e;
+}
+
+bool pub_queue_push(pub_classe_t classe, const mqtt_topic_t *topic, const uint8_t *payload, size_t len) {
+    if (len == 0 || len > MQTT_TOPIC_MAX_PAYLOAD) {
+        stats[classe].descartadas++;
+        return false;
+    }
+
+    pub_entry_t *e = pub_reserve(classe, topic);
+    if (e == NULL) return false;
+    e->topic = topic;
+    e->t_enq_us = time_us_64();
+    e->monta = NULL;
+    e->len = (uint16_t)len;
+    memcpy(e->payload, payload, len);
+    return true;
+}
+
+bool pub_queue_push_evento(pub_classe_t classe, const mqtt_topic_t *topic, pub_monta_t monta,
+                           uint32_t dado, uint64_t t_us) {
+    pub_entry_t *e = pub_reserve(classe, topic);
+    if (e == NULL) return false;
+    e->topic = topic;
+    e->t_enq_us = time_us_64();
+    e->monta = monta;
+    e->dado = dado;
+    e->t_us = t_us;
+    e->len = 0;
+    return true;
+}
+
+/**
+ * @brief true se a mensagem precisa do horário UTC e ainda vale esperar pelo SNTP.
+ */
+static bool pub_waits_clock(const pub_entry_t *e) {
+    return e->monta && !time_sync_valid() && (!conectado || !time_reached(fim_espera_relogio));
+}
+
+/**
+ * @brief Registra a espera de uma mensagem publicada nas estatísticas da classe.
+ */
+static void pub_record_latency(pub_queue_stats_t *st, uint64_t espera_us) {
+    uint32_t ms = (uint32_t)(espera_us / 1000);
+    int faixa = 0;
+    while (faixa < PUB_QUEUE_FAIXAS - 1 && ms >= (1u << faixa)) faixa++;
+
+    st->enviadas++;
+    st->latencia_soma_us += espera_us;
+    if (espera_us > st->latencia_max_us) st->latencia_max_us = (uint32_t)espera_us;
+    st->faixas[faixa]++;
+}
+
+/**
+ * @brief Limite superior (ms) da faixa que contém o percentil p das latências.
+ */
+static uint32_t pub_percentil_ms(const pub_queue_stats_t *st, uint32_t p) {
+    uint32_t alvo = (st->enviadas * p + 99) / 100;
+    uint32_t acumulado = 0;
+    for (int i = 0; i < PUB_QUEUE_FAIXAS; i++) {
+        acumulado += st->faixas[i];
+        if (acumulado >= alvo) return 1u << i;
+    }
+    return 1u << (PUB_QUEUE_FAIXAS - 1);
+}
+
+static void pub_queue_report(void) {
+    for (int c = 0; c < PUB_CLASSES; c++) {
+        const pub_queue_stats_t *st = &stats[c];
+        if (st->enfileiradas == 0) continue;
+        printf("[FILA] %s: %lu enviadas, %lu descartadas, prof. máx %u | espera média %.1f ms, "
+               "p50 < %lu ms, p99 < %lu ms, máx %.1f ms\n",
+               classes[c].nome, (unsigned long)st->enviadas, (unsigned long)st->descartadas,
+               st->profundidade_max,
+               st->enviadas ? (double)st->latencia_soma_us / st->enviadas / 1000.0 : 0.0,
+               (unsigned long)pub_percentil_ms(st, 50), (unsigned long)pub_percentil_ms(st, 99),
+               st->latencia_max_us / 1000.0);
+    }
+}
+
+int pub_queue_service(bool connected, bool bulk) {
+    int enviadas = 0;
+
+    if (!relatorio_agendado) {
+        proximo_relatorio = make_timeout_time_ms(PUB_RELATORIO_MS);
+        relatorio_agendado = true;
+    } else if (time_reached(proximo_relatorio)) {
+        pub_queue_report();
+        proximo_relatorio = make_timeout_time_ms(PUB_RELATORIO_MS);
+    }
+
+    if (!connected) {
+        conectado = false;
+        return 0;
+    }
+    if (!conectado) {
+        conectado = true;
+        fim_espera_relogio = make_timeout_time_ms(PUB_ESPERA_RELOGIO_MS);
+    }
+
+    // As mensagens desta chamada saem juntas num único registro TLS (cork) e só deixam
+    // a fila depois que o registro foi escrito
+    uint8_t lote[PUB_CLASSES] = { 0 };
+    bool ok = true;
+    mqtt_cork();
+
+    // Sempre a classe mais prioritária com mensagens: um evento que chega entre duas
+    // publicações de telemetria sai antes da próxima
+    while (enviadas < PUB_MAX_POR_CICLO) {
+        int c = 0;
+        while (c < PUB_CLASSES && (count[c] == lote[c] || pub_waits_clock(pub_entry((pub_classe_t)c, lote[c])))) c++;
+        if (c == PUB_CLASSES || (c != PUB_CLASSE_EVENTO && !bulk)) break;
+
+        // Eventos montados agora: o horário da captura sai em UTC mesmo que ela tenha
+        // sido antes da primeira sincronização
+        pub_entry_t *e = pub_entry((pub_classe_t)c, lote[c]);
+        if (e->monta) e->len = (uint16_t)e->monta(e->topic, e->dado, e->t_us, e->payload, sizeof(e->payload));
+        if (e->len == 0) {
+            lote[c]++;                  // Não coube: sai da fila como descartada
+            continue;
+        }
+        if (!mqtt_publish_topic(e->topic, e->payload, e->len)) {
+            ok = false;
+            break;
+        }
+        lote[c]++;
+        enviadas++;
+    }
+
+    // Falha: o lote inteiro fica na frente da fila até a reconexão (parte dele pode já
+    // ter saído num envio forçado; em QoS 0 isso vira, no pior caso, uma duplicata)
+    if (!mqtt_uncork() || !ok) {
+        return -1;
+    }
+
+    uint64_t agora = time_us_64();
+    for (int c = 0; c < PUB_CLASSES; c++) {
+        for (; lote[c]; lote[c]--) {
+            const pub_entry_t *e = pub_entry((pub_classe_t)c, 0);
+            if (e->len) pub_record_latency(&stats[c], agora - e->t_enq_us);
+            else stats[c].descartadas++;
+            head[c] = (head[c] + 1) % classes[c].profundidade;
+            count[c]--;
+        }
+    }
+    return enviadas;
+}
+
+bool pub_queue_ready(bool bulk) {
+    if (count[PUB_CLASSE_EVENTO] && !pub_waits_clock(pub_entry(PUB_CLASSE_EVENTO, 0))) return true;
+    return bulk && (count[PUB_CLASSE_TELEMETRIA] || count[PUB_CLASSE_DIAG]);
+}
+
+void pub_queue_stats(pub_classe_t classe, pub_queue_stats_t *out) {
+    *out = stats[classe];
+}
@@ -0,0 +1,69 @@
+#include "reconnect.h"
+
+#include <stddef.h>
+
+/*
+ * Política de reconexão: backoff exponencial limitado com "equal jitter"
+ * (metade fixa + metade aleatória), orçamentos separados por classe de falha.
+ *
+ * O jitter evita que uma frota inteira, derrubada ao mesmo tempo por um restart
+ * do broker, volte em sincronia e sobrecarregue o handshake TLS-PSK do servidor.
+ * Este módulo não depende do SDK do Pico, para rodar também na simulação de host.
+ */
+
+const reconnect_policy_t reconnect_default_policies[RECONNECT_NUM_CLASSES] = {
+    [RECONNECT_WIFI] = { .base_ms = 2000, .max_ms =  60000, .budget = 10, .cooldown_ms = 120000 },
+    [RECONNECT_TCP]  = { .base_ms = 1000, .max_ms =  60000, .budget =  8, .cooldown_ms = 120000 },
+    // Falhas de TLS indicam broker sobrecarregado: recua mais devagar e por mais tempo
+    [RECONNECT_TLS]  = { .base_ms = 5000, .max_ms = 300000, .budget =  5, .cooldown_ms = 600000 },
+};
+
+void reconnect_init(reconnect_t *r, const reconnect_policy_t *policies, reconnect_rand_fn rand, void *rand_ctx) {
+    r->policies = policies ? policies : reconnect_default_policies;
+    for (int i = 0; i < RECONNECT_NUM_CLASSES; i++) {
+        r->failures[i] = 0;
+    }
+    r->rand = rand;
+    r->rand_ctx = rand_ctx;
+}
+
+// Valor uniforme em [0, limit)
+static uint32_t reconnect_random_below(reconnect_t *r, uint32_t limit) {
+    if (limit == 0 || r->rand == NULL) return 0;
+    return r->rand(r->rand_ctx) % limit;
+}
+
+// Metade fixa garante um intervalo mínimo; a outra metade dessincroniza os dispositivos
+static uint32_t reconnect_equal_jitter(reconnect_t *r, uint32_t nominal_ms) {
+    uint32_t half = nominal_ms / 2;
+    return half + reconnect_random_below(r, nominal_ms - half + 1);
+}
+
+uint32_t reconnect_on_failure(reconnect_t *r, reconnect_class_t cls) {
+    const reconnect_policy_t *p = &r->policies[cls];
+    uint8_t n = r->failures[cls];
+
+    if (n >= p->budget) {
+        // Orçamento esgotado: pausa longa e recomeça a escada do backoff
+        r->failures[cls] = 0;
+        return reconnect_equal_jitter(r, p->cooldown_ms);
+    }
+    r->failures[cls] = n + 1;
+
+    // base * 2^n, saturando no teto sem estourar 32 bits
+    uint32_t nominal = p->base_ms;
+    for (uint8_t i = 0; i < n && nominal < p->max_ms; i++) {
+        nominal <<= 1;
+    }
+    if (nominal > p->max_ms) nominal = p->max_ms;
+
+    return reconnect_equal_jitter(r, nominal);
+}
+
+void reconnect_reset(reconnect_t *r, reconnect_class_t cls) {
+    r->failures[cls] = 0;
+}
+
+uint32_t reconnect_on_drop(reconnect_t *r) {
+    return reconnect_random_below(r, RECONNECT_DROP_SPREAD_MS);
+}
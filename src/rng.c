@@ -0,0 +1,46 @@
+#include "rng.h"
+
+#include <stdio.h>
+
+#include "pico/rand.h"
+#include "mbedtls/entropy.h"
+
+static mbedtls_ctr_drbg_context ctr_drbg;
+static mbedtls_entropy_context entropy;
+static bool seeded = false;
+
+/*
+ * rng_init: inicializa a entropia e semeia o DRBG uma única vez.
+ * Antes era feito a cada tentativa de conexão; agora sai do caminho crítico
+ * e pode rodar enquanto o Wi-Fi associa.
+ */
+bool rng_init(void) {
+    if (seeded) return true;
+
+    mbedtls_ctr_drbg_init(&ctr_drbg);
+    mbedtls_entropy_init(&entropy);
+
+    int ret = mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy, NULL, 0);
+    if (ret != 0) {
+        printf("[RNG] Falha em mbedtls_ctr_drbg_seed: -0x%x\n", -ret);
+        mbedtls_ctr_drbg_free(&ctr_drbg);
+        mbedtls_entropy_free(&entropy);
+        return false;
+    }
+    seeded = true;
+    return true;
+}
+
+mbedtls_ctr_drbg_context *rng_drbg(void) {
+    return &ctr_drbg;
+}
+
+uint32_t rng_u32(void *ctx) {
+    (void)ctx;
+    uint32_t v;
+    // Sem DRBG semeado, recorre direto ao gerador de hardware do SDK
+    if (!seeded || mbedtls_ctr_drbg_random(&ctr_drbg, (unsigned char *)&v, sizeof(v)) != 0) {
+        return get_rand_32();
+    }
+    return v;
+}
@@ -0,0 +1,208 @@
+#include "sensors.h"
+#include "payload.h"
+#include "pub_queue.h"
+#include "time_sync.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    sensor_config_t cfg;
+    uint64_t next_sample_us;
+    uint64_t next_publish_us;       // 0 = sem publicação por tempo
+    sensor_sample_t ring[SENSOR_RING_SIZE];
+    uint8_t head;                   // Próxima posição de escrita
+    uint8_t count;                  // Amostras válidas no buffer
+    uint8_t pending;                // Amostras mais recentes ainda não publicadas
+    bool publish_due;
+    bool has_published;
+    float last_published;
+} sensor_channel_t;
+
+static sensor_channel_t channels[SENSORS_MAX_CHANNELS];
+static int channel_count = 0;
+
+// Menor prazo entre todos os canais: antes dele, sensors_poll() retorna sem percorrer nada
+static uint64_t next_deadline_us = 0;
+// Há publicações vencidas esperando conexão
+static bool backlog = false;
+static uint32_t samples_published = 0;
+
+static void sensors_update_deadline(void);
+static bool sensors_publish(sensor_channel_t *ch);
+
+int sensors_register(const sensor_config_t *cfg) {
+    if (channel_count >= SENSORS_MAX_CHANNELS || cfg->read == NULL || cfg->period_ms == 0) {
+        printf("[SENSORS] Não foi possível registrar o canal '%s'.\n", cfg->nome);
+        return -1;
+    }
+
+    sensor_channel_t *ch = &channels[channel_count];
+    memset(ch, 0, sizeof(*ch));
+    ch->cfg = *cfg;
+
+    uint64_t now = time_us_64();
+    ch->next_sample_us = now;       // Primeira leitura na próxima chamada de sensors_poll()
+    if (cfg->policy != SENSOR_PUBLICA_AMOSTRA && cfg->publish_period_ms) {
+        ch->next_publish_us = now + (uint64_t)cfg->publish_period_ms * 1000u;
+    }
+
+    printf("[SENSORS] Canal %d '%s': amostra a cada %lu ms.\n", channel_count, cfg->nome, (unsigned long)cfg->period_ms);
+    sensors_update_deadline();
+    return channel_count++;
+}
+
+/**
+ * @brief Lê o sensor, guarda a amostra no buffer circular e aplica a política de publicação.
+ */
+static void sensors_sample(sensor_channel_t *ch, uint64_t now) {
+    // Próximo prazo calculado a partir do anterior (sem acumular atraso); se o loop
+    // ficou parado mais de um período, as leituras perdidas não são repetidas
+    uint64_t period_us = (uint64_t)ch->cfg.period_ms * 1000u;
+    ch->next_sample_us += period_us;
+    if (ch->next_sample_us <= now) ch->next_sample_us = now + period_us;
+
+    float valor;
+    if (!ch->cfg.read(ch->cfg.ctx, &valor)) return;
+
+    ch->ring[ch->head].valor = valor;
+    ch->ring[ch->head].t_us = now;
+    ch->head = (ch->head + 1) % SENSOR_RING_SIZE;
+    if (ch->count < SENSOR_RING_SIZE) ch->count++;
+    if (ch->pending < SENSOR_RING_SIZE) ch->pending++;
+
+    switch (ch->cfg.policy) {
+    case SENSOR_PUBLICA_AMOSTRA:
+        ch->publish_due = true;
+        break;
+    case SENSOR_PUBLICA_MUDANCA:
+        if (!ch->has_published || fabsf(valor - ch->last_published) >= ch->cfg.delta) {
+            ch->publish_due = true;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+int sensors_poll(bool can_publish) {
+    uint64_t now = time_us_64();
+    int published = 0;
+
+    // Caminho rápido: nenhum prazo venceu e não há nada esperando a conexão
+    if (now < next_deadline_us && !(backlog && can_publish)) {
+        return 0;
+    }
+
+    backlog = false;
+    for (int i = 0; i < channel_count; i++) {
+        sensor_channel_t *ch = &channels[i];
+
+        if (now >= ch->next_sample_us) {
+            sensors_sample(ch, now);
+        }
+
+        if (ch->next_publish_us && now >= ch->next_publish_us) {
+            if (ch->pending) ch->publish_due = true;
+            ch->next_publish_us += (uint64_t)ch->cfg.publish_period_ms * 1000u;
+            if (ch->next_publish_us <= now) ch->next_publish_us = now + (uint64_t)ch->cfg.publish_period_ms * 1000u;
+        }
+
+        if (!ch->publish_due || !ch->pending) continue;
+        if (!can_publish || published < 0) {
+            backlog = true;
+            continue;
+        }
+        if (sensors_publish(ch)) {
+            published++;
+            if (ch->publish_due) backlog = true;   // Não couberam todas: o resto vai na próxima volta
+        } else {
+            published = -1;         // Fila cheia: os demais canais também esperam
+            backlog = true;
+        }
+    }
+
+    sensors_update_deadline();
+    return published;
+}
+
+/**
+ * @brief Enfileira as amostras pendentes do canal no formato do seu tópico.
+ */
+static bool sensors_publish(sensor_channel_t *ch) {
+    float valores[SENSOR_RING_SIZE];
+    uint64_t t_ms[SENSOR_RING_SIZE];
+    uint8_t payload[MQTT_TOPIC_MAX_PAYLOAD];
+
+    // Pendentes em ordem cronológica, a partir da mais antiga. Se não couberem todas no
+    // payload, as seguintes continuam pendentes e vão na próxima mensagem. O instante de
+    // captura é convertido para UTC só agora, então amostras anteriores à sincronização
+    // também saem com horário.
+    uint8_t n;
+    size_t len = 0;
+    for (n = ch->pending; n > 0; n--) {
+        for (uint8_t k = 0; k < n; k++) {
+            const sensor_sample_t *s = &ch->ring[(ch->head + SENSOR_RING_SIZE - ch->pending + k) % SENSOR_RING_SIZE];
+            valores[k] = s->valor;
+            t_ms[k] = time_sync_utc_ms(s->t_us);
+        }
+        len = payload_valores(ch->cfg.topic, ch->cfg.nome, ch->cfg.chave, valores, t_ms, n,
+                              payload, sizeof(payload));
+        if (len) break;
+    }
+    if (n == 0) {
+        printf("[SENSORS] Payload do canal '%s' não cabe no buffer; amostras descartadas.\n", ch->cfg.nome);
+        ch->pending = 0;
+        ch->publish_due = false;
+        return true;
+    }
+    // Fila de telemetria cheia: as amostras continuam pendentes e vão no próximo lote
+    if (!pub_queue_push(PUB_CLASSE_TELEMETRIA, ch->cfg.topic, payload, len)) {
+        return false;
+    }
+
+    samples_published += n;
+    ch->pending -= n;
+    ch->publish_due = ch->pending != 0;
+    ch->has_published = true;
+    ch->last_published = valores[n - 1];
+    return true;
+}
+
+static void sensors_update_deadline(void) {
+    uint64_t deadline = UINT64_MAX;
+
+    for (int i = 0; i < channel_count; i++) {
+        const sensor_channel_t *ch = &channels[i];
+        if (ch->next_sample_us < deadline) deadline = ch->next_sample_us;
+        if (ch->next_publish_us && ch->next_publish_us < deadline) deadline = ch->next_publish_us;
+    }
+    next_deadline_us = deadline;
+}
+
+absolute_time_t sensors_next_deadline(void) {
+    return from_us_since_boot(next_deadline_us);
+}
+
+void sensors_request_publish(void) {
+    for (int i = 0; i < channel_count; i++) {
+        if (channels[i].count) {
+            // Sem amostra nova, reenvia a última (ex.: logo após conectar)
+            if (!channels[i].pending) channels[i].pending = 1;
+            channels[i].publish_due = true;
+            backlog = true;
+        }
+    }
+}
+
+uint32_t sensors_samples_published(void) {
+    return samples_published;
+}
+
+bool sensors_latest(int canal, sensor_sample_t *out) {
+    if (canal < 0 || canal >= channel_count || channels[canal].count == 0) return false;
+    const sensor_channel_t *ch = &channels[canal];
+    *out = ch->ring[(ch->head + SENSOR_RING_SIZE - 1) % SENSOR_RING_SIZE];
+    return true;
+}
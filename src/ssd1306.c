@@ -31,14 +31,10 @@ SOFTWARE.
 #include <stdio.h>
 
 #include "ssd1306.h"
+#include "xip_cache.h"
+#include "mem_diag.h"
 #include "font.h"
 
-inline static void swap(int32_t *a, int32_t *b) {
-    int32_t *t=a;
-    *a=*b;
-    *b=*t;
-}
-
 inline static void fancy_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, char *name) {
     switch(i2c_write_blocking(i2c, addr, src, len, false)) {
     case PICO_ERROR_GENERIC:
@@ -68,7 +64,7 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
 
 
     p->bufsize=(p->pages)*(p->width);
-    if((p->buffer=malloc(p->bufsize+1))==NULL) {
+    if((p->buffer=mem_diag_malloc(MEM_DISPLAY, p->bufsize+1))==NULL) {
         p->bufsize=0;
         return false;
     }
@@ -116,7 +112,7 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
 }
 
 inline void ssd1306_deinit(ssd1306_t *p) {
-    free(p->buffer-1);
+    mem_diag_free(p->buffer-1);
 }
 
 inline void ssd1306_poweroff(ssd1306_t *p) {
@@ -152,45 +148,130 @@ void ssd1306_draw_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {
     p->buffer[x+p->width*(y>>3)]|=0x1<<(y&0x07); // y>>3==y/8 && y&0x7==y%8
 }
 
-void ssd1306_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
-    if(x1>x2) {
-        swap(&x1, &x2);
-        swap(&y1, &y2);
+/*
+ * Every op is dst=(dst&~(m&keep))^(m&flip), m being the pixels touched in that byte:
+ * SET (keep=FF, flip=FF), CLEAR (FF, 00), XOR (00, FF). No branch on op per pixel.
+ */
+static inline uint8_t ssd1306_op_keep(ssd1306_op_t op) {
+    return op==SSD1306_OP_XOR?0x00:0xFF;
+}
+
+static inline uint8_t ssd1306_op_flip(ssd1306_op_t op) {
+    return op==SSD1306_OP_CLEAR?0x00:0xFF;
+}
+
+/*
+ * Applies op to the bits in mask of n consecutive columns of one page.
+ */
+static void RAM_QUENTE(ssd1306_span)(uint8_t *dst, uint32_t n, uint8_t mask, ssd1306_op_t op) {
+    uint8_t keep=mask&ssd1306_op_keep(op);
+    uint8_t flip=mask&ssd1306_op_flip(op);
+
+    if(keep==0xFF) {    // whole bytes set or cleared
+        memset(dst, flip, n);
+        return;
     }
+    while(n--) {
+        *dst=(uint8_t)((*dst&~keep)^flip);
+        ++dst;
+    }
+}
 
-    if(x1==x2) {
-        if(y1>y2)
-            swap(&y1, &y2);
-        for(int32_t i=y1; i<=y2; ++i)
-            ssd1306_draw_pixel(p, x1, i);
+void RAM_QUENTE(ssd1306_fill_rect)(ssd1306_t *p, int32_t x, int32_t y, uint32_t width, uint32_t height, ssd1306_op_t op) {
+    int64_t xe=(int64_t)x+width, ye=(int64_t)y+height;
+    int32_t x0=x<0?0:x, y0=y<0?0:y;
+    int32_t x1=xe>p->width?p->width:(int32_t)xe;
+    int32_t y1=ye>p->height?p->height:(int32_t)ye;
+    if(x0>=x1 || y0>=y1)
         return;
+
+    int32_t pg0=y0>>3, pg1=(y1-1)>>3;
+    for(int32_t pg=pg0; pg<=pg1; ++pg) {
+        uint8_t mask=0xFF;
+        if(pg==pg0)
+            mask&=(uint8_t)(0xFF<<(y0&7));
+        if(pg==pg1)
+            mask&=(uint8_t)(0xFF>>(7-((y1-1)&7)));
+        ssd1306_span(&p->buffer[pg*p->width+x0], (uint32_t)(x1-x0), mask, op);
     }
+}
 
-    float m=(float) (y2-y1) / (float) (x2-x1);
+void ssd1306_draw_hline(ssd1306_t *p, int32_t x, int32_t y, uint32_t width, ssd1306_op_t op) {
+    ssd1306_fill_rect(p, x, y, width, 1, op);
+}
+
+void ssd1306_draw_vline(ssd1306_t *p, int32_t x, int32_t y, uint32_t height, ssd1306_op_t op) {
+    ssd1306_fill_rect(p, x, y, 1, height, op);
+}
 
-    for(int32_t i=x1; i<=x2; ++i) {
-        float y=m*(float) (i-x1)+(float) y1;
-        ssd1306_draw_pixel(p, i, (uint32_t) y);
+void ssd1306_draw_rect(ssd1306_t *p, int32_t x, int32_t y, uint32_t width, uint32_t height, ssd1306_op_t op) {
+    if(!width || !height)
+        return;
+
+    // each pixel of the outline exactly once, so XOR leaves no holes at the corners
+    ssd1306_draw_hline(p, x, y, width, op);
+    if(height>1)
+        ssd1306_draw_hline(p, x, y+(int32_t)height-1, width, op);
+    if(height>2) {
+        ssd1306_draw_vline(p, x, y+1, height-2, op);
+        if(width>1)
+            ssd1306_draw_vline(p, x+(int32_t)width-1, y+1, height-2, op);
     }
 }
 
+void ssd1306_draw_line_op(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2, ssd1306_op_t op) {
+    if(y1==y2) {
+        ssd1306_draw_hline(p, x1<x2?x1:x2, y1, (uint32_t)abs(x2-x1)+1, op);
+        return;
+    }
+    if(x1==x2) {
+        ssd1306_draw_vline(p, x1, y1<y2?y1:y2, (uint32_t)abs(y2-y1)+1, op);
+        return;
+    }
+    if((x1<0 && x2<0) || (y1<0 && y2<0) || (x1>=p->width && x2>=p->width) || (y1>=p->height && y2>=p->height))
+        return;
+
+    // Bresenham: one pixel per step of the major axis, integer error term only
+    int32_t dx=abs(x2-x1), dy=abs(y2-y1);
+    int32_t sx=x1<x2?1:-1, sy=y1<y2?1:-1;
+    int32_t err=dx-dy;
+    uint8_t keep=ssd1306_op_keep(op), flip=ssd1306_op_flip(op);
+
+    for(;;) {
+        if((uint32_t)x1<p->width && (uint32_t)y1<p->height) {
+            uint8_t *dst=&p->buffer[x1+p->width*(y1>>3)];
+            uint8_t m=(uint8_t)(1u<<(y1&7));
+            *dst=(uint8_t)((*dst&~(m&keep))^(m&flip));
+        }
+        if(x1==x2 && y1==y2)
+            break;
+        int32_t e2=2*err;
+        if(e2>-dy) {
+            err-=dy;
+            x1+=sx;
+        }
+        if(e2<dx) {
+            err+=dx;
+            y1+=sy;
+        }
+    }
+}
+
+void ssd1306_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    ssd1306_draw_line_op(p, x1, y1, x2, y2, SSD1306_OP_SET);
+}
+
 void ssd1306_clear_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    for(uint32_t i=0; i<width; ++i)
-        for(uint32_t j=0; j<height; ++j)
-            ssd1306_clear_pixel(p, x+i, y+j);
+    ssd1306_fill_rect(p, (int32_t)x, (int32_t)y, width, height, SSD1306_OP_CLEAR);
 }
 
 void ssd1306_draw_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    for(uint32_t i=0; i<width; ++i)
-        for(uint32_t j=0; j<height; ++j)
-            ssd1306_draw_pixel(p, x+i, y+j);
+    ssd1306_fill_rect(p, (int32_t)x, (int32_t)y, width, height, SSD1306_OP_SET);
 }
 
 void ssd1306_draw_empty_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    ssd1306_draw_line(p, x, y, x+width, y);
-    ssd1306_draw_line(p, x, y+height, x+width, y+height);
-    ssd1306_draw_line(p, x, y, x, y+height);
-    ssd1306_draw_line(p, x+width, y, x+width, y+height);
+    // lines from x to x+width inclusive, as always
+    ssd1306_draw_rect(p, (int32_t)x, (int32_t)y, width+1, height+1, SSD1306_OP_SET);
 }
 
 void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
@@ -219,6 +300,72 @@ void ssd1306_draw_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_
     }
 }
 
+/*
+ * Copies a page-major block (w x h) to (x, y). Each source byte lands in one or two
+ * display pages, shifted by y&7; opaque replaces the covered bits, otherwise ORs.
+ */
+static void RAM_QUENTE(ssd1306_blit)(ssd1306_t *p, int32_t x, int32_t y, uint32_t w, uint32_t h, const uint8_t *src, bool opaque) {
+    int32_t c0=x<0?-x:0;
+    int32_t c1=(int32_t)w<(int32_t)p->width-x?(int32_t)w:(int32_t)p->width-x;
+    if(c1<=c0)
+        return;
+
+    uint32_t src_pages=(h+7)>>3;
+
+    // aligned and whole pages: straight copies
+    if(opaque && !(y&7) && !(h&7)) {
+        for(uint32_t sp=0; sp<src_pages; ++sp) {
+            int32_t dp=(y>>3)+(int32_t)sp;
+            if(dp<0 || dp>=p->pages)
+                continue;
+            memcpy(&p->buffer[dp*p->width+x+c0], &src[sp*w+c0], (size_t)(c1-c0));
+        }
+        return;
+    }
+
+    for(uint32_t sp=0; sp<src_pages; ++sp) {
+        uint32_t rows=h-sp*8;
+        uint8_t mask=rows>=8?0xFF:(uint8_t)((1u<<rows)-1);
+        int32_t top=y+(int32_t)sp*8;
+        int32_t dp=top>>3;      // arithmetic shift: floor for negative y
+        uint32_t shift=(uint32_t)top&7;
+        const uint8_t *s=&src[sp*w];
+
+        for(int32_t pg=0; pg<2; ++pg) {
+            int32_t d=dp+pg;
+            if(d<0 || d>=p->pages || (pg && !shift))
+                continue;
+            uint8_t *dst=&p->buffer[d*p->width+x];
+            uint8_t m=pg?(uint8_t)(mask>>(8-shift)):(uint8_t)(mask<<shift);
+            for(int32_t c=c0; c<c1; ++c) {
+                uint8_t b=s[c]&mask;
+                b=pg?(uint8_t)(b>>(8-shift)):(uint8_t)(b<<shift);
+                dst[c]=opaque?(uint8_t)((dst[c]&~m)|b):(uint8_t)(dst[c]|b);
+            }
+        }
+    }
+}
+
+void ssd1306_draw_image(ssd1306_t *p, int32_t x, int32_t y, const ssd1306_imagem_t *img) {
+    if(!x && !y && img->width==p->width && img->height==p->height) {
+        memcpy(p->buffer, img->data, p->bufsize);
+        return;
+    }
+    ssd1306_blit(p, x, y, img->width, img->height, img->data, true);
+}
+
+int32_t RAM_QUENTE(ssd1306_draw_text)(ssd1306_t *p, int32_t x, int32_t y, const ssd1306_fonte_t *font, const char *s) {
+    for(; *s; ++s) {
+        uint8_t c=(uint8_t)*s;
+        if(c<font->first || c>font->last || !font->widths[c-font->first])
+            continue;
+        uint32_t i=c-font->first;
+        ssd1306_blit(p, x, y, font->widths[i], font->height, &font->data[font->offsets[i]], false);
+        x+=font->widths[i];
+    }
+    return x;
+}
+
 void ssd1306_draw_char(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, char c) {
     ssd1306_draw_char_with_font(p, x, y, scale, font_8x5, c);
 }
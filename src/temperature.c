@@ -3,8 +3,25 @@
 #include "pico/stdlib.h"
 #include "temperature.h"
 
+// Com gating, o ADC e o sensor interno ficam desligados entre leituras
+static bool gating = false;
+
+void temperature_set_gating(bool enable) {
+    gating = enable;
+    if (gating) {
+        adc_set_temp_sensor_enabled(false);
+        hw_clear_bits(&adc_hw->cs, ADC_CS_EN_BITS);
+    }
+}
+
 // Lê a temperatura interna do RP2040 em graus Celsius
 float read_onboard_temp_celsius(void) {
+    if (gating) {
+        // Religa o ADC e espera ficar pronto
+        hw_set_bits(&adc_hw->cs, ADC_CS_EN_BITS);
+        while (!(adc_hw->cs & ADC_CS_READY_BITS)) tight_loop_contents();
+    }
+
     // Habilita o sensor de temperatura interno
     adc_set_temp_sensor_enabled(true);
 
@@ -20,5 +37,10 @@ float read_onboard_temp_celsius(void) {
     // Converte a tensão em temperatura (fórmula do datasheet)
     float temperature = 27.0f - (voltage - 0.706f) / 0.001721f;
 
+    if (gating) {
+        adc_set_temp_sensor_enabled(false);
+        hw_clear_bits(&adc_hw->cs, ADC_CS_EN_BITS);
+    }
+
     return temperature;
 }
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "time_sync.h"
+#include "shared_vars.h"
+#include "device_state.h"
+#include "binlog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "lwip/ip_addr.h"
+
+// --- Parâmetros do cliente ---
+#define NTP_PACKET_LEN          48
+#define NTP_TIMEOUT_MS          3000        // Espera pela resposta de uma consulta
+#define NTP_RETRY_MS            10000       // Nova consulta após falha/timeout
+#define NTP_POLL_MIN_MS         64000       // Intervalo logo após a primeira sincronização
+#define NTP_POLL_MAX_MS         1024000     // Intervalo máximo (dobra a cada sucesso)
+#define NTP_ATRASO_MAX_US       500000      // Respostas com round-trip maior são descartadas
+#define NTP_DRIFT_MIN_BASE_US   30000000ull // Base mínima entre sincronizações para medir a deriva
+#define NTP_DRIFT_MAX_PPB       500000      // ±500 ppm: além disso é erro de medição
+#define NTP_DEGRAU_US           128000      // Folga para ruído; acima dela (mais a deriva) é degrau
+
+// Segundos entre 1900 (época do NTP) e 1970 (época Unix)
+#define NTP_UNIX_OFFSET_S       2208988800ull
+
+static struct udp_pcb *pcb = NULL;
+static ip_addr_t server_addr;
+
+// Consulta em andamento
+static bool waiting = false;
+static uint64_t t1_local_us;                // Instante do envio (também vai como Transmit Timestamp)
+static absolute_time_t next_query;
+static uint32_t poll_interval_ms = NTP_POLL_MIN_MS;
+
+// Âncora da última sincronização: utc = anchor_utc_us + dt + dt * drift_ppb / 1e9
+static bool synced = false;
+static uint64_t anchor_local_us;
+static int64_t anchor_utc_us;
+static int32_t drift_ppb = 0;
+static bool drift_valid = false;
+
+static void time_sync_recv_cb(void *arg, struct udp_pcb *upcb, struct pbuf *p, const ip_addr_t *addr, u16_t port);
+
+static void put_be64(uint8_t *b, uint64_t v) {
+    for (int i = 0; i < 8; i++) b[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+
+static uint64_t get_be64(const uint8_t *b) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | b[i];
+    return v;
+}
+
+// Timestamp NTP (32.32 bits de ponto fixo desde 1900) em microssegundos Unix
+static int64_t ntp_to_unix_us(const uint8_t *b) {
+    uint64_t ts = get_be64(b);
+    uint64_t secs = ts >> 32;
+    uint64_t frac_us = ((ts & 0xFFFFFFFFu) * 1000000u) >> 32;
+    return (int64_t)(secs - NTP_UNIX_OFFSET_S) * 1000000 + (int64_t)frac_us;
+}
+
+/*
+ * time_sync_init: cria o PCB UDP e resolve o endereço do servidor configurado.
+ */
+void time_sync_init(void) {
+    if (!ipaddr_aton(NTP_SERVIDOR, &server_addr)) {
+        printf("[NTP] Endereço do servidor inválido: %s\n", NTP_SERVIDOR);
+        return;
+    }
+    pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+    if (pcb == NULL) {
+        printf("[NTP] Falha ao criar o PCB UDP.\n");
+        return;
+    }
+    udp_recv(pcb, time_sync_recv_cb, NULL);
+    next_query = get_absolute_time();
+}
+
+/*
+ * time_sync_send: envia uma consulta SNTP (modo cliente). O instante local do envio
+ * vai no Transmit Timestamp; o servidor o devolve no Originate Timestamp, o que
+ * associa a resposta a esta consulta sem guardar estado extra.
+ */
+static void time_sync_send(void) {
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, NTP_PACKET_LEN, PBUF_RAM);
+    if (p == NULL) {
+        next_query = make_timeout_time_ms(NTP_RETRY_MS);
+        return;
+    }
+
+    uint8_t *b = (uint8_t *)p->payload;
+    memset(b, 0, NTP_PACKET_LEN);
+    b[0] = (0 << 6) | (4 << 3) | 3;         // LI = 0, versão 4, modo 3 (cliente)
+    t1_local_us = time_us_64();
+    put_be64(&b[40], t1_local_us);
+
+    err_t err = udp_sendto(pcb, p, &server_addr, NTP_PORTA);
+    pbuf_free(p);
+
+    if (err != ERR_OK) {
+        printf("[NTP] Falha ao enviar consulta (%d).\n", err);
+        next_query = make_timeout_time_ms(NTP_RETRY_MS);
+        return;
+    }
+    waiting = true;
+    next_query = make_timeout_time_ms(NTP_TIMEOUT_MS);
+}
+
+void time_sync_poll(void) {
+    if (pcb == NULL || !time_reached(next_query)) return;
+
+    if (waiting) {
+        printf("[NTP] Sem resposta de %s.\n", NTP_SERVIDOR);
+        waiting = false;
+        next_query = make_timeout_time_ms(NTP_RETRY_MS);
+        return;
+    }
+    if (device_state_wifi_conectado()) {
+        time_sync_send();
+    }
+}
+
+/*
+ * time_sync_apply: incorpora uma medição. A deriva é a variação do offset entre duas
+ * sincronizações dividida pelo tempo local decorrido, suavizada por média móvel.
+ */
+static void time_sync_apply(uint64_t local_us, int64_t offset_us, int64_t delay_us) {
+    if (synced) {
+        uint64_t base_us = local_us - anchor_local_us;
+        int64_t prev_offset_us = anchor_utc_us - (int64_t)anchor_local_us;
+        int64_t delta_us = offset_us - prev_offset_us;
+        int64_t abs_us = delta_us < 0 ? -delta_us : delta_us;
+        if (base_us > (uint64_t)(INT64_MAX / (2 * NTP_DRIFT_MAX_PPB)) ||
+            (uint64_t)abs_us > base_us * NTP_DRIFT_MAX_PPB / 1000000000u + NTP_DEGRAU_US) {
+            // Variação maior do que a deriva máxima e o ruído explicariam (ou base longa
+            // demais para a conta em 64 bits): degrau no relógio. A deriva recomeça do zero.
+            LOG_AVISO("[NTP] Degrau de %lld ms no relógio; deriva zerada.", (long long)(delta_us / 1000));
+            drift_ppb = 0;
+            drift_valid = false;
+        } else if (base_us >= NTP_DRIFT_MIN_BASE_US) {
+            // |delta_us| * 1e9 <= base_us * NTP_DRIFT_MAX_PPB + NTP_DEGRAU_US * 1e9: cabe em 64 bits
+            int64_t meas = delta_us * 1000000000 / (int64_t)base_us;
+            if (meas > -NTP_DRIFT_MAX_PPB && meas < NTP_DRIFT_MAX_PPB) {
+                drift_ppb = drift_valid ? drift_ppb + (int32_t)((meas - drift_ppb) / 4) : (int32_t)meas;
+                drift_valid = true;
+            }
+        }
+        // Erro da previsão do modelo anterior no instante da nova medição
+        int64_t predicted = (int64_t)time_sync_utc_ms(local_us);
+        LOG_INFO("[NTP] Sincronizado: erro %lld ms, round-trip %lld ms, deriva %ld ppb.",
+                 (long long)((int64_t)(local_us + offset_us) / 1000 - predicted),
+                 (long long)(delay_us / 1000), (long)drift_ppb);
+    } else {
+        LOG_INFO("[NTP] Primeira sincronização: round-trip %lld ms.", (long long)(delay_us / 1000));
+    }
+
+    anchor_local_us = local_us;
+    anchor_utc_us = (int64_t)local_us + offset_us;
+    synced = true;
+}
+
+/*
+ * time_sync_recv_cb: chamada pelo lwIP com a resposta. Calcula offset e round-trip
+ * pelas quatro marcas de tempo do SNTP:
+ *   offset = ((t2 - t1) + (t3 - t4)) / 2,  atraso = (t4 - t1) - (t3 - t2)
+ */
+static void time_sync_recv_cb(void *arg, struct udp_pcb *upcb, struct pbuf *p, const ip_addr_t *addr, u16_t port) {
+    uint64_t t4 = time_us_64();
+    uint8_t b[NTP_PACKET_LEN];
+    (void)arg; (void)upcb; (void)addr; (void)port;
+
+    bool ok = waiting && pbuf_copy_partial(p, b, NTP_PACKET_LEN, 0) == NTP_PACKET_LEN;
+    pbuf_free(p);
+    if (!ok) return;
+
+    uint8_t li = b[0] >> 6;
+    uint8_t mode = b[0] & 0x07;
+    uint8_t stratum = b[1];
+    if (mode != 4 || li == 3 || stratum == 0 || stratum > 15 || get_be64(&b[24]) != t1_local_us) {
+        // Resposta de outra consulta, servidor não sincronizado ou Kiss-o'-Death
+        return;
+    }
+    waiting = false;
+
+    int64_t t1 = (int64_t)t1_local_us;
+    int64_t t2 = ntp_to_unix_us(&b[32]);
+    int64_t t3 = ntp_to_unix_us(&b[40]);
+    int64_t offset = ((t2 - t1) + (t3 - (int64_t)t4)) / 2;
+    int64_t delay = ((int64_t)t4 - t1) - (t3 - t2);
+
+    if (delay < 0 || delay > NTP_ATRASO_MAX_US) {
+        LOG_AVISO("[NTP] Resposta descartada (round-trip %lld ms).", (long long)(delay / 1000));
+        next_query = make_timeout_time_ms(NTP_RETRY_MS);
+        return;
+    }
+
+    time_sync_apply(t4, offset, delay);
+
+    next_query = make_timeout_time_ms(poll_interval_ms);
+    if (poll_interval_ms < NTP_POLL_MAX_MS) poll_interval_ms *= 2;
+}
+
+bool time_sync_valid(void) {
+    return synced;
+}
+
+uint64_t time_sync_utc_ms(uint64_t local_us) {
+    if (!synced) return 0;
+    int64_t dt = (int64_t)(local_us - anchor_local_us);
+    int64_t utc_us = anchor_utc_us + dt + dt * drift_ppb / 1000000000;
+    return utc_us > 0 ? (uint64_t)utc_us / 1000 : 0;
+}
+
+int32_t time_sync_drift_ppb(void) {
+    return drift_ppb;
+}
@@ -1,10 +1,37 @@
 #include "pico/cyw43_arch.h"
 #include "pico/stdlib.h"
+#include "lwip/netif.h"
+#include "lwip/dhcp.h"
+#include "lwip/dns.h"
 #include <stdio.h>
+#include <string.h>
 #include "shared_vars.h"
 #include "wifi.h"
+#include "device_state.h"
+#include "net_cache.h"
+#include "boot_trace.h"
+#include "binlog.h"
 //#include "led.h"
 
+// Tempo máximo de uma tentativa de associação (inclui o DHCP)
+#define WIFI_JOIN_TIMEOUT_MS  15000
+
+static volatile wifi_state_t wifi_state = WIFI_STATE_IDLE;
+static absolute_time_t wifi_deadline;
+
+// Cache da última associação (BSSID/canal/lease) para o caminho rápido de boot
+static net_cache_t cache;
+static bool cache_valid = false;
+static bool fast_join = false;             // A tentativa atual usa o BSSID/canal do cache
+static volatile bool cache_dirty = false;  // Há dados novos a gravar na flash
+
+static void wifi_start_join(void);
+static void wifi_schedule_retry(const char *motivo);
+static void wifi_apply_address(struct netif *netif);
+static void wifi_save_cache(struct netif *netif);
+static void wifi_link_cb(struct netif *netif);
+static void wifi_status_cb(struct netif *netif);
+
 // Inicializa a interface Wi-Fi.
 void wifi_init(void) {
     if (cyw43_arch_init()) {
@@ -13,21 +40,221 @@ void wifi_init(void) {
         while(true);
     }
     cyw43_arch_enable_sta_mode();
-    printf("Interface Wi-Fi inicializada.\n");
+
+    // Callbacks do lwIP: detectam queda de link e obtenção de IP no momento em que ocorrem
+    struct netif *n = &cyw43_state.netif[CYW43_ITF_STA];
+    netif_set_link_callback(n, wifi_link_cb);
+    netif_set_status_callback(n, wifi_status_cb);
+
+#if WIFI_IP_ESTATICO
+    dhcp_stop(n);
+#endif
+
+    cache_valid = net_cache_load(&cache);
+
+    printf("Interface Wi-Fi inicializada%s.\n", cache_valid ? " (cache de rede encontrado)" : "");
+}
+
+// Dispara a associação sem bloquear. O resultado chega pelos callbacks do netif.
+void wifi_connect_async(void) {
+    if (wifi_state == WIFI_STATE_IDLE || wifi_state == WIFI_STATE_BACKOFF) {
+        wifi_start_join();
+    }
 }
 
+wifi_state_t wifi_get_state(void) {
+    return wifi_state;
+}
+
+// Trata timeouts e falhas reportadas pelo cyw43, e reassocia em segundo plano.
+void wifi_poll(void) {
+    switch (wifi_state) {
+    case WIFI_STATE_JOINING:
+    case WIFI_STATE_WAIT_IP: {
+        int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+        if (status == CYW43_LINK_BADAUTH) {
+            wifi_schedule_retry("senha rejeitada");
+        } else if (status == CYW43_LINK_NONET) {
+            wifi_schedule_retry("AP não encontrado");
+        } else if (status == CYW43_LINK_FAIL) {
+            wifi_schedule_retry("falha na associação");
+        } else if (time_reached(wifi_deadline)) {
+            wifi_schedule_retry("timeout");
+        }
+        break;
+    }
+    case WIFI_STATE_BACKOFF:
+        if (time_reached(wifi_deadline)) {
+            wifi_start_join();
+        }
+        break;
+    case WIFI_STATE_CONNECTED:
+        // A gravação na flash bloqueia; é feita aqui e não dentro dos callbacks
+        if (cache_dirty) {
+            wifi_save_cache(&cyw43_state.netif[CYW43_ITF_STA]);
+        }
+        break;
+    default:
+        break;
+    }
+}
 
-// Tenta conectar ao Wi-Fi. Retorna true em sucesso, false em falha.
-bool wifi_connect(void) {
-    printf("Conectando-se ao Wi-Fi '%s'...\n", WIFI_SSID);
+static void wifi_start_join(void) {
+    int err;
 
-    // Tenta conectar por até 30 segundos
-    if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 10000) != 0) {
-        printf("Falha ao conectar.\n");
-        return false;
+    fast_join = cache_valid;
+    if (fast_join) {
+        // Associação direta ao AP conhecido: dispensa a varredura de todos os canais
+        printf("[WIFI] Conectando-se ao Wi-Fi '%s' (canal %d em cache)...\n", WIFI_SSID, cache.channel);
+        err = cyw43_wifi_join(&cyw43_state, strlen(WIFI_SSID), (const uint8_t *)WIFI_SSID,
+                              strlen(WIFI_PASSWORD), (const uint8_t *)WIFI_PASSWORD,
+                              CYW43_AUTH_WPA2_AES_PSK, cache.bssid, cache.channel);
+    } else {
+        printf("[WIFI] Conectando-se ao Wi-Fi '%s'...\n", WIFI_SSID);
+        err = cyw43_arch_wifi_connect_async(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK);
+    }
+    boot_trace_mark("wifi_associando");
+    if (err != 0) {
+        wifi_schedule_retry("erro ao iniciar associação");
+        return;
     }
+    wifi_state = WIFI_STATE_JOINING;
+    wifi_deadline = make_timeout_time_ms(WIFI_JOIN_TIMEOUT_MS);
+}
 
-    printf("Conexão WiFi bem-sucedida!\n");
-    g_wifi_connected = true;
-    return true;
-}
\ No newline at end of file
+static void wifi_schedule_retry(const char *motivo) {
+    device_state_set_wifi(false, 0);
+    wifi_state = WIFI_STATE_BACKOFF;
+    if (fast_join) {
+        // O AP pode ter mudado de canal ou sido trocado: volta à varredura completa já
+        printf("[WIFI] Associação rápida falhou (%s). Tentando com varredura completa...\n", motivo);
+        cache_valid = false;
+        wifi_deadline = get_absolute_time();
+    } else {
+        uint32_t delay_ms = reconnect_on_failure(&g_reconnect, RECONNECT_WIFI);
+        printf("[WIFI] Falha ao conectar (%s). Nova tentativa em %lu ms...\n", motivo, (unsigned long)delay_ms);
+        wifi_deadline = make_timeout_time_ms(delay_ms);
+    }
+    // Aborta a associação pendente para que a próxima comece do zero
+    cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+}
+
+/*
+ * wifi_link_cb: chamada pelo lwIP quando o link L2 sobe ou cai.
+ * A queda é tratada aqui mesmo, sem esperar uma falha no MQTT para percebê-la.
+ */
+static void wifi_link_cb(struct netif *netif) {
+    if (netif_is_link_up(netif)) {
+        LOG_INFO("[WIFI] Link ativo, aguardando IP...");
+        boot_trace_mark("wifi_link_up");
+        if (wifi_state == WIFI_STATE_JOINING) {
+            wifi_state = WIFI_STATE_WAIT_IP;
+        }
+        cache_dirty = true;
+        wifi_apply_address(netif);
+        return;
+    }
+
+    // Quedas provocadas por nós mesmos (abortar uma tentativa) já estão em espera
+    if (wifi_state != WIFI_STATE_CONNECTED && wifi_state != WIFI_STATE_WAIT_IP) {
+        return;
+    }
+
+    LOG_AVISO("[WIFI] Link perdido! Reassociando...");
+    device_state_set_wifi(false, 0);
+    // Primeira reassociação é imediata; falhas seguintes entram em espera
+    wifi_state = WIFI_STATE_BACKOFF;
+    wifi_deadline = get_absolute_time();
+}
+
+/*
+ * wifi_status_cb: chamada pelo lwIP quando a interface muda de estado ou de endereço.
+ * Marca a conexão como pronta assim que o DHCP entrega um IP válido.
+ */
+static void wifi_status_cb(struct netif *netif) {
+    bool has_ip = netif_is_up(netif) && netif_is_link_up(netif) &&
+                  !ip4_addr_isany_val(*netif_ip4_addr(netif));
+
+    bool conectado = device_state_wifi_conectado();
+
+    if (has_ip && !conectado) {
+        const ip4_addr_t *ip = netif_ip4_addr(netif);
+        LOG_INFO("[WIFI] Conexão WiFi bem-sucedida! IP: %u.%u.%u.%u",
+                 ip4_addr1(ip), ip4_addr2(ip), ip4_addr3(ip), ip4_addr4(ip));
+        boot_trace_mark("wifi_ip");
+        reconnect_reset(&g_reconnect, RECONNECT_WIFI);
+        wifi_state = WIFI_STATE_CONNECTED;
+    }
+
+    if (has_ip) {
+        // Novo lease (ou lease confirmado pelo DHCP): atualiza o cache e o endereço publicado
+        cache_dirty = true;
+        device_state_set_wifi(true, ip4_addr_get_u32(netif_ip4_addr(netif)));
+    } else if (!has_ip && conectado) {
+        LOG_AVISO("[WIFI] Endereço IP perdido.");
+        device_state_set_wifi(false, 0);
+        wifi_state = WIFI_STATE_WAIT_IP;
+        wifi_deadline = make_timeout_time_ms(WIFI_JOIN_TIMEOUT_MS);
+    }
+}
+
+/*
+ * wifi_apply_address: define o endereço assim que o link sobe, sem esperar o DHCP.
+ * No modo estático usa o IP configurado; caso contrário reaproveita, de forma
+ * otimista, o último lease salvo enquanto o DHCP confirma em segundo plano.
+ * O servidor DNS segue a mesma regra: o configurado no modo estático, e o gateway
+ * do lease em cache até o DHCP informar o servidor real.
+ */
+static void wifi_apply_address(struct netif *netif) {
+    ip4_addr_t ip, mask, gw;
+    ip_addr_t dns;
+
+#if WIFI_IP_ESTATICO
+    dhcp_stop(netif);
+    ip4addr_aton(WIFI_IP_ENDERECO, &ip);
+    ip4addr_aton(WIFI_IP_MASCARA, &mask);
+    ip4addr_aton(WIFI_IP_GATEWAY, &gw);
+    ipaddr_aton(WIFI_IP_DNS, &dns);
+#else
+    if (!cache_valid || !cache.has_lease) return;
+    ip4_addr_set_u32(&ip, cache.ip);
+    ip4_addr_set_u32(&mask, cache.netmask);
+    ip4_addr_set_u32(&gw, cache.gw);
+    ip_addr_copy_from_ip4(dns, gw);
+    LOG_INFO("[WIFI] Reutilizando lease em cache: %u.%u.%u.%u",
+             ip4_addr1(&ip), ip4_addr2(&ip), ip4_addr3(&ip), ip4_addr4(&ip));
+#endif
+    netif_set_addr(netif, &ip, &mask, &gw);
+    dns_setserver(0, &dns);
+}
+
+// Grava BSSID, canal e lease da associação atual na flash.
+static void wifi_save_cache(struct netif *netif) {
+#if !WIFI_IP_ESTATICO
+    // Enquanto o endereço for o lease otimista, espera o DHCP confirmá-lo
+    if (!dhcp_supplied_address(netif)) return;
+#endif
+    cache_dirty = false;
+
+    net_cache_t novo;
+    memset(&novo, 0, sizeof(novo));
+    novo.ssid_hash = net_cache_ssid_hash();
+    if (cyw43_wifi_get_bssid(&cyw43_state, novo.bssid) != 0) return;
+
+    // WLC_GET_CHANNEL devolve { hw_channel, target_channel, scan_channel }
+    uint32_t channel_info[3] = {0};
+    if (cyw43_ioctl(&cyw43_state, CYW43_IOCTL_GET_CHANNEL, sizeof(channel_info), (uint8_t *)channel_info, CYW43_ITF_STA) != 0) return;
+    novo.channel = (uint8_t)channel_info[0];
+
+#if !WIFI_IP_ESTATICO
+    novo.has_lease = 1;
+    novo.ip = ip4_addr_get_u32(netif_ip4_addr(netif));
+    novo.netmask = ip4_addr_get_u32(netif_ip4_netmask(netif));
+    novo.gw = ip4_addr_get_u32(netif_ip4_gw(netif));
+#endif
+
+    if (net_cache_store(&novo)) {
+        cache = novo;
+        cache_valid = true;
+    }
+}
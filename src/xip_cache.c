@@ -0,0 +1,85 @@
+#include "xip_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/xip_ctrl.h"
+
+#define SYSTICK_MASCARA 0x00FFFFFFu     // Contador de 24 bits, decrescente
+
+static uint32_t ciclos_por_us = 125;
+
+// As funções de medida ficam sempre na SRAM, com ou sem XIP_RAM_QUENTE: não podem
+// sujar a cache que medem
+
+void xip_cache_init(void) {
+    xip_cache_clock(clock_get_hz(clk_sys));
+    systick_hw->csr = 0;
+    systick_hw->rvr = SYSTICK_MASCARA;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+}
+
+void xip_cache_clock(uint32_t hz) {
+    ciclos_por_us = hz / 1000000u;
+}
+
+void __not_in_flash_func(xip_cache_flush)(void) {
+    xip_ctrl_hw->flush = 1;
+    (void)xip_ctrl_hw->flush;   // A leitura espera a invalidação terminar
+}
+
+void __not_in_flash_func(xip_regiao_inicio)(xip_regiao_t *r) {
+    r->acc0 = xip_ctrl_hw->ctr_acc;
+    r->hit0 = xip_ctrl_hw->ctr_hit;
+    r->t0_us = time_us_32();
+    r->st0 = systick_hw->cvr;
+}
+
+void __not_in_flash_func(xip_regiao_fim)(xip_regiao_t *r) {
+    uint32_t st = systick_hw->cvr;
+    uint32_t us = time_us_32() - r->t0_us;
+    uint32_t acc = xip_ctrl_hw->ctr_acc - r->acc0;
+    uint32_t hit = xip_ctrl_hw->ctr_hit - r->hit0;
+
+    // O SysTick dá a volta em 2^24 ciclos (134 ms a 125 MHz); acima disso, vale o timer,
+    // convertido no clock atual (o loop não troca de nível dentro de uma região medida)
+    uint32_t mhz = ciclos_por_us;
+    uint32_t ciclos = (r->st0 - st) & SYSTICK_MASCARA;
+    if (us >= SYSTICK_MASCARA / mhz / 2) ciclos = us * mhz;
+
+    // Somas deste clock; com todas ocupadas por outros, a última é reaproveitada
+    xip_soma_t *s = &r->soma[XIP_CLOCKS - 1];
+    for (int i = 0; i < XIP_CLOCKS; i++) {
+        if (r->soma[i].mhz == mhz || r->soma[i].mhz == 0) {
+            s = &r->soma[i];
+            break;
+        }
+    }
+    if (s->mhz != mhz) *s = (xip_soma_t){ .mhz = mhz };
+
+    s->execucoes++;
+    s->ciclos += ciclos;
+    if (ciclos > s->pior_ciclos) s->pior_ciclos = ciclos;
+    s->acessos += acc;
+    s->faltas += acc - hit;
+}
+
+void xip_regiao_relata(xip_regiao_t *r) {
+    for (int i = 0; i < XIP_CLOCKS; i++) {
+        xip_soma_t *s = &r->soma[i];
+        if (s->execucoes == 0) continue;
+
+        uint32_t n = s->execucoes;
+        printf("[XIP] %-12s %3lu MHz, %lu execuções: %lu ciclos (pior %lu), %lu acessos e %lu faltas na "
+               "cache por execução (acerto %.1f%%)%s\n",
+               r->nome, (unsigned long)s->mhz, (unsigned long)n, (unsigned long)(s->ciclos / n),
+               (unsigned long)s->pior_ciclos, (unsigned long)(s->acessos / n), (unsigned long)(s->faltas / n),
+               s->acessos ? 100.0 * (double)(s->acessos - s->faltas) / (double)s->acessos : 100.0,
+               XIP_RAM_QUENTE ? "" : " [XIP_RAM_QUENTE 0]");
+    }
+    memset(r->soma, 0, sizeof(r->soma));
+}
@@ -0,0 +1,261 @@
+/*
+ * binlog_dump: decodifica o log binário do firmware (src/binlog.c). Os registros trazem
+ * só o endereço da string de formato; o texto vem do ELF gravado na placa.
+ *
+ * Entrada: a saída da USB (stdin ou --in ARQUIVO). Linhas "@L <hex>" são decodificadas;
+ * as demais (printf comuns) passam sem alteração, na ordem em que chegaram.
+ *
+ *   cat /dev/ttyACM0 | binlog_dump build/mqtt_with_psk.elf
+ *   binlog_dump --nivel 2 build/mqtt_with_psk.elf --in captura.txt
+ */
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "binlog.h"
+
+#define MAX_LINHA 2048
+#define MAX_SAIDA 1024
+
+#define SHT_NOBITS 8
+#define SHF_ALLOC  0x2
+
+typedef struct {
+    uint8_t tipo;
+    uint64_t v;
+    float f;
+    char s[BINLOG_STR_MAX + 1];
+} arg_t;
+
+static uint8_t *elf;
+static size_t elf_len;
+
+static uint32_t le16(const uint8_t *p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8; }
+static uint32_t le32(const uint8_t *p) { return le16(p) | le16(p + 2) << 16; }
+
+static bool elf_load(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); return false; }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    elf = malloc((size_t)n);
+    if (!elf || fread(elf, 1, (size_t)n, f) != (size_t)n) {
+        fprintf(stderr, "%s: erro de leitura\n", path);
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+    elf_len = (size_t)n;
+
+    // O firmware do RP2040 é ELF32 little-endian
+    if (elf_len < 52 || memcmp(elf, "\x7f" "ELF", 4) || elf[4] != 1 || elf[5] != 1) {
+        fprintf(stderr, "%s: não é um ELF32 little-endian\n", path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Texto no endereço 'addr' da imagem (seções carregadas), ou NULL.
+ */
+static const char *elf_string(uint32_t addr) {
+    uint32_t shoff = le32(&elf[0x20]);
+    uint32_t shentsize = le16(&elf[0x2E]);
+    uint32_t shnum = le16(&elf[0x30]);
+
+    for (uint32_t i = 0; i < shnum; i++) {
+        size_t h = (size_t)shoff + (size_t)i * shentsize;
+        if (h + 40 > elf_len) break;
+        const uint8_t *sh = &elf[h];
+        uint32_t tipo = le32(sh + 4), flags = le32(sh + 8);
+        uint32_t sh_addr = le32(sh + 12), off = le32(sh + 16), size = le32(sh + 20);
+        if (tipo == SHT_NOBITS || !(flags & SHF_ALLOC)) continue;
+        if (addr < sh_addr || addr - sh_addr >= size || (size_t)off + size > elf_len) continue;
+
+        const char *s = (const char *)&elf[off + (addr - sh_addr)];
+        if (memchr(s, '\0', size - (addr - sh_addr))) return s;
+    }
+    return NULL;
+}
+
+static int hexval(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/**
+ * @brief Formata 'fmt' com os argumentos gravados. Cada conversão é refeita com o
+ * tipo que o firmware registrou (não com o modificador de tamanho do formato), e
+ * os '*' de largura/precisão consomem um argumento inteiro, como no printf.
+ */
+static void format(char *out, size_t cap, const char *fmt, const arg_t *args, unsigned nargs) {
+    size_t o = 0;
+    unsigned a = 0;
+
+    while (*fmt && o + 1 < cap) {
+        if (*fmt != '%') { out[o++] = *fmt++; continue; }
+        if (fmt[1] == '%') { out[o++] = '%'; fmt += 2; continue; }
+
+        char spec[48];
+        size_t s = 0;
+        spec[s++] = *fmt++;
+        while (*fmt && strchr("-+ #0", *fmt) && s < 8) spec[s++] = *fmt++;
+        for (int parte = 0; parte < 2; parte++) {
+            if (parte == 1) {
+                if (*fmt != '.') break;
+                spec[s++] = *fmt++;
+            }
+            if (*fmt == '*') {
+                long v = a < nargs ? (long)(int32_t)args[a++].v : 0;
+                s += (size_t)snprintf(&spec[s], sizeof(spec) - s - 8, "%ld", v);
+                fmt++;
+            } else {
+                while (isdigit((unsigned char)*fmt) && s < 32) spec[s++] = *fmt++;
+            }
+        }
+        while (*fmt && strchr("hlLqjzt", *fmt)) fmt++;
+        char conv = *fmt ? *fmt++ : 's';
+
+        const arg_t *arg = a < nargs ? &args[a++] : NULL;
+        char tmp[MAX_SAIDA];
+        if (!arg) {
+            snprintf(tmp, sizeof(tmp), "<?>");
+        } else if (strchr("di", conv)) {
+            long long v = arg->tipo == BINLOG_ARG_I64 || arg->tipo == BINLOG_ARG_U64
+                        ? (long long)arg->v : (long long)(int32_t)arg->v;
+            memcpy(&spec[s], "ll", 2); spec[s + 2] = conv; spec[s + 3] = '\0';
+            snprintf(tmp, sizeof(tmp), spec, v);
+        } else if (strchr("uxXo", conv)) {
+            unsigned long long v = arg->tipo == BINLOG_ARG_I64 || arg->tipo == BINLOG_ARG_U64
+                                 ? arg->v : (uint32_t)arg->v;
+            memcpy(&spec[s], "ll", 2); spec[s + 2] = conv; spec[s + 3] = '\0';
+            snprintf(tmp, sizeof(tmp), spec, v);
+        } else if (conv == 'c') {
+            spec[s] = 'c'; spec[s + 1] = '\0';
+            snprintf(tmp, sizeof(tmp), spec, (int)arg->v);
+        } else if (strchr("fFeEgGaA", conv)) {
+            double v = arg->tipo == BINLOG_ARG_F32 ? (double)arg->f : (double)(int64_t)arg->v;
+            spec[s] = conv; spec[s + 1] = '\0';
+            snprintf(tmp, sizeof(tmp), spec, v);
+        } else if (conv == 's') {
+            spec[s] = 's'; spec[s + 1] = '\0';
+            snprintf(tmp, sizeof(tmp), spec, arg->tipo == BINLOG_ARG_STR ? arg->s : "<?>");
+        } else {
+            // %p e conversões desconhecidas: endereço de 32 bits
+            snprintf(tmp, sizeof(tmp), "0x%08x", (uint32_t)arg->v);
+        }
+        o += (size_t)snprintf(&out[o], cap - o, "%s", tmp);
+        if (o >= cap) o = cap - 1;
+    }
+    out[o] = '\0';
+}
+
+/**
+ * @brief Decodifica uma linha "@L <hex>". Retorna false se o registro for inválido.
+ */
+static bool decode(const char *hex, int nivel_min) {
+    static const char niveis[] = "DIAE";
+    uint8_t reg[256];
+    size_t n = 0;
+
+    while (hex[0] && hex[1] && n < sizeof(reg)) {
+        int hi = hexval(hex[0]), lo = hexval(hex[1]);
+        if (hi < 0 || lo < 0) break;
+        reg[n++] = (uint8_t)(hi << 4 | lo);
+        hex += 2;
+    }
+    if (n < 10 || reg[0] != n) return false;
+
+    unsigned nivel = reg[1] >> 4, nargs = reg[1] & 0x0F;
+    uint32_t fmt_addr = le32(&reg[2]), t_us = le32(&reg[6]);
+    if (nargs > BINLOG_MAX_ARGS || nivel > BINLOG_ERRO) return false;
+    if ((int)nivel < nivel_min) return true;
+
+    arg_t args[BINLOG_MAX_ARGS];
+    size_t p = 10;
+    for (unsigned i = 0; i < nargs; i++) {
+        arg_t *a = &args[i];
+        memset(a, 0, sizeof(*a));
+        if (p >= n) return false;
+        a->tipo = reg[p++];
+        switch (a->tipo) {
+        case BINLOG_ARG_I64:
+        case BINLOG_ARG_U64:
+            if (p + 8 > n) return false;
+            a->v = le32(&reg[p]) | (uint64_t)le32(&reg[p + 4]) << 32;
+            p += 8;
+            break;
+        case BINLOG_ARG_STR: {
+            if (p >= n || p + 1 + reg[p] > n || reg[p] > BINLOG_STR_MAX) return false;
+            size_t len = reg[p++];
+            memcpy(a->s, &reg[p], len);
+            a->s[len] = '\0';
+            p += len;
+            break;
+        }
+        default: {
+            if (p + 4 > n) return false;
+            uint32_t bits = le32(&reg[p]);
+            a->v = bits;
+            memcpy(&a->f, &bits, sizeof(a->f));
+            p += 4;
+            break;
+        }
+        }
+    }
+
+    char texto[MAX_SAIDA];
+    const char *fmt = elf_string(fmt_addr);
+    if (fmt) {
+        format(texto, sizeof(texto), fmt, args, nargs);
+    } else {
+        snprintf(texto, sizeof(texto), "<formato 0x%08x fora do ELF: firmware diferente?>", fmt_addr);
+    }
+    printf("[%4lu.%06lu] %c %s\n", (unsigned long)(t_us / 1000000u), (unsigned long)(t_us % 1000000u),
+           niveis[nivel], texto);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *elf_path = NULL;
+    FILE *in = stdin;
+    int nivel_min = BINLOG_DEBUG;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--in") && i + 1 < argc) {
+            in = fopen(argv[++i], "r");
+            if (!in) { perror(argv[i]); return 1; }
+        } else if (!strcmp(argv[i], "--nivel") && i + 1 < argc) {
+            nivel_min = atoi(argv[++i]);
+        } else if (!elf_path) {
+            elf_path = argv[i];
+        } else {
+            fprintf(stderr, "uso: binlog_dump [--nivel N] [--in ARQUIVO] FIRMWARE.elf\n");
+            return 1;
+        }
+    }
+    if (!elf_path) {
+        fprintf(stderr, "uso: binlog_dump [--nivel N] [--in ARQUIVO] FIRMWARE.elf\n");
+        return 1;
+    }
+    if (!elf_load(elf_path)) return 1;
+
+    char linha[MAX_LINHA];
+    unsigned invalidos = 0;
+    while (fgets(linha, sizeof(linha), in)) {
+        if (strncmp(linha, "@L ", 3) != 0) {
+            fputs(linha, stdout);
+        } else if (!decode(linha + 3, nivel_min)) {
+            invalidos++;
+        }
+        fflush(stdout);
+    }
+    if (invalidos) fprintf(stderr, "binlog_dump: %u registros inválidos\n", invalidos);
+    return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * cbor_dump: decodifica payloads CBOR publicados pelo firmware, usando o mesmo
+ * src/cbor.c, e imprime em notação de diagnóstico (RFC 8949, seção 8).
+ *
+ * Entrada: uma mensagem por linha, em hexadecimal, opcionalmente precedida do tópico
+ * (formato de `mosquitto_sub -v -F '%t %x'`). Com --bin ARQUIVO, lê um payload binário.
+ *
+ *   mosquitto_sub ... -t '/aluno72/#' -F '%t %x' | cbor_dump
+ *   cbor_dump a101fa41ca7ae1
+ */
+#include <ctype.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cbor.h"
+#include "payload.h"
+
+#define MAX_PAYLOAD 4096
+#define MAX_DEPTH   8
+
+static const char *key_name(uint64_t key) {
+    switch (key) {
+    case PAYLOAD_CHAVE_TIMESTAMP:   return "ts";
+    case PAYLOAD_CHAVE_TEMPERATURA: return "temperatura";
+    case PAYLOAD_CHAVE_ESTADO:      return "estado";
+    case PAYLOAD_CHAVE_INTERVALOS:  return "intervalos";
+    case PAYLOAD_CHAVE_MEMORIA:     return "memoria";
+    case PAYLOAD_CHAVE_HEAP:        return "heap";
+    case PAYLOAD_CHAVE_PILHAS:      return "pilhas";
+    default:                        return NULL;
+    }
+}
+
+static void print_text(const uint8_t *p, size_t n) {
+    putchar('"');
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] == '"' || p[i] == '\\') printf("\\%c", p[i]);
+        else if (p[i] < 0x20) printf("\\u%04x", p[i]);
+        else putchar(p[i]);
+    }
+    putchar('"');
+}
+
+// Menor representação decimal que volta ao mesmo valor (floats de 16/32 bits
+// aparecem como "25.31" e não como "25.3099995")
+static void print_float(double v) {
+    char tmp[32];
+    bool single = (double)(float)v == v;
+    for (int prec = 1; prec <= 17; prec++) {
+        snprintf(tmp, sizeof(tmp), "%.*g", prec, v);
+        if (single ? strtof(tmp, NULL) == (float)v : strtod(tmp, NULL) == v) break;
+    }
+    // Notação de diagnóstico: floats sempre com parte fracionária ou expoente
+    printf("%s%s", tmp, strpbrk(tmp, ".e") ? "" : ".0");
+}
+
+// Imprime um item completo; em mapas, anota as chaves conhecidas (ver payload.h)
+static bool dump_item(cbor_reader_t *r, int depth) {
+    cbor_item_t it;
+
+    if (depth > MAX_DEPTH || !cbor_read(r, &it)) return false;
+
+    switch (it.type) {
+    case CBOR_TYPE_UINT:
+        printf("%llu", (unsigned long long)it.u);
+        return true;
+    case CBOR_TYPE_NEGINT:
+        printf("%lld", (long long)it.i);
+        return true;
+    case CBOR_TYPE_BYTES:
+        printf("h'");
+        for (size_t i = 0; i < it.str.len; i++) printf("%02x", it.str.ptr[i]);
+        putchar('\'');
+        return true;
+    case CBOR_TYPE_TEXT:
+        print_text(it.str.ptr, it.str.len);
+        return true;
+    case CBOR_TYPE_ARRAY:
+        putchar('[');
+        for (uint64_t i = 0; i < it.count; i++) {
+            if (i) printf(", ");
+            if (!dump_item(r, depth + 1)) return false;
+        }
+        putchar(']');
+        return true;
+    case CBOR_TYPE_MAP:
+        putchar('{');
+        for (uint64_t i = 0; i < it.count; i++) {
+            if (i) printf(", ");
+            size_t key_pos = r->pos;
+            cbor_item_t key;
+            if (!dump_item(r, depth + 1)) return false;
+            // Relê a chave para anotar o nome, se for uma das chaves inteiras do firmware
+            cbor_reader_t kr = *r;
+            kr.pos = key_pos;
+            if (cbor_read(&kr, &key) && key.type == CBOR_TYPE_UINT && key_name(key.u)) {
+                printf(" /%s/", key_name(key.u));
+            }
+            printf(": ");
+            if (!dump_item(r, depth + 1)) return false;
+        }
+        putchar('}');
+        return true;
+    case CBOR_TYPE_TAG:
+        printf("%llu(", (unsigned long long)it.u);
+        if (!dump_item(r, depth + 1)) return false;
+        putchar(')');
+        return true;
+    case CBOR_TYPE_BOOL:
+        printf(it.b ? "true" : "false");
+        return true;
+    case CBOR_TYPE_NULL:
+        printf("null");
+        return true;
+    case CBOR_TYPE_UNDEFINED:
+        printf("undefined");
+        return true;
+    case CBOR_TYPE_FLOAT:
+        if (isnan(it.f)) printf("NaN");
+        else if (isinf(it.f)) printf(it.f > 0 ? "Infinity" : "-Infinity");
+        else print_float(it.f);
+        return true;
+    }
+    return false;
+}
+
+static int dump_payload(const char *topic, const uint8_t *buf, size_t len) {
+    cbor_reader_t r;
+    cbor_reader_init(&r, buf, len);
+
+    if (topic) printf("%s ", topic);
+    // Normalmente um único item, mas uma sequência CBOR (RFC 8742) também é aceita
+    while (r.pos < r.len) {
+        if (r.pos > 0) printf(", ");
+        if (!dump_item(&r, 0)) {
+            printf(" <CBOR inválido no byte %zu>\n", r.pos);
+            return 1;
+        }
+    }
+    printf("  (%zu bytes)\n", len);
+    return 0;
+}
+
+static int hex_value(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Converte o hexadecimal em bytes; retorna -1 se não for hexadecimal válido
+static long parse_hex(const char *s, uint8_t *out, size_t cap) {
+    size_t n = 0;
+    while (*s && !isspace((unsigned char)*s)) {
+        int hi = hex_value(s[0]);
+        int lo = s[1] ? hex_value(s[1]) : -1;
+        if (hi < 0 || lo < 0 || n == cap) return -1;
+        out[n++] = (uint8_t)(hi << 4 | lo);
+        s += 2;
+    }
+    return (long)n;
+}
+
+static int dump_line(char *line) {
+    static uint8_t buf[MAX_PAYLOAD];
+    char *topic = NULL;
+    char *hex = line;
+
+    line[strcspn(line, "\r\n")] = '\0';
+    if (!*line) return 0;
+
+    // "tópico hex": o hexadecimal é o último campo
+    char *sp = strrchr(line, ' ');
+    if (sp) {
+        *sp = '\0';
+        topic = line;
+        hex = sp + 1;
+    }
+
+    long n = parse_hex(hex, buf, sizeof(buf));
+    if (n < 0) {
+        fprintf(stderr, "linha ignorada (não é hexadecimal): %s\n", hex);
+        return 1;
+    }
+    return dump_payload(topic, buf, (size_t)n);
+}
+
+int main(int argc, char **argv) {
+    int err = 0;
+
+    if (argc == 3 && !strcmp(argv[1], "--bin")) {
+        static uint8_t buf[MAX_PAYLOAD];
+        FILE *f = fopen(argv[2], "rb");
+        if (!f) {
+            perror(argv[2]);
+            return 1;
+        }
+        size_t n = fread(buf, 1, sizeof(buf), f);
+        fclose(f);
+        return dump_payload(NULL, buf, n);
+    }
+
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) err |= dump_line(argv[i]);
+        return err;
+    }
+
+    char line[2 * MAX_PAYLOAD + 256];
+    while (fgets(line, sizeof(line), stdin)) {
+        err |= dump_line(line);
+        fflush(stdout);
+    }
+    return err;
+}
@@ -0,0 +1,327 @@
+/*
+ * crypto_bench: custo do AES e do SHA-256 em ciclos/byte, comparando os núcleos de
+ * src/crypto_kernels.c com as implementações C do mbedTLS.
+ *
+ * Compila de duas formas:
+ *  - Firmware (alvo crypto_bench do CMakeLists.txt raiz): roda no RP2040 e imprime o
+ *    relatório pela USB a cada 10 s. O mbedTLS é compilado com CRYPTO_ALT=0, ou seja,
+ *    "mbedtls" nas linhas abaixo é a implementação original.
+ *  - Host (tools/CMakeLists.txt, CRYPTO_BENCH_HOST): ciclos do TSC no x86, ou ns em
+ *    outras arquiteturas. Compara com o mbedTLS do sistema se ele estiver instalado
+ *    (CRYPTO_BENCH_MBEDTLS); senão mede só os núcleos.
+ *
+ * Antes de medir, confere os núcleos contra os vetores do FIPS-197/FIPS-180 e, com o
+ * mbedTLS, contra a própria expansão de chave e as saídas dele em blocos aleatórios.
+ *
+ * Saída: uma linha "[BENCH] <operação> <implementação> <ciclos/byte>" por medida e a
+ * estimativa do custo criptográfico de uma publicação (registro TLS AES-128-CBC +
+ * HMAC-SHA256).
+ */
+#define MBEDTLS_ALLOW_PRIVATE_ACCESS
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "crypto_kernels.h"
+
+#ifdef CRYPTO_BENCH_HOST
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIDADE "ciclos/byte"
+#else
+#define BENCH_UNIDADE "ns/byte"
+#endif
+#else
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#define CRYPTO_BENCH_MBEDTLS
+#define BENCH_UNIDADE "ciclos/byte"
+#endif
+
+#ifdef CRYPTO_BENCH_MBEDTLS
+#include "mbedtls/version.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+
+// Campos internos dos contextos (o mbedTLS do host pode ser 2.x)
+#if MBEDTLS_VERSION_MAJOR >= 3
+#define AES_RK(ctx)         ((ctx)->MBEDTLS_PRIVATE(buf) + (ctx)->MBEDTLS_PRIVATE(rk_offset))
+#define SHA_ESTADO(ctx)     ((ctx)->MBEDTLS_PRIVATE(state))
+#define SHA256_STARTS(ctx)  mbedtls_sha256_starts(ctx, 0)
+#else
+#define AES_RK(ctx)         ((ctx)->rk)
+#define SHA_ESTADO(ctx)     ((ctx)->state)
+#define SHA256_STARTS(ctx)  mbedtls_sha256_starts_ret(ctx, 0)
+#endif
+#endif
+
+#define BENCH_BYTES        1024     // Dados por passada
+#define BENCH_MIN_US       200000   // Tempo mínimo de cada medida
+#define BENCH_PUBLICACAO   64       // Pacote MQTT típico (PUBLISH com payload CBOR)
+
+static uint8_t dados[BENCH_BYTES];
+static uint8_t saida[BENCH_BYTES];
+
+// --- Relógio ---
+
+#ifdef CRYPTO_BENCH_HOST
+static uint64_t agora_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint64_t contador(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+#else
+static uint64_t agora_us(void) {
+    return time_us_64();
+}
+
+// Sem contador de ciclos no M0+: tempo × clk_sys
+static uint64_t contador(void) {
+    return time_us_64() * (clock_get_hz(clk_sys) / 1000000u);
+}
+#endif
+
+// --- Operações medidas: processam 'n' bytes de dados[] ---
+
+typedef void (*bench_fn)(size_t n);
+
+static uint32_t rk_enc[60], rk_dec[60];
+static int nr;
+static uint32_t sha_estado[8];
+
+static void aes_enc_table(size_t n) {
+    for (size_t i = 0; i < n; i += 16) crypto_aes_encrypt_table(rk_enc, nr, dados + i, saida + i);
+}
+
+static void aes_enc_ct(size_t n) {
+    for (size_t i = 0; i < n; i += 16) crypto_aes_encrypt_ct(rk_enc, nr, dados + i, saida + i);
+}
+
+static void aes_dec_table(size_t n) {
+    for (size_t i = 0; i < n; i += 16) crypto_aes_decrypt_table(rk_dec, nr, dados + i, saida + i);
+}
+
+static void aes_dec_ct(size_t n) {
+    for (size_t i = 0; i < n; i += 16) crypto_aes_decrypt_ct(rk_dec, nr, dados + i, saida + i);
+}
+
+static void sha_kernel(size_t n) {
+    for (size_t i = 0; i < n; i += 64) crypto_sha256_block(sha_estado, dados + i);
+}
+
+#ifdef CRYPTO_BENCH_MBEDTLS
+static mbedtls_aes_context aes_enc, aes_dec;
+static mbedtls_sha256_context sha;
+
+static void aes_enc_mbedtls(size_t n) {
+    for (size_t i = 0; i < n; i += 16) mbedtls_aes_crypt_ecb(&aes_enc, MBEDTLS_AES_ENCRYPT, dados + i, saida + i);
+}
+
+static void aes_dec_mbedtls(size_t n) {
+    for (size_t i = 0; i < n; i += 16) mbedtls_aes_crypt_ecb(&aes_dec, MBEDTLS_AES_DECRYPT, dados + i, saida + i);
+}
+
+static void sha_mbedtls(size_t n) {
+    for (size_t i = 0; i < n; i += 64) mbedtls_internal_sha256_process(&sha, dados + i);
+}
+#endif
+
+/**
+ * @brief Mede 'fn' por pelo menos BENCH_MIN_US e devolve unidades (ciclos ou ns) por byte.
+ */
+static double medir(bench_fn fn) {
+    uint64_t bytes = 0;
+
+    fn(BENCH_BYTES);    // Aquece tabelas e caches
+    uint64_t t0 = agora_us();
+    uint64_t c0 = contador();
+    do {
+        fn(BENCH_BYTES);
+        bytes += BENCH_BYTES;
+    } while (agora_us() - t0 < BENCH_MIN_US);
+    return (double)(contador() - c0) / (double)bytes;
+}
+
+static void relata(const char *operacao, const char *impl, double por_byte) {
+    printf("[BENCH] %-12s %-8s %8.1f %s\n", operacao, impl, por_byte, BENCH_UNIDADE);
+}
+
+// --- Verificação ---
+
+static const uint8_t fips_chave[16] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+};
+static const uint8_t fips_claro[16] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF,
+};
+static const uint8_t fips_cifrado[16] = {   // FIPS-197, C.1
+    0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30, 0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A,
+};
+static const uint32_t sha_iv[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+};
+
+/**
+ * @brief Confere os núcleos. Retorna o número de divergências.
+ */
+static int verificar(void) {
+    uint8_t bloco[64];
+    uint8_t a[16], b[16];
+    int falhas = 0;
+
+    // Vetores oficiais (a expansão de chave aqui é a de crypto_kernels.c)
+    crypto_aes_encrypt_table(rk_enc, nr, fips_claro, a);
+    crypto_aes_encrypt_ct(rk_enc, nr, fips_claro, b);
+    falhas += memcmp(a, fips_cifrado, 16) != 0;
+    falhas += memcmp(b, fips_cifrado, 16) != 0;
+    crypto_aes_decrypt_table(rk_dec, nr, fips_cifrado, a);
+    crypto_aes_decrypt_ct(rk_dec, nr, fips_cifrado, b);
+    falhas += memcmp(a, fips_claro, 16) != 0;
+    falhas += memcmp(b, fips_claro, 16) != 0;
+
+    // SHA-256("abc"), FIPS 180-2 B.1
+    uint32_t h[8];
+    memcpy(h, sha_iv, sizeof(h));
+    memset(bloco, 0, sizeof(bloco));
+    memcpy(bloco, "abc", 3);
+    bloco[3] = 0x80;
+    bloco[63] = 24;
+    crypto_sha256_block(h, bloco);
+    falhas += h[0] != 0xBA7816BF || h[7] != 0xF20015AD;
+
+#ifdef CRYPTO_BENCH_MBEDTLS
+    // Mesmas chaves de rodada e mesmas saídas que o mbedTLS, em blocos aleatórios
+    const uint32_t *mrk_enc = AES_RK(&aes_enc);
+    const uint32_t *mrk_dec = AES_RK(&aes_dec);
+    falhas += memcmp(mrk_enc, rk_enc, 4 * (nr + 1) * sizeof(uint32_t)) != 0;
+    falhas += memcmp(mrk_dec, rk_dec, 4 * (nr + 1) * sizeof(uint32_t)) != 0;
+
+    for (size_t i = 0; i < BENCH_BYTES; i += 16) {
+        uint8_t ref[16];
+        mbedtls_aes_crypt_ecb(&aes_enc, MBEDTLS_AES_ENCRYPT, dados + i, ref);
+        crypto_aes_encrypt_table(mrk_enc, nr, dados + i, a);
+        crypto_aes_encrypt_ct(mrk_enc, nr, dados + i, b);
+        falhas += memcmp(a, ref, 16) != 0;
+        falhas += memcmp(b, ref, 16) != 0;
+
+        mbedtls_aes_crypt_ecb(&aes_dec, MBEDTLS_AES_DECRYPT, dados + i, ref);
+        crypto_aes_decrypt_table(mrk_dec, nr, dados + i, a);
+        crypto_aes_decrypt_ct(mrk_dec, nr, dados + i, b);
+        falhas += memcmp(a, ref, 16) != 0;
+        falhas += memcmp(b, ref, 16) != 0;
+    }
+
+    SHA256_STARTS(&sha);
+    memcpy(h, SHA_ESTADO(&sha), sizeof(h));
+    for (size_t i = 0; i < BENCH_BYTES; i += 64) {
+        mbedtls_internal_sha256_process(&sha, dados + i);
+        crypto_sha256_block(h, dados + i);
+    }
+    falhas += memcmp(h, SHA_ESTADO(&sha), sizeof(h)) != 0;
+#endif
+    return falhas;
+}
+
+// --- Relatório ---
+
+/**
+ * @brief Custo de uma publicação de 'len' bytes num registro TLS 1.2 AES-128-CBC-SHA256:
+ * blocos AES do CBC (dados + MAC + padding) e compressões do HMAC (ipad, cabeçalho de
+ * 13 bytes + dados + padding do SHA, opad e hash interno).
+ */
+static void relata_publicacao(const char *impl, double aes_por_byte, double sha_por_byte, size_t len) {
+    size_t blocos_aes = (len + 32 + 1 + 15) / 16;
+    size_t blocos_sha = 1 + (13 + len + 9 + 63) / 64 + 2;
+    double total = aes_por_byte * 16 * blocos_aes + sha_por_byte * 64 * blocos_sha;
+
+    printf("[BENCH] publicacao_%u %-8s %8.0f %s\n", (unsigned)len, impl, total,
+           BENCH_UNIDADE[0] == 'c' ? "ciclos" : "ns");
+}
+
+static void roda(void) {
+    int falhas = verificar();
+    if (falhas) {
+        printf("[BENCH] ERRO: %d divergências na verificação; medidas descartadas.\n", falhas);
+        return;
+    }
+    printf("[BENCH] Verificação ok.\n");
+
+    double enc_table = medir(aes_enc_table), enc_ct = medir(aes_enc_ct);
+    double dec_table = medir(aes_dec_table), dec_ct = medir(aes_dec_ct);
+    double sha_k = medir(sha_kernel);
+
+#ifdef CRYPTO_BENCH_MBEDTLS
+    double enc_m = medir(aes_enc_mbedtls), dec_m = medir(aes_dec_mbedtls), sha_m = medir(sha_mbedtls);
+    relata("aes128_enc", "mbedtls", enc_m);
+#endif
+    relata("aes128_enc", "table", enc_table);
+    relata("aes128_enc", "ct", enc_ct);
+#ifdef CRYPTO_BENCH_MBEDTLS
+    relata("aes128_dec", "mbedtls", dec_m);
+#endif
+    relata("aes128_dec", "table", dec_table);
+    relata("aes128_dec", "ct", dec_ct);
+#ifdef CRYPTO_BENCH_MBEDTLS
+    relata("sha256", "mbedtls", sha_m);
+#endif
+    relata("sha256", "kernel", sha_k);
+
+#ifdef CRYPTO_BENCH_MBEDTLS
+    relata_publicacao("mbedtls", enc_m, sha_m, BENCH_PUBLICACAO);
+#endif
+    relata_publicacao("table", enc_table, sha_k, BENCH_PUBLICACAO);
+    relata_publicacao("ct", enc_ct, sha_k, BENCH_PUBLICACAO);
+}
+
+static void prepara(void) {
+    uint32_t x = 0x12345678;
+    for (size_t i = 0; i < BENCH_BYTES; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        dados[i] = (uint8_t)x;
+    }
+
+    nr = crypto_aes_setkey_enc(rk_enc, fips_chave, 128);
+    crypto_aes_setkey_dec(rk_dec, fips_chave, 128);
+    memcpy(sha_estado, sha_iv, sizeof(sha_estado));
+
+#ifdef CRYPTO_BENCH_MBEDTLS
+    mbedtls_aes_init(&aes_enc);
+    mbedtls_aes_init(&aes_dec);
+    mbedtls_aes_setkey_enc(&aes_enc, fips_chave, 128);
+    mbedtls_aes_setkey_dec(&aes_dec, fips_chave, 128);
+    mbedtls_sha256_init(&sha);
+    SHA256_STARTS(&sha);
+#endif
+}
+
+int main(void) {
+#ifdef CRYPTO_BENCH_HOST
+    prepara();
+    roda();
+    return 0;
+#else
+    stdio_init_all();
+    sleep_ms(3000);     // Tempo para abrir o terminal USB
+    prepara();
+    printf("[BENCH] clk_sys %lu Hz\n", (unsigned long)clock_get_hz(clk_sys));
+    while (true) {
+        roda();
+        sleep_ms(10000);
+    }
+#endif
+}
@@ -0,0 +1,420 @@
+/*
+ * fleet_sim: simula milhares de dispositivos contra um broker local, usando o mesmo
+ * cliente MQTT/TLS-PSK do firmware (src/mqtt.c) com a camada de rede de host.
+ *
+ * Cada dispositivo é um mqtt_client_t independente, conduzido por um único loop epoll:
+ * conexões são iniciadas no ritmo pedido e, depois de conectado, cada cliente publica
+ * periodicamente seguido de um PINGREQ. Como o broker processa os pacotes de uma conexão
+ * em ordem, o PINGRESP marca o fim do processamento da publicação (round-trip).
+ *
+ * Como a fila de publicação do firmware, cada rajada é escrita com cork; o perfil de
+ * transporte (--transporte) decide se ela sai em registros TLS pequenos, na hora e sem
+ * Nagle (latencia) ou acumulada em registros de um segmento cheio (vazao). Com
+ * --press-interval-ms, cada cliente também "aperta o botão" em instantes aleatórios
+ * (média N ms): publica o evento seguido de um PINGREQ próprio, e o relatório mostra a
+ * distribuição da latência botão->broker separada da telemetria.
+ *
+ * Uso: fleet_sim [--host IP] [--port N] [--clients N] [--connect-rate N/s]
+ *                [--publish-interval-ms N] [--burst N] [--press-interval-ms N]
+ *                [--transporte latencia|vazao] [--duration S] [--mqtt-version 4|5] [--verbose]
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+#include "mqtt.h"
+#include "payload.h"
+#include "shared_vars.h"
+
+#define EPOLL_BATCH 256
+#define LOOP_TIMEOUT_MS 5
+#define SIM_PINGS_MAX 4
+
+typedef struct {
+    mqtt_client_t mqtt;
+    int index;
+    int fd;                     // fd registrado no epoll (-1 se nenhum)
+    bool watching_out;          // EPOLLOUT ativo (apenas durante o connect TCP)
+    uint64_t t_start_us;        // Início da tentativa de conexão
+    uint64_t t_ping_us[SIM_PINGS_MAX];  // PINGREQs pendentes, na ordem de envio
+    bool ping_evento[SIM_PINGS_MAX];    // O PINGREQ veio depois de um evento de botão
+    int pings;
+    bool telemetria_pendente;   // Rajada de telemetria aguardando o PINGRESP
+    uint64_t next_publish_us;
+    uint64_t next_press_us;
+} sim_client_t;
+
+typedef struct {
+    uint32_t *v;
+    size_t n, cap;
+} samples_t;
+
+static FILE *report;
+static int epfd;
+static uint8_t mqtt_version = MQTT_VERSAO;
+static pico_net_perfil_t transporte = MQTT_TRANSPORTE;
+static uint32_t press_interval_ms = 0;     // 0 = sem botão simulado
+static int burst = 1;
+
+static struct {
+    uint32_t connected, failed, drops, publishes, presses;
+    uint64_t first_start_us, last_connect_us;
+    samples_t connect_lat, publish_rtt, press_lat;
+} stats;
+
+static void samples_add(samples_t *s, uint32_t v) {
+    if (s->n == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 1024;
+        s->v = realloc(s->v, s->cap * sizeof(uint32_t));
+    }
+    s->v[s->n++] = v;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void samples_print(const char *name, samples_t *s) {
+    if (s->n == 0) {
+        fprintf(report, "%-38s sem amostras\n", name);
+        return;
+    }
+    qsort(s->v, s->n, sizeof(uint32_t), cmp_u32);
+    fprintf(report, "%-38s n=%zu p50=%.2f p90=%.2f p99=%.2f max=%.2f ms\n", name, s->n,
+            s->v[s->n * 50 / 100] / 1000.0, s->v[s->n * 90 / 100] / 1000.0,
+            s->v[s->n * 99 / 100] / 1000.0, s->v[s->n - 1] / 1000.0);
+}
+
+static void sim_watch(sim_client_t *sc, uint32_t events, int op) {
+    struct epoll_event ev = { .events = events, .data.ptr = sc };
+    if (epoll_ctl(epfd, op, sc->fd, &ev) != 0 && op != EPOLL_CTL_DEL) {
+        perror("epoll_ctl");
+    }
+    sc->watching_out = (events & EPOLLOUT) != 0;
+}
+
+// Tira o fd do epoll antes que mqtt.c o feche (o número pode ser reaproveitado)
+static void sim_unwatch(sim_client_t *sc) {
+    if (sc->fd >= 0) {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, sc->fd, NULL);
+        sc->fd = -1;
+    }
+}
+
+static void sim_restart(sim_client_t *sc);
+
+// Intervalo até o próximo aperto de botão: uniforme em [0, 2 * média]
+static uint64_t sim_press_delay_us(void) {
+    return (uint64_t)(rand() % (2 * press_interval_ms + 1)) * 1000u;
+}
+
+static void sim_ping_push(sim_client_t *sc, uint64_t t_us, bool evento) {
+    sc->t_ping_us[sc->pings] = t_us;
+    sc->ping_evento[sc->pings] = evento;
+    sc->pings++;
+}
+
+// PINGRESP chegou: o broker já processou tudo o que foi enviado antes do PINGREQ mais antigo
+static void sim_ping_pop(sim_client_t *sc, uint64_t now) {
+    uint32_t dt = (uint32_t)(now - sc->t_ping_us[0]);
+    if (sc->ping_evento[0]) {
+        samples_add(&stats.press_lat, dt);
+    } else {
+        samples_add(&stats.publish_rtt, dt);
+        sc->telemetria_pendente = false;
+    }
+    sc->pings--;
+    memmove(&sc->t_ping_us[0], &sc->t_ping_us[1], (size_t)sc->pings * sizeof(sc->t_ping_us[0]));
+    memmove(&sc->ping_evento[0], &sc->ping_evento[1], (size_t)sc->pings * sizeof(sc->ping_evento[0]));
+}
+
+static void sim_drop(sim_client_t *sc) {
+    stats.drops++;
+    sim_unwatch(sc);
+    mqtt_client_close(&sc->mqtt);
+}
+
+static void sim_start(sim_client_t *sc, const char *host, uint16_t port) {
+    char id[32];
+    snprintf(id, sizeof(id), "%.16s-sim-%d", DEVICE_ID, sc->index);
+    mqtt_client_init(&sc->mqtt, host, port, id);
+    sc->mqtt.protocol_version = mqtt_version;
+    mqtt_client_set_transport(&sc->mqtt, transporte);
+
+    sc->t_start_us = time_us_64();
+    sim_restart(sc);
+}
+
+// (Re)abre a conexão de um cliente já configurado
+static void sim_restart(sim_client_t *sc) {
+    sc->pings = 0;
+    sc->telemetria_pendente = false;
+    sc->fd = -1;
+    if (!mqtt_client_start(&sc->mqtt)) {
+        stats.failed++;
+        return;
+    }
+    sc->fd = sc->mqtt.net.fd;
+    sim_watch(sc, EPOLLIN | EPOLLOUT, EPOLL_CTL_ADD);
+}
+
+static void sim_handle(sim_client_t *sc, uint32_t publish_interval_ms) {
+    mqtt_client_t *c = &sc->mqtt;
+    uint64_t now = time_us_64();
+
+    if (c->state == MQTT_STATE_TCP_CONNECTING) {
+        pico_net_host_update(&c->net);
+    }
+
+    if (c->state == MQTT_STATE_TCP_CONNECTING || c->state == MQTT_STATE_TLS_HANDSHAKE ||
+        c->state == MQTT_STATE_WAIT_CONNACK) {
+        mqtt_state_t st = mqtt_client_step(c);
+        if (st == MQTT_STATE_FAILED) {
+            // mqtt.c já fechou o socket, o que também o remove do epoll
+            sc->fd = -1;
+            if (c->fallback) {
+                // Broker recusou MQTT 5: repete já em v3.1.1, como mqtt_client_connect()
+                sim_restart(sc);
+                return;
+            }
+            stats.failed++;
+            return;
+        }
+        if (st == MQTT_STATE_CONNECTED) {
+            stats.connected++;
+            stats.last_connect_us = now;
+            samples_add(&stats.connect_lat, (uint32_t)(now - sc->t_start_us));
+            // Espalha a primeira publicação ao longo de um intervalo
+            sc->next_publish_us = now + (uint64_t)(rand() % (publish_interval_ms + 1)) * 1000u;
+            sc->next_press_us = now + sim_press_delay_us();
+        }
+        if (sc->watching_out && st != MQTT_STATE_TCP_CONNECTING) {
+            sim_watch(sc, EPOLLIN, EPOLL_CTL_MOD);
+        }
+        return;
+    }
+
+    if (c->state == MQTT_STATE_CONNECTED) {
+        int pongs = mqtt_client_process_input(c);
+        if (pongs < 0) {
+            sim_drop(sc);
+            return;
+        }
+        for (; pongs > 0 && sc->pings > 0; pongs--) {
+            sim_ping_pop(sc, now);
+        }
+    }
+}
+
+// Publicações periódicas e timeouts de clientes que ainda não receberam eventos
+static void sim_tick(sim_client_t *clients, int started, uint32_t publish_interval_ms) {
+    uint64_t now = time_us_64();
+
+    for (int i = 0; i < started; i++) {
+        sim_client_t *sc = &clients[i];
+        mqtt_client_t *c = &sc->mqtt;
+
+        if (c->state == MQTT_STATE_TCP_CONNECTING || c->state == MQTT_STATE_TLS_HANDSHAKE ||
+            c->state == MQTT_STATE_WAIT_CONNACK) {
+            if (time_reached(c->deadline)) {
+                // Um último passo detecta o timeout, mas também pode concluir a etapa: a
+                // contagem (falha, conexão ou fallback para v3.1.1) segue o estado retornado
+                sim_handle(sc, publish_interval_ms);
+            }
+            continue;
+        }
+
+        if (c->state != MQTT_STATE_CONNECTED) continue;
+
+        uint8_t payload[PAYLOAD_MAX_LEN];
+        size_t len;
+
+        // Botão: o evento sai no meio do que estiver em trânsito, com PINGREQ próprio
+        if (press_interval_ms && now >= sc->next_press_us) {
+            sc->next_press_us = now + sim_press_delay_us();
+            if (sc->pings < SIM_PINGS_MAX) {
+                len = payload_botao(&mqtt_topic_botao_a, true, now / 1000u, payload, sizeof(payload));
+                sim_ping_push(sc, now, true);
+                mqtt_client_cork(c);    // O ping descarrega o buffer
+                if (!mqtt_client_publish_topic(c, &mqtt_topic_botao_a, payload, len) ||
+                    !mqtt_client_ping(c)) {
+                    sim_drop(sc);
+                    continue;
+                }
+                stats.presses++;
+            }
+        }
+
+        if (sc->telemetria_pendente || sc->pings == SIM_PINGS_MAX || now < sc->next_publish_us) continue;
+
+        float temp = 20.0f + (float)(sc->index % 10) + (float)(now % 100) / 100.0f;
+        len = payload_temperatura(&mqtt_topic_temperatura, temp, payload, sizeof(payload));
+        sim_ping_push(sc, now, false);
+        sc->telemetria_pendente = true;
+        mqtt_client_cork(c);
+        bool ok = true;
+        for (int b = 0; b < burst && ok; b++) {
+            ok = mqtt_client_publish_topic(c, &mqtt_topic_temperatura, payload, len);
+        }
+        if (!ok || !mqtt_client_ping(c)) {
+            sim_drop(sc);
+            continue;
+        }
+        stats.publishes += (uint32_t)burst;
+        sc->next_publish_us += (uint64_t)publish_interval_ms * 1000u;
+        if (sc->next_publish_us < now) sc->next_publish_us = now;
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    uint16_t port = (uint16_t)atoi(BROKER_PORT);
+    int n_clients = 1000;
+    int connect_rate = 0;              // 0 = todos de uma vez
+    uint32_t publish_interval_ms = 10000;
+    int duration_s = 60;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!strcmp(arg, "--verbose")) { verbose = true; continue; }
+        if (!val) { fprintf(stderr, "faltou o valor de %s\n", arg); return 1; }
+        if (!strcmp(arg, "--host")) host = val;
+        else if (!strcmp(arg, "--port")) port = (uint16_t)atoi(val);
+        else if (!strcmp(arg, "--clients")) n_clients = atoi(val);
+        else if (!strcmp(arg, "--connect-rate")) connect_rate = atoi(val);
+        else if (!strcmp(arg, "--publish-interval-ms")) publish_interval_ms = (uint32_t)atoi(val);
+        else if (!strcmp(arg, "--duration")) duration_s = atoi(val);
+        else if (!strcmp(arg, "--mqtt-version")) mqtt_version = (uint8_t)atoi(val);
+        else if (!strcmp(arg, "--burst")) burst = atoi(val);
+        else if (!strcmp(arg, "--press-interval-ms")) press_interval_ms = (uint32_t)atoi(val);
+        else if (!strcmp(arg, "--transporte") && !strcmp(val, "latencia")) transporte = PICO_NET_LATENCIA;
+        else if (!strcmp(arg, "--transporte") && !strcmp(val, "vazao")) transporte = PICO_NET_VAZAO;
+        else { fprintf(stderr, "opção desconhecida: %s\n", arg); return 1; }
+        i++;
+    }
+    if (n_clients <= 0 || duration_s <= 0 || publish_interval_ms == 0 || burst <= 0 ||
+        (mqtt_version != MQTT_VERSAO_311 && mqtt_version != MQTT_VERSAO_5)) {
+        fprintf(stderr, "parâmetros inválidos\n");
+        return 1;
+    }
+
+    // mqtt.c registra cada operação no stdout; o relatório vai por um descritor próprio
+    report = fdopen(dup(STDOUT_FILENO), "w");
+    if (!verbose && !freopen("/dev/null", "w", stdout)) {
+        perror("freopen");
+        return 1;
+    }
+
+    // Um descritor por cliente
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < (rlim_t)n_clients + 64) {
+        rl.rlim_cur = rl.rlim_max < (rlim_t)n_clients + 64 ? rl.rlim_max : (rlim_t)n_clients + 64;
+        setrlimit(RLIMIT_NOFILE, &rl);
+        if (rl.rlim_cur < (rlim_t)n_clients + 64) {
+            fprintf(report, "aviso: limite de descritores (%lu) menor que o número de clientes\n",
+                    (unsigned long)rl.rlim_cur);
+        }
+    }
+
+    if (!mqtt_init()) {
+        fprintf(report, "falha ao inicializar o mbedTLS\n");
+        return 1;
+    }
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    sim_client_t *clients = calloc((size_t)n_clients, sizeof(sim_client_t));
+    if (epfd < 0 || !clients) {
+        perror("init");
+        return 1;
+    }
+
+    fprintf(report, "Frota: %d clientes -> %s:%u | ritmo de conexão: %s | publicação a cada %u ms | %d s\n",
+            n_clients, host, port, connect_rate ? "limitado" : "todos de uma vez", publish_interval_ms, duration_s);
+    fprintf(report, "Transporte: %s | rajada: %d publicação(ões) | botão: %s\n",
+            transporte == PICO_NET_LATENCIA ? "latência (sem Nagle, registro por pacote)" :
+                                              "vazão (Nagle, registros de até um segmento)",
+            burst, press_interval_ms ? "sim" : "não");
+    fflush(report);
+
+    uint64_t t0 = time_us_64();
+    uint64_t t_end = t0 + (uint64_t)duration_s * 1000000u;
+    uint64_t next_start = t0;
+    uint64_t start_step = connect_rate > 0 ? 1000000u / (uint64_t)connect_rate : 0;
+    int started = 0;
+    uint32_t publishes_at_full = 0;
+    uint64_t t_full = 0;
+    struct epoll_event events[EPOLL_BATCH];
+
+    stats.first_start_us = t0;
+
+    while (time_us_64() < t_end) {
+        uint64_t now = time_us_64();
+        while (started < n_clients && now >= next_start) {
+            clients[started].index = started;
+            sim_start(&clients[started], host, port);
+            started++;
+            next_start += start_step;
+        }
+
+        int n = epoll_wait(epfd, events, EPOLL_BATCH, LOOP_TIMEOUT_MS);
+        if (n < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            sim_handle((sim_client_t *)events[i].data.ptr, publish_interval_ms);
+        }
+        sim_tick(clients, started, publish_interval_ms);
+
+        if (!t_full && started == n_clients && stats.connected + stats.failed >= (uint32_t)n_clients) {
+            // Fase de conexão encerrada: a vazão de publicação é medida a partir daqui
+            t_full = time_us_64();
+            publishes_at_full = stats.publishes;
+        }
+    }
+
+    uint64_t t_stop = time_us_64();
+    double connect_window_s = (stats.last_connect_us > stats.first_start_us ?
+                               stats.last_connect_us - stats.first_start_us : 1) / 1e6;
+    double steady_s = t_full ? (t_stop - t_full) / 1e6 : 0;
+
+    fprintf(report, "\n== Resultado ==\n");
+    fprintf(report, "conectados: %u | falhas de conexão: %u | quedas: %u\n",
+            stats.connected, stats.failed, stats.drops);
+    fprintf(report, "taxa de conexão: %.1f conexões/s (em %.2f s)\n", stats.connected / connect_window_s, connect_window_s);
+    if (steady_s > 0) {
+        fprintf(report, "vazão de publicação (regime): %.1f pub/s\n", (stats.publishes - publishes_at_full) / steady_s);
+    }
+    fprintf(report, "publicações totais: %u (%.1f pub/s na execução)\n", stats.publishes, stats.publishes / ((t_stop - t0) / 1e6));
+    samples_print("latência de conexão (TCP->CONNACK)", &stats.connect_lat);
+    samples_print("round-trip PUBLISH+PINGREQ->PINGRESP", &stats.publish_rtt);
+    if (press_interval_ms) {
+        fprintf(report, "eventos de botão: %u\n", stats.presses);
+        samples_print("botão->broker (evento+PINGREQ->PINGRESP)", &stats.press_lat);
+    }
+
+    // Economia dos aliases de tópico (MQTT 5) em relação ao mesmo tráfego em v3.1.1
+    int64_t saved = 0;
+    int v5_clients = 0;
+    for (int i = 0; i < started; i++) {
+        saved += clients[i].mqtt.bytes_saved;
+        v5_clients += clients[i].mqtt.protocol_version == MQTT_VERSAO_5;
+    }
+    fprintf(report, "clientes em MQTT 5: %d/%d | economia vs v3.1.1: %lld bytes (%.1f bytes/publicação)\n",
+            v5_clients, started, (long long)saved, stats.publishes ? (double)saved / stats.publishes : 0.0);
+
+    for (int i = 0; i < started; i++) {
+        sim_unwatch(&clients[i]);
+        mqtt_client_close(&clients[i].mqtt);
+    }
+    free(clients);
+    close(epfd);
+    return 0;
+}
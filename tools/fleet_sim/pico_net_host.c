@@ -0,0 +1,100 @@
+// Implementação de host da API de inc/pico_net.h (compilada com PICO_NET_HOST),
+// sobre sockets POSIX não-bloqueantes em vez de PCBs do lwIP. Permite que src/mqtt.c
+// rode sem alterações na simulação da frota.
+#include "pico_net.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "mbedtls/net_sockets.h"
+
+void pico_net_init(pico_net_context *ctx) {
+    ctx->fd = -1;
+    ctx->state = CONN_IDLE;
+    ctx->perfil = PICO_NET_VAZAO;
+}
+
+void pico_net_set_profile(pico_net_context *ctx, pico_net_perfil_t perfil) {
+    int nodelay = perfil == PICO_NET_LATENCIA;
+
+    ctx->perfil = perfil;
+    if (ctx->fd >= 0) setsockopt(ctx->fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+}
+
+bool pico_net_connect(pico_net_context *ctx, const char *host_ip, uint16_t port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host_ip, &addr.sin_addr) != 1) return false;
+
+    ctx->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (ctx->fd < 0) return false;
+    pico_net_set_profile(ctx, ctx->perfil);
+
+    ctx->state = CONN_CONNECTING;
+    if (connect(ctx->fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        ctx->state = CONN_CONNECTED;
+    } else if (errno != EINPROGRESS) {
+        ctx->state = CONN_FAILED;
+        pico_net_close(ctx);
+        return false;
+    }
+    return true;
+}
+
+void pico_net_host_update(pico_net_context *ctx) {
+    if (ctx->state != CONN_CONNECTING) return;
+
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(ctx->fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0) err = errno;
+
+    if (err == 0) {
+        ctx->state = CONN_CONNECTED;
+    } else if (err != EINPROGRESS) {
+        ctx->state = CONN_FAILED;
+    }
+}
+
+int pico_net_send(void *v_ctx, const unsigned char *buf, size_t len) {
+    pico_net_context *ctx = (pico_net_context *)v_ctx;
+
+    if (ctx->state != CONN_CONNECTED) return MBEDTLS_ERR_NET_CONN_RESET;
+
+    ssize_t n = send(ctx->fd, buf, len, MSG_NOSIGNAL);
+    if (n >= 0) return (int)n;
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return MBEDTLS_ERR_SSL_WANT_WRITE;
+    ctx->state = CONN_FAILED;
+    return MBEDTLS_ERR_NET_SEND_FAILED;
+}
+
+int pico_net_recv(void *v_ctx, unsigned char *buf, size_t len) {
+    pico_net_context *ctx = (pico_net_context *)v_ctx;
+
+    if (ctx->state != CONN_CONNECTED) return MBEDTLS_ERR_NET_CONN_RESET;
+
+    ssize_t n = recv(ctx->fd, buf, len, 0);
+    if (n > 0) return (int)n;
+    if (n == 0) {
+        ctx->state = CONN_CLOSING; // Fechada pelo broker
+        return MBEDTLS_ERR_NET_CONN_RESET;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return MBEDTLS_ERR_SSL_WANT_READ;
+    ctx->state = CONN_FAILED;
+    return MBEDTLS_ERR_NET_RECV_FAILED;
+}
+
+void pico_net_close(pico_net_context *ctx) {
+    if (ctx->fd >= 0) {
+        close(ctx->fd);
+        ctx->fd = -1;
+    }
+    ctx->state = CONN_IDLE;
+}
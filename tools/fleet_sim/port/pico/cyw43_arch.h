@@ -0,0 +1,10 @@
+// Substituto de host para pico/cyw43_arch.h. No host a rede é do kernel e
+// avança sozinha; o poll do cyw43 vira no-op.
+#ifndef FLEET_SIM_PICO_CYW43_ARCH_H
+#define FLEET_SIM_PICO_CYW43_ARCH_H
+
+#include "pico/stdlib.h"
+
+static inline void cyw43_arch_poll(void) {}
+
+#endif
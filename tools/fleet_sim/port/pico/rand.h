@@ -0,0 +1,12 @@
+// Substituto de host para pico/rand.h.
+#ifndef FLEET_SIM_PICO_RAND_H
+#define FLEET_SIM_PICO_RAND_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static inline uint32_t get_rand_32(void) {
+    return ((uint32_t)random() << 16) ^ (uint32_t)random();
+}
+
+#endif
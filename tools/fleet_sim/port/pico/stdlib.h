@@ -0,0 +1,34 @@
+// Substituto de host para pico/stdlib.h: apenas o subconjunto de tempo usado
+// pelos módulos do firmware compilados na simulação da frota.
+#ifndef FLEET_SIM_PICO_STDLIB_H
+#define FLEET_SIM_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef uint64_t absolute_time_t;
+
+static inline uint64_t time_us_64(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static inline uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+static inline absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return time_us_64() + (uint64_t)ms * 1000u;
+}
+
+static inline bool time_reached(absolute_time_t t) {
+    return time_us_64() >= t;
+}
+
+#endif
@@ -0,0 +1,312 @@
+/*
+ * mem_orcamento: orçamento de memória do firmware a partir do map do GNU ld
+ * (build/mqtt_with_psk.elf.map). Soma o uso de cada região (FLASH, RAM, SCRATCH_X/Y),
+ * separa a RAM por módulo (arquivo objeto, ou biblioteca para membros de .a), lista os
+ * pools fixos do modo estático (src/mem_diag.c, heap e memp do lwIP) e o que sobra para o
+ * heap.
+ *
+ * O build com ALOCACAO_ESTATICA roda esta ferramenta depois do link. Como nesse modo o
+ * malloc da newlib é bloqueado, o relatório é o orçamento inteiro da RAM.
+ *
+ *   mem_orcamento build/mqtt_with_psk.elf.map
+ *   mem_orcamento --top 30 build/mqtt_with_psk.elf.map
+ */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LINHA       4096
+#define MAX_NOME        256
+#define MAX_REGIOES     16
+#define TOP_PADRAO      15
+
+typedef struct {
+    char nome[32];
+    uint64_t origem, tamanho;
+    bool escrita;               // Atributo 'w': entra no detalhamento por módulo
+    uint64_t usado;
+} regiao_t;
+
+typedef struct {
+    char nome[MAX_NOME];
+    uint64_t total;
+    uint64_t bss;               // .bss/COMMON/NOLOAD: não ocupa a flash
+} modulo_t;
+
+typedef struct {
+    char nome[MAX_NOME];
+    uint64_t tamanho;
+} arena_t;
+
+static regiao_t regioes[MAX_REGIOES];
+static int n_regioes;
+
+static modulo_t *modulos;
+static int n_modulos, cap_modulos;
+
+static arena_t arenas[32];
+static int n_arenas;
+
+// Seções dos pools fixos: prefixo do nome e rótulo no relatório
+static const struct {
+    const char *prefixo;
+    const char *rotulo;
+} pools[] = {
+    { "mem_arena_", "" },               // src/mem_diag.c
+    { "ram_heap", "lwip_heap" },        // MEM_SIZE do lwIP
+    { "memp_memory_", "lwip_" },        // MEMP_NUM_* do lwIP
+};
+
+// Símbolos do linker script do SDK (memmap_default.ld); 0 = não encontrado
+static uint64_t sim_end, sim_heap_limite, sim_pilha_limite;
+
+static regiao_t *regiao_de(uint64_t addr) {
+    for (int i = 0; i < n_regioes; i++) {
+        if (addr >= regioes[i].origem && addr < regioes[i].origem + regioes[i].tamanho) return &regioes[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Nome do módulo a partir do caminho do objeto: "src/mqtt.c.obj" vira "mqtt.c" e
+ * "/.../libc_nano.a(lib_a-mallocr.o)" vira "libc_nano.a".
+ */
+static void modulo_nome(const char *arquivo, char *out, size_t len) {
+    char tmp[MAX_NOME];
+    snprintf(tmp, sizeof(tmp), "%s", arquivo);
+
+    char *par = strchr(tmp, '(');
+    if (par) *par = '\0';
+    char *barra = strrchr(tmp, '/');
+    const char *base = barra ? barra + 1 : tmp;
+    snprintf(out, len, "%s", base);
+
+    size_t n = strlen(out);
+    if (!par && n > 4 && !strcmp(out + n - 4, ".obj")) out[n - 4] = '\0';
+    else if (!par && n > 2 && !strcmp(out + n - 2, ".o")) out[n - 2] = '\0';
+}
+
+static bool modulo_soma(const char *arquivo, uint64_t tam, bool bss) {
+    char nome[MAX_NOME];
+    modulo_nome(arquivo, nome, sizeof(nome));
+
+    for (int i = 0; i < n_modulos; i++) {
+        if (!strcmp(modulos[i].nome, nome)) {
+            modulos[i].total += tam;
+            if (bss) modulos[i].bss += tam;
+            return true;
+        }
+    }
+    if (n_modulos == cap_modulos) {
+        int cap = cap_modulos ? cap_modulos * 2 : 64;
+        modulo_t *m = realloc(modulos, (size_t)cap * sizeof(*m));
+        if (!m) return false;
+        modulos = m;
+        cap_modulos = cap;
+    }
+    modulo_t *m = &modulos[n_modulos++];
+    snprintf(m->nome, sizeof(m->nome), "%s", nome);
+    m->total = tam;
+    m->bss = bss ? tam : 0;
+    return true;
+}
+
+static int modulo_cmp(const void *a, const void *b) {
+    const modulo_t *x = a, *y = b;
+    return x->total < y->total ? 1 : x->total > y->total ? -1 : strcmp(x->nome, y->nome);
+}
+
+/**
+ * @brief Linha da tabela "Memory Configuration": NOME ORIGEM TAMANHO [ATRIBUTOS].
+ */
+static void le_regiao(const char *linha) {
+    char nome[32], attr[16] = "";
+    uint64_t origem, tamanho;
+
+    if (sscanf(linha, "%31s %" SCNx64 " %" SCNx64 " %15s", nome, &origem, &tamanho, attr) < 3) return;
+    if (!strcmp(nome, "*default*") || n_regioes == MAX_REGIOES) return;
+
+    regiao_t *r = &regioes[n_regioes++];
+    snprintf(r->nome, sizeof(r->nome), "%s", nome);
+    r->origem = origem;
+    r->tamanho = tamanho;
+    r->escrita = strchr(attr, 'w') != NULL;
+}
+
+/**
+ * @brief Atribuição de símbolo: "   0x20001000   __end__ = ." (ou só o nome).
+ */
+static void le_simbolo(const char *linha) {
+    uint64_t addr;
+    char nome[MAX_NOME];
+
+    if (sscanf(linha, " 0x%" SCNx64 " %255s", &addr, nome) != 2) return;
+    if (!strcmp(nome, "__end__") || (!strcmp(nome, "end") && !sim_end)) sim_end = addr;
+    else if (!strcmp(nome, "__HeapLimit")) sim_heap_limite = addr;
+    else if (!strcmp(nome, "__StackLimit")) sim_pilha_limite = addr;
+}
+
+static void imprime(const char *arquivo, int top) {
+    printf("[ORÇAMENTO] %s\n", arquivo);
+    printf("[ORÇAMENTO] %-10s %10s %10s %7s\n", "região", "usado", "total", "uso");
+    for (int i = 0; i < n_regioes; i++) {
+        const regiao_t *r = &regioes[i];
+        printf("[ORÇAMENTO] %-10s %10" PRIu64 " %10" PRIu64 " %6.1f%%\n", r->nome, r->usado, r->tamanho,
+               r->tamanho ? 100.0 * (double)r->usado / (double)r->tamanho : 0.0);
+    }
+
+    uint64_t ram = 0;
+    for (int i = 0; i < n_modulos; i++) ram += modulos[i].total;
+    qsort(modulos, (size_t)n_modulos, sizeof(*modulos), modulo_cmp);
+
+    printf("[ORÇAMENTO] RAM estática por módulo (%d de %d):\n", n_modulos < top ? n_modulos : top, n_modulos);
+    uint64_t resto = ram;
+    for (int i = 0; i < n_modulos && i < top; i++) {
+        const modulo_t *m = &modulos[i];
+        printf("[ORÇAMENTO]   %-32s %8" PRIu64 " (%4.1f%%; .bss %" PRIu64 ")\n", m->nome, m->total,
+               ram ? 100.0 * (double)m->total / (double)ram : 0.0, m->bss);
+        resto -= m->total;
+    }
+    if (n_modulos > top) printf("[ORÇAMENTO]   %-32s %8" PRIu64 "\n", "(demais)", resto);
+    printf("[ORÇAMENTO]   %-32s %8" PRIu64 "\n", "total", ram);
+
+    if (n_arenas) {
+        uint64_t soma = 0;
+        printf("[ORÇAMENTO] Pools fixos:");
+        for (int i = 0; i < n_arenas; i++) {
+            printf(" %s %" PRIu64, arenas[i].nome, arenas[i].tamanho);
+            soma += arenas[i].tamanho;
+        }
+        printf(" = %" PRIu64 "\n", soma);
+    }
+
+    uint64_t limite = sim_heap_limite ? sim_heap_limite : sim_pilha_limite;
+    if (sim_end && limite > sim_end) {
+        printf("[ORÇAMENTO] Heap livre (end..%s): %" PRIu64 " bytes%s\n",
+               sim_heap_limite ? "__HeapLimit" : "__StackLimit", limite - sim_end,
+               n_arenas ? " (sem uso: malloc bloqueado)" : "");
+    } else {
+        printf("[ORÇAMENTO] Heap: símbolos end/__HeapLimit não encontrados no map\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *map_path = NULL;
+    int top = TOP_PADRAO;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--top") && i + 1 < argc) {
+            top = atoi(argv[++i]);
+        } else if (!map_path) {
+            map_path = argv[i];
+        } else {
+            map_path = NULL;
+            break;
+        }
+    }
+    if (!map_path || top <= 0) {
+        fprintf(stderr, "uso: mem_orcamento [--top N] FIRMWARE.map\n");
+        return 1;
+    }
+    FILE *f = fopen(map_path, "r");
+    if (!f) { perror(map_path); return 1; }
+
+    enum { ANTES, MEMORIA, MAPA } estado = ANTES;
+    char linha[MAX_LINHA];
+    char pendente[MAX_NOME] = "";   // Nome longo: o ld quebra a linha antes do endereço
+    bool pendente_saida = false;
+    regiao_t *saida = NULL;         // Região da seção de saída atual
+    bool saida_nobits = false;
+
+    while (fgets(linha, sizeof(linha), f)) {
+        linha[strcspn(linha, "\r\n")] = '\0';
+
+        if (estado == ANTES) {
+            if (!strcmp(linha, "Memory Configuration")) estado = MEMORIA;
+            continue;
+        }
+        if (estado == MEMORIA) {
+            if (!strcmp(linha, "Linker script and memory map")) estado = MAPA;
+            else if (strncmp(linha, "Name", 4) != 0) le_regiao(linha);
+            continue;
+        }
+
+        // Junta a continuação de um nome quebrado
+        char completa[MAX_LINHA + MAX_NOME];
+        const char *l = linha;
+        bool eh_saida;
+        if (pendente[0]) {
+            snprintf(completa, sizeof(completa), "%s%s%s", pendente_saida ? "" : " ", pendente, linha);
+            l = completa;
+            eh_saida = pendente_saida;
+            pendente[0] = '\0';
+        } else {
+            eh_saida = linha[0] == '.';
+        }
+
+        char nome[MAX_NOME], arquivo[MAX_NOME] = "";
+        uint64_t addr, tam;
+        int n = sscanf(l, " %255s 0x%" SCNx64 " 0x%" SCNx64 " %255[^\n]", nome, &addr, &tam, arquivo);
+
+        if (eh_saida) {
+            if (n == 1) {
+                snprintf(pendente, sizeof(pendente), "%s", nome);
+                pendente_saida = true;
+                continue;
+            }
+            saida = NULL;
+            if (n < 3 || tam == 0) continue;
+            saida = regiao_de(addr);
+            saida_nobits = strstr(nome, "bss") || strstr(nome, "heap") || strstr(nome, "stack");
+            if (saida) saida->usado += tam;
+            // .data e afins também ocupam a flash (endereço de carga). O ld imprime o
+            // endereço de carga até para o .bss, que não grava nada lá.
+            const char *carga = strstr(l, "load address ");
+            uint64_t lma;
+            if (!saida_nobits && carga && sscanf(carga, "load address 0x%" SCNx64, &lma) == 1) {
+                regiao_t *r = regiao_de(lma);
+                if (r && r != saida) r->usado += tam;
+            }
+            continue;
+        }
+
+        if (l[0] == ' ' && l[1] != ' ' && l[1] != '*' && l[1] != '\0') {
+            // Seção de entrada: " .bss.x  ENDEREÇO  TAMANHO  ARQUIVO"
+            if (n == 1) {
+                snprintf(pendente, sizeof(pendente), "%s", nome);
+                pendente_saida = false;
+                continue;
+            }
+            if (n < 4 || tam == 0 || !saida || !saida->escrita) continue;
+            bool bss = saida_nobits || !strncmp(nome, "COMMON", 6) || strstr(nome, ".bss");
+            if (!modulo_soma(arquivo, tam, bss)) {
+                fprintf(stderr, "mem_orcamento: sem memória\n");
+                return 1;
+            }
+            for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); i++) {
+                const char *a = strstr(nome, pools[i].prefixo);
+                if (!a || n_arenas >= (int)(sizeof(arenas) / sizeof(arenas[0]))) continue;
+                arena_t *r = &arenas[n_arenas++];
+                a += strlen(pools[i].prefixo);
+                size_t len = strlen(a);
+                if (len >= 5 && !strcmp(a + len - 5, "_base")) len -= 5;   // memp_memory_X_base
+                snprintf(r->nome, sizeof(r->nome), "%s%.*s", pools[i].rotulo, (int)len, a);
+                r->tamanho = tam;
+                break;
+            }
+            continue;
+        }
+        if (l[0] == ' ') le_simbolo(l);
+    }
+    fclose(f);
+
+    if (estado != MAPA || n_regioes == 0) {
+        fprintf(stderr, "%s: não parece um map do GNU ld (sem \"Memory Configuration\")\n", map_path);
+        return 1;
+    }
+    imprime(map_path, top);
+    return 0;
+}
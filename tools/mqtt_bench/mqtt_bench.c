@@ -0,0 +1,509 @@
+/*
+ * mqtt_bench: firmware de medição (alvo mqtt_bench do CMakeLists.txt raiz). Roda uma
+ * bateria fixa na própria placa, com os mesmos módulos do mqtt_with_psk, e imprime os
+ * resultados pela USB. Só existe para o RP2040: tudo o que mede depende do hardware.
+ *
+ * Bateria, nesta ordem (as medidas locais vêm antes de ligar o rádio):
+ *  - adc:    adc_read() bloqueante, FIFO em velocidade máxima e a leitura completa
+ *            de temperatura (read_onboard_temp_celsius, com a conversão em float);
+ *  - i2c:    ssd1306_show() do buffer inteiro, no barramento e endereço de main.c;
+ *  - cripto: AES-128-CBC e SHA-256 pela API do mbedTLS, ou seja, com os núcleos
+ *            _ALT de src/crypto_alt.c, como na sessão TLS;
+ *  - rede:   custo de uma chamada a cyw43_arch_poll() com o link ocioso;
+ *  - tls:    conexões completas (TCP, handshake TLS-PSK, CONNACK) ao broker de teste;
+ *  - publicacao: round-trip de um PUBLISH seguido de PINGREQ até o PINGRESP. O broker
+ *            trata os pacotes em ordem, então o PINGRESP só volta depois do PUBLISH.
+ *  - xip:    ciclos e faltas na cache XIP da composição da tela de status e da
+ *            publicação, a frio (cache invalidada antes) e a quente. xip.ram_quente diz
+ *            se o build tinha as funções quentes na SRAM (XIP_RAM_QUENTE, xip_cache.h).
+ *  - mem:    pico de heap de cada subsistema (lwIP, mbedTLS, display) ao longo da
+ *            bateria, o que inclui os handshakes, e a marca d'água da pilha do core 0.
+ *
+ * O broker de teste é MQTT_BENCH_HOST:MQTT_BENCH_PORTA (padrão: BROKER_HOST, de
+ * shared_vars.h), de preferência um mosquitto na mesma LAN com o PSK do dispositivo,
+ * para que a medida seja da placa e não da internet.
+ *
+ * Saída (uma linha por resultado, fácil de filtrar com grep "^@"):
+ *   @B <chave> <valor> <unidade>      resultado
+ *   @E <teste> <motivo>               teste que não pôde rodar
+ * Amostras repetidas viram três chaves: <chave>.min, <chave>.mediana e <chave>.max.
+ * A bateria começa com "@B bench.versao" e termina com "@B bench.erros".
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "pico/cyw43_arch.h"
+#include "hardware/adc.h"
+#include "hardware/i2c.h"
+#include "hardware/clocks.h"
+
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+
+#include "shared_vars.h"
+#include "wifi.h"
+#include "mqtt.h"
+#include "mqtt_topics.h"
+#include "temperature.h"
+#include "ssd1306.h"
+#include "device_state.h"
+#include "reconnect.h"
+#include "rng.h"
+#include "xip_cache.h"
+#include "mem_diag.h"
+#include "assets.h"
+
+#define MQTT_BENCH_VERSAO   1       // Muda quando chaves ou unidades mudarem
+
+#ifndef MQTT_BENCH_HOST
+#define MQTT_BENCH_HOST     BROKER_HOST
+#endif
+#ifndef MQTT_BENCH_PORTA
+#define MQTT_BENCH_PORTA    BROKER_PORT
+#endif
+#define MQTT_BENCH_TOPICO   "/" PSK_IDENTITY "/bench"
+
+#define BENCH_ADC_AMOSTRAS      20000
+#define BENCH_TEMP_LEITURAS     2000
+#define BENCH_FLUSHES           20
+#define BENCH_CRIPTO_BYTES      1024    // Dados por passada
+#define BENCH_CRIPTO_MIN_US     200000  // Tempo mínimo de cada medida de cripto
+#define BENCH_POLLS             2000
+#define BENCH_CONEXOES          5
+#define BENCH_PUBLICACOES       50
+#define BENCH_TELAS             50
+
+#define BENCH_WIFI_TIMEOUT_MS   30000
+#define BENCH_RTT_TIMEOUT_MS    2000
+
+// Display: os mesmos pinos, barramento e endereço de main.c
+#define I2C_SDA_PIN 14
+#define I2C_SCL_PIN 15
+#define I2C_BAUD    (400 * 1000)
+#define OLED_ADDR   0x3C
+
+MQTT_TOPIC_DEFINE(mqtt_topic_bench, MQTT_BENCH_TOPICO, MQTT_FORMATO_TEXTO);
+
+static int erros = 0;
+static volatile uint32_t sumidouro;     // Impede que o compilador descarte as leituras
+
+static uint8_t dados[BENCH_CRIPTO_BYTES];
+static uint8_t saida[BENCH_CRIPTO_BYTES];
+
+// --- Saída ---
+
+static void resultado(const char *chave, double valor, const char *unidade) {
+    printf("@B %s %.3f %s\n", chave, valor, unidade);
+}
+
+static void falha(const char *teste, const char *motivo) {
+    printf("@E %s %s\n", teste, motivo);
+    erros++;
+}
+
+static int compara_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Relata mínimo, mediana e máximo de n amostras em µs, divididas por 'escala'.
+ */
+static void resultado_amostras(const char *chave, uint32_t *us, int n, double escala, const char *unidade) {
+    char nome[64];
+
+    qsort(us, (size_t)n, sizeof(us[0]), compara_u32);
+    snprintf(nome, sizeof(nome), "%s.min", chave);
+    resultado(nome, us[0] / escala, unidade);
+    snprintf(nome, sizeof(nome), "%s.mediana", chave);
+    resultado(nome, us[n / 2] / escala, unidade);
+    snprintf(nome, sizeof(nome), "%s.max", chave);
+    resultado(nome, us[n - 1] / escala, unidade);
+}
+
+// --- ADC ---
+
+static void bench_adc(void) {
+    adc_init();
+    adc_set_temp_sensor_enabled(true);
+    adc_select_input(4);
+
+    // Conversão disparada e esperada a cada leitura (o caminho do firmware)
+    uint64_t t0 = time_us_64();
+    for (int i = 0; i < BENCH_ADC_AMOSTRAS; i++) sumidouro += adc_read();
+    uint64_t dt = time_us_64() - t0;
+    resultado("adc.adc_read", BENCH_ADC_AMOSTRAS * 1e6 / (double)dt, "amostras/s");
+
+    // Conversão contínua para a FIFO, com o divisor no mínimo (teto do hardware)
+    adc_fifo_setup(true, false, 1, false, false);
+    adc_set_clkdiv(0);
+    adc_fifo_drain();
+    adc_run(true);
+    sumidouro += adc_fifo_get_blocking();   // Descarta a primeira (conversão já em curso)
+    t0 = time_us_64();
+    for (int i = 0; i < BENCH_ADC_AMOSTRAS; i++) sumidouro += adc_fifo_get_blocking();
+    dt = time_us_64() - t0;
+    adc_run(false);
+    adc_fifo_drain();
+    adc_fifo_setup(false, false, 0, false, false);
+    resultado("adc.fifo", BENCH_ADC_AMOSTRAS * 1e6 / (double)dt, "amostras/s");
+
+    // Leitura completa de temperatura, como o canal do sensors.c faz
+    t0 = time_us_64();
+    for (int i = 0; i < BENCH_TEMP_LEITURAS; i++) {
+        float c = read_onboard_temp_celsius();
+        sumidouro += (uint32_t)c;
+    }
+    dt = time_us_64() - t0;
+    resultado("adc.temperatura", BENCH_TEMP_LEITURAS * 1e6 / (double)dt, "leituras/s");
+}
+
+// --- I2C / SSD1306 ---
+
+static void bench_display(void) {
+    ssd1306_t disp = { 0 };
+
+    uint baud = i2c_init(i2c1, I2C_BAUD);
+    gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA_PIN);
+    gpio_pull_up(I2C_SCL_PIN);
+    resultado("i2c.baud", baud, "Hz");
+
+    // Sem ACK no endereço do display, ssd1306_show() só mediria timeouts
+    static const uint8_t nop[] = { 0x00, 0xE3 };
+    if (i2c_write_blocking(i2c1, OLED_ADDR, nop, sizeof(nop), false) != (int)sizeof(nop)) {
+        falha("i2c", "display_ausente");
+        return;
+    }
+    if (!ssd1306_init(&disp, 128, 64, OLED_ADDR, i2c1)) {
+        falha("i2c", "sem_memoria");
+        return;
+    }
+
+    uint32_t us[BENCH_FLUSHES];
+    for (int i = 0; i < BENCH_FLUSHES; i++) {
+        memset(disp.buffer, i & 1 ? 0xAA : 0x55, disp.bufsize);
+        uint64_t t0 = time_us_64();
+        ssd1306_show(&disp);
+        us[i] = (uint32_t)(time_us_64() - t0);
+    }
+    resultado("i2c.ssd1306_show.bytes", (double)disp.bufsize, "bytes");
+    resultado_amostras("i2c.ssd1306_show", us, BENCH_FLUSHES, 1.0, "us");
+
+    ssd1306_clear(&disp);
+    ssd1306_show(&disp);
+    ssd1306_deinit(&disp);
+}
+
+// --- Cache XIP ---
+
+static void resultado_xip(const char *chave, const xip_regiao_t *r) {
+    const xip_soma_t *s = &r->soma[0];     // O bench não troca de clock: uma soma só
+    char nome[64];
+    double n = s->execucoes ? (double)s->execucoes : 1.0;
+
+    snprintf(nome, sizeof(nome), "%s.ciclos", chave);
+    resultado(nome, (double)s->ciclos / n, "ciclos");
+    snprintf(nome, sizeof(nome), "%s.acessos", chave);
+    resultado(nome, (double)s->acessos / n, "acessos");
+    snprintf(nome, sizeof(nome), "%s.faltas", chave);
+    resultado(nome, (double)s->faltas / n, "faltas");
+}
+
+/**
+ * @brief A tela de status do loop principal (main.c, passo 5), sem o envio pelo I2C.
+ */
+static void compoe_tela(ssd1306_t *t, float temperatura) {
+    char linha[32];
+
+    ssd1306_clear(t);
+    snprintf(linha, sizeof(linha), "IP: %s", "192.168.1.150");
+    ssd1306_draw_text(t, 0, 0, &fonte_5x8, linha);
+    ssd1306_draw_text(t, 0, 20, &fonte_5x8, "Temp:");
+    snprintf(linha, sizeof(linha), "%.2f°C", temperatura);
+    ssd1306_draw_text(t, 34, 16, &fonte_10x16, linha);
+    snprintf(linha, sizeof(linha), "MQTT: %s", "Conectado");
+    ssd1306_draw_text(t, 0, 32, &fonte_5x8, linha);
+    snprintf(linha, sizeof(linha), "BTNS: A:%s B:%s", "P", "S");
+    ssd1306_draw_text(t, 0, 48, &fonte_5x8, linha);
+}
+
+static void bench_xip_tela(void) {
+    static uint8_t buf[128 * 64 / 8];
+    ssd1306_t tela = { .width = 128, .height = 64, .pages = 8, .buffer = buf, .bufsize = sizeof(buf) };
+    xip_regiao_t frio = XIP_REGIAO("tela.frio"), quente = XIP_REGIAO("tela.quente");
+
+    for (int i = 0; i < BENCH_TELAS; i++) {
+        float t = 20.0f + (float)i / 8.0f;
+
+        xip_cache_flush();
+        xip_regiao_inicio(&frio);
+        compoe_tela(&tela, t);
+        xip_regiao_fim(&frio);
+
+        xip_regiao_inicio(&quente);
+        compoe_tela(&tela, t);
+        xip_regiao_fim(&quente);
+    }
+    resultado_xip("xip.tela.frio", &frio);
+    resultado_xip("xip.tela.quente", &quente);
+}
+
+// --- Criptografia ---
+
+typedef void (*cripto_fn)(size_t n);
+
+static mbedtls_aes_context aes;
+static mbedtls_sha256_context sha;
+
+static void aes_cbc(size_t n) {
+    uint8_t iv[16] = { 0 };
+    mbedtls_aes_crypt_cbc(&aes, MBEDTLS_AES_ENCRYPT, n, iv, dados, saida);
+}
+
+static void sha256(size_t n) {
+    mbedtls_sha256_update(&sha, dados, n);
+}
+
+/**
+ * @brief Roda 'fn' por pelo menos BENCH_CRIPTO_MIN_US e devolve bytes por segundo.
+ */
+static double medir_cripto(cripto_fn fn) {
+    uint64_t bytes = 0, t;
+
+    fn(BENCH_CRIPTO_BYTES);     // Aquece
+    uint64_t t0 = time_us_64();
+    do {
+        fn(BENCH_CRIPTO_BYTES);
+        bytes += BENCH_CRIPTO_BYTES;
+        t = time_us_64();
+    } while (t - t0 < BENCH_CRIPTO_MIN_US);
+    return (double)bytes * 1e6 / (double)(t - t0);
+}
+
+static void bench_cripto(void) {
+    static const uint8_t chave[16] = { 0 };
+    double hz = (double)clock_get_hz(clk_sys);
+
+    for (size_t i = 0; i < sizeof(dados); i++) dados[i] = (uint8_t)(i * 131u + 7u);
+
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, chave, 128);
+    double aes_bps = medir_cripto(aes_cbc);
+    mbedtls_aes_free(&aes);
+
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    double sha_bps = medir_cripto(sha256);
+    mbedtls_sha256_free(&sha);
+
+    resultado("cripto.aes128_cbc", aes_bps, "bytes/s");
+    resultado("cripto.aes128_cbc.ciclos", hz / aes_bps, "ciclos/byte");
+    resultado("cripto.sha256", sha_bps, "bytes/s");
+    resultado("cripto.sha256.ciclos", hz / sha_bps, "ciclos/byte");
+}
+
+// --- Rede ---
+
+/**
+ * @brief Associa ao AP (wifi.c, como no firmware). Retorna false no timeout.
+ */
+static bool rede_sobe(void) {
+    wifi_init();
+    wifi_connect_async();
+
+    uint64_t t0 = time_us_64();
+    absolute_time_t limite = make_timeout_time_ms(BENCH_WIFI_TIMEOUT_MS);
+    while (wifi_get_state() != WIFI_STATE_CONNECTED) {
+        if (time_reached(limite)) return false;
+        wifi_poll();
+        cyw43_arch_poll();
+        sleep_ms(1);
+    }
+    resultado("rede.wifi_ip", (time_us_64() - t0) / 1000.0, "ms");
+    return true;
+}
+
+static void bench_poll(void) {
+    uint32_t pior = 0;
+
+    // Link associado e sem tráfego: o que sobra é o custo fixo de cada volta do loop
+    uint64_t t0 = time_us_64();
+    for (int i = 0; i < BENCH_POLLS; i++) {
+        uint64_t t = time_us_64();
+        cyw43_arch_poll();
+        uint32_t d = (uint32_t)(time_us_64() - t);
+        if (d > pior) pior = d;
+    }
+    double media = (double)(time_us_64() - t0) / BENCH_POLLS;
+    resultado("rede.cyw43_poll.media", media, "us");
+    resultado("rede.cyw43_poll.max", pior, "us");
+}
+
+/**
+ * @brief Uma conexão completa, medindo cada etapa em µs desde o início.
+ */
+static bool conecta(mqtt_client_t *c, uint32_t *tcp_us, uint32_t *tls_us, uint32_t *connack_us) {
+    uint64_t t0 = time_us_64();
+    *tcp_us = *tls_us = 0;
+
+    if (!mqtt_client_start(c)) return false;
+    while (c->state != MQTT_STATE_CONNECTED && c->state != MQTT_STATE_FAILED) {
+        cyw43_arch_poll();
+        // O TCP fecha dentro do poll; o passo seguinte já começa o handshake
+        if (c->state == MQTT_STATE_TCP_CONNECTING && c->net.state == CONN_CONNECTED && !*tcp_us) {
+            *tcp_us = (uint32_t)(time_us_64() - t0);
+        }
+        mqtt_client_step(c);
+        if (c->state == MQTT_STATE_WAIT_CONNACK && !*tls_us) {
+            *tls_us = (uint32_t)(time_us_64() - t0);
+        }
+    }
+    *connack_us = (uint32_t)(time_us_64() - t0);
+    return c->state == MQTT_STATE_CONNECTED && *tcp_us && *tls_us;
+}
+
+static void bench_tls(mqtt_client_t *c) {
+    uint32_t tcp[BENCH_CONEXOES], tls[BENCH_CONEXOES], connack[BENCH_CONEXOES];
+    int n = 0;
+
+    // mqtt_client_start() fecha a sessão anterior; a última conexão fica para a publicação
+    mqtt_client_init(c, MQTT_BENCH_HOST, (uint16_t)atoi(MQTT_BENCH_PORTA), DEVICE_ID "-bench");
+    for (int tentativa = 0; n < BENCH_CONEXOES && tentativa < 2 * BENCH_CONEXOES; tentativa++) {
+        uint32_t t_tcp, t_tls, t_connack;
+        bool ok = conecta(c, &t_tcp, &t_tls, &t_connack);
+        if (!ok) {
+            // Recusado em MQTT 5: a próxima tentativa já sai em v3.1.1 (c->protocol_version)
+            continue;
+        }
+        tcp[n] = t_tcp;
+        tls[n] = t_tls - t_tcp;
+        connack[n] = t_connack;
+        n++;
+    }
+    if (n == 0) {
+        falha("tls", "broker_inacessivel");
+        return;
+    }
+    resultado("tls.conexoes", n, "conexoes");
+    resultado_amostras("tls.tcp", tcp, n, 1000.0, "ms");
+    resultado_amostras("tls.handshake", tls, n, 1000.0, "ms");
+    resultado_amostras("tls.connack", connack, n, 1000.0, "ms");
+}
+
+static void bench_publicacao(mqtt_client_t *c) {
+    static const uint8_t payload[] = "25.00";
+    uint32_t rtt[BENCH_PUBLICACOES];
+    int n = 0;
+    xip_regiao_t frio = XIP_REGIAO("publicacao.frio"), quente = XIP_REGIAO("publicacao.quente");
+
+    if (c->state != MQTT_STATE_CONNECTED) {
+        falha("publicacao", "sem_conexao");
+        return;
+    }
+    for (int i = 0; i < BENCH_PUBLICACOES; i++) {
+        // Publicações alternadas a frio e a quente; o perfil cobre só o PUBLISH
+        xip_regiao_t *perfil = i & 1 ? &quente : &frio;
+        if (perfil == &frio) xip_cache_flush();
+
+        uint64_t t0 = time_us_64();
+        xip_regiao_inicio(perfil);
+        bool ok = mqtt_client_publish_topic(c, &mqtt_topic_bench, payload, sizeof(payload) - 1);
+        xip_regiao_fim(perfil);
+        if (!ok || !mqtt_client_ping(c)) {
+            falha("publicacao", "escrita");
+            break;
+        }
+        absolute_time_t limite = make_timeout_time_ms(BENCH_RTT_TIMEOUT_MS);
+        int r = 0;
+        while (r == 0 && !time_reached(limite)) {
+            cyw43_arch_poll();
+            r = mqtt_client_process_input(c);
+        }
+        if (r <= 0) {
+            falha("publicacao", r < 0 ? "conexao_caiu" : "timeout");
+            break;
+        }
+        rtt[n++] = (uint32_t)(time_us_64() - t0);
+    }
+    if (n > 0) {
+        resultado("publicacao.amostras", n, "publicacoes");
+        resultado_amostras("publicacao.rtt", rtt, n, 1000.0, "ms");
+        resultado_xip("xip.publicacao.frio", &frio);
+        resultado_xip("xip.publicacao.quente", &quente);
+    }
+    mqtt_client_close(c);
+}
+
+// --- Memória ---
+
+static void bench_memoria(void) {
+    mem_diag_t d;
+    char nome[64];
+
+    mem_diag_snapshot(&d);
+    for (int s = 0; s < MEM_SUBSISTEMAS; s++) {
+        snprintf(nome, sizeof(nome), "mem.%s.pico", mem_diag_nome((mem_subsistema_t)s));
+        resultado(nome, d.sub[s].pico, "bytes");
+        if (d.sub[s].falhas) {
+            snprintf(nome, sizeof(nome), "mem.%s.falhas", mem_diag_nome((mem_subsistema_t)s));
+            resultado(nome, d.sub[s].falhas, "-");
+        }
+    }
+    resultado("mem.pico_total", d.pico_total, "bytes");
+    resultado("mem.heap.arena", d.heap_arena, "bytes");
+    resultado("mem.heap.total", d.heap_total, "bytes");
+    resultado("mem.pilha0.usado", d.pilha[0].usado, "bytes");
+    resultado("mem.pilha0.tamanho", d.pilha[0].tamanho, "bytes");
+}
+
+int main(void) {
+    static mqtt_client_t cliente;
+
+    mem_diag_init();
+    stdio_init_all();
+    device_state_init();
+
+    // A bateria roda uma vez; sem terminal aberto, a saída se perderia
+    while (!stdio_usb_connected()) sleep_ms(100);
+    sleep_ms(500);
+
+    printf("@B bench.versao %d -\n", MQTT_BENCH_VERSAO);
+    resultado("bench.clk_sys", (double)clock_get_hz(clk_sys), "Hz");
+    resultado("xip.ram_quente", XIP_RAM_QUENTE, "-");
+    xip_cache_init();
+
+    // Medidas locais primeiro, com o rádio ainda desligado
+    bench_adc();
+    bench_display();
+    bench_xip_tela();
+    bench_cripto();
+
+    if (!mqtt_init()) {
+        falha("tls", "cripto_init");
+    } else {
+        reconnect_init(&g_reconnect, reconnect_default_policies, rng_u32, NULL);
+        if (!rede_sobe()) {
+            falha("rede", "wifi_timeout");
+        } else {
+            bench_poll();
+            bench_tls(&cliente);
+            bench_publicacao(&cliente);
+        }
+    }
+    bench_memoria();
+
+    printf("@B bench.erros %d -\n", erros);
+
+    while (true) {
+        wifi_poll();
+        cyw43_arch_poll();
+        sleep_ms(10);
+    }
+}
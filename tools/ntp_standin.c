@@ -0,0 +1,130 @@
+/*
+ * ntp_standin: servidor SNTP mínimo (no host) para testar o src/time_sync.c sem
+ * depender de um servidor público.
+ *
+ * O relógio servido é o CLOCK_REALTIME do host, deslocado de --offset-ms e andando
+ * --drift-ppm mais rápido (ou mais devagar, se negativo) desde o início do programa.
+ * Assim dá para verificar se o firmware converge para o offset e estima a deriva.
+ * Com --drop P, descarta P% das consultas para exercitar timeout e nova tentativa.
+ *
+ * Aponte NTP_SERVIDOR/NTP_PORTA (shared_vars.h) para o IP do host e a porta usada.
+ *
+ * Uso: ntp_standin [--port N] [--offset-ms MS] [--drift-ppm PPM] [--drop P] [--stratum S]
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NTP_PACKET_LEN     48
+#define NTP_UNIX_OFFSET_S  2208988800ull
+
+typedef struct {
+    int port;
+    double offset_ms;
+    double drift_ppm;
+    int drop_pct;
+    int stratum;
+} standin_config_t;
+
+static int64_t start_real_us;
+
+static int64_t realtime_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Relógio servido: real + offset + deriva acumulada desde o início
+static int64_t served_us(const standin_config_t *cfg) {
+    int64_t now = realtime_us();
+    double drift_us = (double)(now - start_real_us) * cfg->drift_ppm / 1e6;
+    return now + (int64_t)(cfg->offset_ms * 1000.0 + drift_us);
+}
+
+static void put_ntp_ts(uint8_t *b, int64_t unix_us) {
+    uint64_t secs = (uint64_t)(unix_us / 1000000) + NTP_UNIX_OFFSET_S;
+    uint64_t frac = ((uint64_t)(unix_us % 1000000) << 32) / 1000000;
+    uint64_t v = (secs << 32) | frac;
+    for (int i = 0; i < 8; i++) b[i] = (uint8_t)(v >> (56 - 8 * i));
+}
+
+int main(int argc, char **argv) {
+    standin_config_t cfg = { .port = 1123, .offset_ms = 0, .drift_ppm = 0, .drop_pct = 0, .stratum = 2 };
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--port")) cfg.port = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--offset-ms")) cfg.offset_ms = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--drift-ppm")) cfg.drift_ppm = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--drop")) cfg.drop_pct = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--stratum")) cfg.stratum = atoi(argv[i + 1]);
+        else {
+            fprintf(stderr, "opção desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (cfg.port <= 0 || cfg.port > 65535 || cfg.drop_pct < 0 || cfg.drop_pct > 100 ||
+        cfg.stratum < 0 || cfg.stratum > 15) {
+        fprintf(stderr, "parâmetros inválidos\n");
+        return 1;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons((uint16_t)cfg.port),
+                                .sin_addr.s_addr = htonl(INADDR_ANY) };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        return 1;
+    }
+
+    start_real_us = realtime_us();
+    srand((unsigned)start_real_us);
+    printf("SNTP em UDP/%d | offset %.1f ms | deriva %.1f ppm | perda %d%% | stratum %d\n",
+           cfg.port, cfg.offset_ms, cfg.drift_ppm, cfg.drop_pct, cfg.stratum);
+
+    for (;;) {
+        uint8_t b[NTP_PACKET_LEN];
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+
+        ssize_t n = recvfrom(fd, b, sizeof(b), 0, (struct sockaddr *)&peer, &peer_len);
+        int64_t t2 = served_us(&cfg);
+        if (n < NTP_PACKET_LEN || (b[0] & 0x07) != 3) continue;
+
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &peer.sin_addr, ip, sizeof(ip));
+        if (rand() % 100 < cfg.drop_pct) {
+            printf("%s:%d consulta descartada\n", ip, ntohs(peer.sin_port));
+            continue;
+        }
+
+        uint8_t r[NTP_PACKET_LEN] = { 0 };
+        r[0] = (0 << 6) | (((b[0] >> 3) & 0x07) << 3) | 4;  // LI = 0, versão do cliente, modo 4
+        r[1] = (uint8_t)cfg.stratum;
+        r[2] = b[2];                                        // Poll: ecoa o do cliente
+        r[3] = (uint8_t)-20;                                // Precisão ~1 µs
+        memcpy(&r[12], "LOCL", 4);                          // Reference ID
+        put_ntp_ts(&r[16], t2);                             // Reference Timestamp
+        memcpy(&r[24], &b[40], 8);                          // Originate = Transmit do cliente
+        put_ntp_ts(&r[32], t2);                             // Receive Timestamp
+        put_ntp_ts(&r[40], served_us(&cfg));                // Transmit Timestamp
+
+        if (sendto(fd, r, sizeof(r), 0, (struct sockaddr *)&peer, peer_len) < 0) {
+            perror("sendto");
+            continue;
+        }
+        printf("%s:%d respondida | offset servido %+.3f ms\n", ip, ntohs(peer.sin_port),
+               (double)(t2 - realtime_us()) / 1000.0);
+        fflush(stdout);
+    }
+}
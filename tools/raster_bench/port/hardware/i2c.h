@@ -0,0 +1,23 @@
+// Substituto de host para hardware/i2c.h: o raster_bench só desenha no buffer, então
+// as escritas no barramento (ssd1306_show e comandos) não vão a lugar nenhum.
+#ifndef RASTER_BENCH_HARDWARE_I2C_H
+#define RASTER_BENCH_HARDWARE_I2C_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+
+typedef struct i2c_inst i2c_inst_t;
+
+static inline int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c;
+    (void)addr;
+    (void)src;
+    (void)nostop;
+    return (int)len;
+}
+
+#endif
@@ -0,0 +1,4 @@
+// Substituto de host para pico/binary_info.h (sem metadados no binário de host).
+#ifndef RASTER_BENCH_PICO_BINARY_INFO_H
+#define RASTER_BENCH_PICO_BINARY_INFO_H
+#endif
@@ -0,0 +1,432 @@
+/*
+ * raster_bench: vazão (pixels/s) das primitivas de desenho do src/ssd1306.c. Compara o
+ * rasterizador inteiro (spans com máscara, Bresenham) com as primitivas antigas, que
+ * continuam aqui como referência: linha com inclinação em float e retângulos pixel a pixel.
+ *
+ * Compila de duas formas:
+ *  - Firmware (alvo raster_bench do CMakeLists.txt raiz): roda no RP2040, onde o float
+ *    é emulado em software, e imprime o relatório pela USB a cada 10 s.
+ *  - Host (tools/CMakeLists.txt, RASTER_BENCH_HOST): mesmo código, com o i2c de mentira
+ *    de port/. Serve para conferir o rasterizador; os números que valem são os da placa.
+ *
+ * Antes de medir, confere as primitivas novas contra um desenho pixel a pixel, com
+ * recorte nas bordas e as três operações (set, clear, xor).
+ *
+ * Saída: uma linha "[BENCH] <primitiva> <implementação> <Mpixels/s>" por medida e o
+ * ganho do rasterizador novo sobre o antigo em cada primitiva.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ssd1306.h"
+
+#ifdef RASTER_BENCH_HOST
+#include <time.h>
+#else
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#endif
+
+#define BENCH_LARGURA      128
+#define BENCH_ALTURA       64
+#define BENCH_FORMAS       64       // Formas por passada
+#define BENCH_MIN_US       200000   // Tempo mínimo de cada medida
+#define BENCH_VERIFICACOES 2000     // Formas aleatórias (com recorte) por verificação
+
+static uint8_t buf[BENCH_LARGURA * BENCH_ALTURA / 8];
+static uint8_t buf_ref[sizeof(buf)];
+
+static ssd1306_t tela = {
+    .width = BENCH_LARGURA, .height = BENCH_ALTURA, .pages = BENCH_ALTURA / 8,
+    .buffer = buf, .bufsize = sizeof(buf),
+};
+static ssd1306_t ref = {
+    .width = BENCH_LARGURA, .height = BENCH_ALTURA, .pages = BENCH_ALTURA / 8,
+    .buffer = buf_ref, .bufsize = sizeof(buf_ref),
+};
+
+typedef struct {
+    int32_t x, y, x2, y2;       // Retângulos: x2/y2 são largura/altura
+} forma_t;
+
+static forma_t retangulos[BENCH_FORMAS], horizontais[BENCH_FORMAS], verticais[BENCH_FORMAS];
+static forma_t diagonais[BENCH_FORMAS];
+
+static uint32_t sorteio = 0x12345678;
+
+static uint32_t aleatorio(uint32_t n) {
+    sorteio ^= sorteio << 13;
+    sorteio ^= sorteio >> 17;
+    sorteio ^= sorteio << 5;
+    return sorteio % n;
+}
+
+static int32_t entre(int32_t a, int32_t b) {
+    return a + (int32_t)aleatorio((uint32_t)(b - a + 1));
+}
+
+// --- Relógio ---
+
+#ifdef RASTER_BENCH_HOST
+static uint64_t agora_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+#else
+static uint64_t agora_us(void) {
+    return time_us_64();
+}
+#endif
+
+// --- Primitivas antigas (referência de desempenho) ---
+
+static void legado_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    // As cargas de trabalho já vêm com x1 <= x2 (a troca de pontas antiga estava errada)
+    if (x1 == x2) {
+        if (y1 > y2) {
+            int32_t t = y1;
+            y1 = y2;
+            y2 = t;
+        }
+        for (int32_t i = y1; i <= y2; ++i) ssd1306_draw_pixel(p, (uint32_t)x1, (uint32_t)i);
+        return;
+    }
+
+    float m = (float)(y2 - y1) / (float)(x2 - x1);
+
+    for (int32_t i = x1; i <= x2; ++i) {
+        float y = m * (float)(i - x1) + (float)y1;
+        ssd1306_draw_pixel(p, (uint32_t)i, (uint32_t)y);
+    }
+}
+
+static void legado_draw_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    for (uint32_t i = 0; i < width; ++i)
+        for (uint32_t j = 0; j < height; ++j) ssd1306_draw_pixel(p, x + i, y + j);
+}
+
+static void legado_clear_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    for (uint32_t i = 0; i < width; ++i)
+        for (uint32_t j = 0; j < height; ++j) ssd1306_clear_pixel(p, x + i, y + j);
+}
+
+static void legado_draw_empty_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    legado_draw_line(p, (int32_t)x, (int32_t)y, (int32_t)(x + width), (int32_t)y);
+    legado_draw_line(p, (int32_t)x, (int32_t)(y + height), (int32_t)(x + width), (int32_t)(y + height));
+    legado_draw_line(p, (int32_t)x, (int32_t)y, (int32_t)x, (int32_t)(y + height));
+    legado_draw_line(p, (int32_t)(x + width), (int32_t)y, (int32_t)(x + width), (int32_t)(y + height));
+}
+
+// --- Cargas medidas: uma passada sobre as formas; retornam os pixels desenhados ---
+
+typedef uint32_t (*bench_fn)(void);
+
+static uint32_t pixels_linha(const forma_t *f) {
+    return (uint32_t)(abs(f->x2 - f->x) > abs(f->y2 - f->y) ? abs(f->x2 - f->x) : abs(f->y2 - f->y)) + 1;
+}
+
+static uint32_t passada_linhas(const forma_t *formas, bool novo) {
+    uint32_t px = 0;
+    for (int i = 0; i < BENCH_FORMAS; i++) {
+        const forma_t *f = &formas[i];
+        if (novo) {
+            ssd1306_draw_line(&tela, f->x, f->y, f->x2, f->y2);
+        } else {
+            legado_draw_line(&tela, f->x, f->y, f->x2, f->y2);
+        }
+        px += pixels_linha(f);
+    }
+    return px;
+}
+
+static uint32_t horizontal_novo(void)   { return passada_linhas(horizontais, true); }
+static uint32_t horizontal_legado(void) { return passada_linhas(horizontais, false); }
+static uint32_t vertical_novo(void)     { return passada_linhas(verticais, true); }
+static uint32_t vertical_legado(void)   { return passada_linhas(verticais, false); }
+static uint32_t diagonal_novo(void)     { return passada_linhas(diagonais, true); }
+static uint32_t diagonal_legado(void)   { return passada_linhas(diagonais, false); }
+
+static uint32_t preenche_novo(void) {
+    uint32_t px = 0;
+    for (int i = 0; i < BENCH_FORMAS; i++) {
+        const forma_t *f = &retangulos[i];
+        ssd1306_draw_square(&tela, (uint32_t)f->x, (uint32_t)f->y, (uint32_t)f->x2, (uint32_t)f->y2);
+        px += (uint32_t)(f->x2 * f->y2);
+    }
+    return px;
+}
+
+static uint32_t preenche_legado(void) {
+    uint32_t px = 0;
+    for (int i = 0; i < BENCH_FORMAS; i++) {
+        const forma_t *f = &retangulos[i];
+        legado_draw_square(&tela, (uint32_t)f->x, (uint32_t)f->y, (uint32_t)f->x2, (uint32_t)f->y2);
+        px += (uint32_t)(f->x2 * f->y2);
+    }
+    return px;
+}
+
+static uint32_t limpa_novo(void) {
+    uint32_t px = 0;
+    for (int i = 0; i < BENCH_FORMAS; i++) {
+        const forma_t *f = &retangulos[i];
+        ssd1306_clear_square(&tela, (uint32_t)f->x, (uint32_t)f->y, (uint32_t)f->x2, (uint32_t)f->y2);
+        px += (uint32_t)(f->x2 * f->y2);
+    }
+    return px;
+}
+
+static uint32_t limpa_legado(void) {
+    uint32_t px = 0;
+    for (int i = 0; i < BENCH_FORMAS; i++) {
+        const forma_t *f = &retangulos[i];
+        legado_clear_square(&tela, (uint32_t)f->x, (uint32_t)f->y, (uint32_t)f->x2, (uint32_t)f->y2);
+        px += (uint32_t)(f->x2 * f->y2);
+    }
+    return px;
+}
+
+static uint32_t inverte_novo(void) {
+    uint32_t px = 0;
+    for (int i = 0; i < BENCH_FORMAS; i++) {
+        const forma_t *f = &retangulos[i];
+        ssd1306_fill_rect(&tela, f->x, f->y, (uint32_t)f->x2, (uint32_t)f->y2, SSD1306_OP_XOR);
+        px += (uint32_t)(f->x2 * f->y2);
+    }
+    return px;
+}
+
+static uint32_t contorno_novo(void) {
+    uint32_t px = 0;
+    for (int i = 0; i < BENCH_FORMAS; i++) {
+        const forma_t *f = &retangulos[i];
+        ssd1306_draw_empty_square(&tela, (uint32_t)f->x, (uint32_t)f->y, (uint32_t)f->x2 - 1, (uint32_t)f->y2 - 1);
+        px += (uint32_t)(2 * (f->x2 + f->y2) - 4);
+    }
+    return px;
+}
+
+static uint32_t contorno_legado(void) {
+    uint32_t px = 0;
+    for (int i = 0; i < BENCH_FORMAS; i++) {
+        const forma_t *f = &retangulos[i];
+        legado_draw_empty_square(&tela, (uint32_t)f->x, (uint32_t)f->y, (uint32_t)f->x2 - 1, (uint32_t)f->y2 - 1);
+        px += (uint32_t)(2 * (f->x2 + f->y2) - 4);
+    }
+    return px;
+}
+
+/**
+ * @brief Roda 'fn' por pelo menos BENCH_MIN_US e devolve milhões de pixels por segundo.
+ */
+static double medir(bench_fn fn) {
+    uint64_t pixels = 0;
+
+    fn();   // Aquece
+    uint64_t t0 = agora_us(), t;
+    do {
+        pixels += fn();
+        t = agora_us();
+    } while (t - t0 < BENCH_MIN_US);
+    return (double)pixels / (double)(t - t0);
+}
+
+static void relata(const char *primitiva, const char *impl, double mpx) {
+    printf("[BENCH] %-10s %-7s %8.2f Mpixels/s\n", primitiva, impl, mpx);
+}
+
+static void compara(const char *primitiva, bench_fn legado, bench_fn novo) {
+    double a = medir(legado), b = medir(novo);
+    relata(primitiva, "legado", a);
+    relata(primitiva, "novo", b);
+    printf("[BENCH] %-10s ganho   %8.1fx\n", primitiva, b / a);
+}
+
+// --- Verificação ---
+
+static void ref_pixel(int32_t x, int32_t y, ssd1306_op_t op) {
+    if (x < 0 || y < 0 || x >= BENCH_LARGURA || y >= BENCH_ALTURA) return;
+    uint8_t *b = &buf_ref[x + BENCH_LARGURA * (y >> 3)];
+    uint8_t m = (uint8_t)(1u << (y & 7));
+    switch (op) {
+    case SSD1306_OP_SET:   *b |= m; break;
+    case SSD1306_OP_CLEAR: *b &= (uint8_t)~m; break;
+    default:               *b ^= m; break;
+    }
+}
+
+static void ref_retangulo(int32_t x, int32_t y, int32_t w, int32_t h, ssd1306_op_t op) {
+    for (int32_t i = 0; i < w; i++)
+        for (int32_t j = 0; j < h; j++) ref_pixel(x + i, y + j, op);
+}
+
+// Bresenham de livro, pixel a pixel: o rasterizador tem de acender exatamente estes pontos
+static void ref_linha(int32_t x1, int32_t y1, int32_t x2, int32_t y2, ssd1306_op_t op) {
+    int32_t dx = abs(x2 - x1), dy = abs(y2 - y1);
+    int32_t sx = x1 < x2 ? 1 : -1, sy = y1 < y2 ? 1 : -1;
+    int32_t err = dx - dy;
+    for (;;) {
+        ref_pixel(x1, y1, op);
+        if (x1 == x2 && y1 == y2) break;
+        int32_t e2 = 2 * err;
+        if (e2 > -dy) { err -= dy; x1 += sx; }
+        if (e2 < dx) { err += dx; y1 += sy; }
+    }
+}
+
+static void embaralha(void) {
+    for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)aleatorio(256);
+    memcpy(buf_ref, buf, sizeof(buf));
+}
+
+static int acesos(const uint8_t *b) {
+    int n = 0;
+    for (size_t i = 0; i < sizeof(buf); i++) n += __builtin_popcount(b[i]);
+    return n;
+}
+
+/**
+ * @brief Confere as primitivas novas. Retorna o número de divergências.
+ */
+static int verificar(void) {
+    int falhas = 0;
+
+    for (int i = 0; i < BENCH_VERIFICACOES; i++) {
+        ssd1306_op_t op = (ssd1306_op_t)(i % 3);
+
+        // Retângulos que cruzam as bordas, inclusive com largura/altura zero
+        int32_t x = entre(-40, BENCH_LARGURA + 8), y = entre(-40, BENCH_ALTURA + 8);
+        int32_t w = entre(0, 100), h = entre(0, 80);
+        embaralha();
+        ssd1306_fill_rect(&tela, x, y, (uint32_t)w, (uint32_t)h, op);
+        ref_retangulo(x, y, w, h, op);
+        falhas += memcmp(buf, buf_ref, sizeof(buf)) != 0;
+
+        embaralha();
+        ssd1306_draw_rect(&tela, x, y, (uint32_t)w, (uint32_t)h, op);
+        if (w && h) {
+            ref_retangulo(x, y, w, 1, op);
+            if (h > 1) ref_retangulo(x, y + h - 1, w, 1, op);
+            ref_retangulo(x, y + 1, 1, h - 2, op);
+            if (w > 1) ref_retangulo(x + w - 1, y + 1, 1, h - 2, op);
+        }
+        falhas += memcmp(buf, buf_ref, sizeof(buf)) != 0;
+
+        // Linhas em todos os octantes, com pontas fora da tela
+        int32_t x1 = entre(-30, BENCH_LARGURA + 30), y1 = entre(-30, BENCH_ALTURA + 30);
+        int32_t x2 = entre(-30, BENCH_LARGURA + 30), y2 = entre(-30, BENCH_ALTURA + 30);
+        if (i % 7 == 0) y2 = y1;
+        if (i % 11 == 0) x2 = x1;
+        embaralha();
+        ssd1306_draw_line_op(&tela, x1, y1, x2, y2, op);
+        ref_linha(x1, y1, x2, y2, op);
+        falhas += memcmp(buf, buf_ref, sizeof(buf)) != 0;
+
+        // XOR duas vezes devolve o buffer original
+        if (op == SSD1306_OP_XOR) {
+            ssd1306_draw_line_op(&tela, x1, y1, x2, y2, op);
+            ssd1306_fill_rect(&tela, x, y, (uint32_t)w, (uint32_t)h, op);
+            ssd1306_fill_rect(&tela, x, y, (uint32_t)w, (uint32_t)h, op);
+            ref_linha(x1, y1, x2, y2, op);
+            falhas += memcmp(buf, buf_ref, sizeof(buf)) != 0;
+        }
+    }
+
+    // Linhas inteiras na tela: sem falhas, um pixel por passo do eixo maior
+    for (int i = 0; i < BENCH_VERIFICACOES; i++) {
+        forma_t f = { entre(0, BENCH_LARGURA - 1), entre(0, BENCH_ALTURA - 1),
+                      entre(0, BENCH_LARGURA - 1), entre(0, BENCH_ALTURA - 1) };
+        ssd1306_clear(&tela);
+        ssd1306_draw_line(&tela, f.x, f.y, f.x2, f.y2);
+        falhas += acesos(buf) != (int)pixels_linha(&f);
+    }
+
+    // As funções antigas mantêm o desenho de antes (linhas retas e retângulos)
+    for (int i = 0; i < BENCH_VERIFICACOES; i++) {
+        uint32_t x = (uint32_t)entre(0, BENCH_LARGURA + 8), y = (uint32_t)entre(0, BENCH_ALTURA + 8);
+        uint32_t w = (uint32_t)entre(0, 80), h = (uint32_t)entre(0, 40);
+        embaralha();
+        memcpy(buf_ref, buf, sizeof(buf));
+        ssd1306_draw_square(&tela, x, y, w, h);
+        legado_draw_square(&ref, x, y, w, h);
+        falhas += memcmp(buf, buf_ref, sizeof(buf)) != 0;
+        ssd1306_clear_square(&tela, x, y, w, h);
+        legado_clear_square(&ref, x, y, w, h);
+        falhas += memcmp(buf, buf_ref, sizeof(buf)) != 0;
+        ssd1306_draw_empty_square(&tela, x, y, w, h);
+        legado_draw_empty_square(&ref, x, y, w, h);
+        falhas += memcmp(buf, buf_ref, sizeof(buf)) != 0;
+    }
+    return falhas;
+}
+
+// --- Relatório ---
+
+static void roda(void) {
+    int falhas = verificar();
+    if (falhas) {
+        printf("[BENCH] ERRO: %d divergências na verificação; medidas descartadas.\n", falhas);
+        return;
+    }
+    printf("[BENCH] Verificação ok.\n");
+
+    ssd1306_clear(&tela);
+    compara("retangulo", preenche_legado, preenche_novo);
+    compara("limpa", limpa_legado, limpa_novo);
+    compara("contorno", contorno_legado, contorno_novo);
+    compara("linha_h", horizontal_legado, horizontal_novo);
+    compara("linha_v", vertical_legado, vertical_novo);
+    compara("linha", diagonal_legado, diagonal_novo);
+    relata("inverte", "novo", medir(inverte_novo));
+}
+
+/**
+ * @brief Formas inteiras dentro da tela (a medida não inclui recorte), com x1 <= x2
+ * nas linhas para que a versão antiga desenhe a linha certa.
+ */
+static void prepara(void) {
+    for (int i = 0; i < BENCH_FORMAS; i++) {
+        forma_t *r = &retangulos[i];
+        r->x2 = entre(2, 64);
+        r->y2 = entre(2, 32);
+        r->x = entre(0, BENCH_LARGURA - r->x2);
+        r->y = entre(0, BENCH_ALTURA - r->y2);
+
+        forma_t *h = &horizontais[i];
+        h->x = entre(0, BENCH_LARGURA / 2);
+        h->x2 = entre(h->x + 1, BENCH_LARGURA - 1);
+        h->y = h->y2 = entre(0, BENCH_ALTURA - 1);
+
+        forma_t *v = &verticais[i];
+        v->x = v->x2 = entre(0, BENCH_LARGURA - 1);
+        v->y = entre(0, BENCH_ALTURA / 2);
+        v->y2 = entre(v->y + 1, BENCH_ALTURA - 1);
+
+        forma_t *d = &diagonais[i];
+        d->x = entre(0, BENCH_LARGURA / 2);
+        d->x2 = entre(d->x + 1, BENCH_LARGURA - 1);
+        d->y = entre(0, BENCH_ALTURA - 1);
+        d->y2 = entre(0, BENCH_ALTURA - 1);
+    }
+}
+
+int main(void) {
+#ifdef RASTER_BENCH_HOST
+    prepara();
+    roda();
+    return 0;
+#else
+    stdio_init_all();
+    sleep_ms(3000);     // Tempo para abrir o terminal USB
+    prepara();
+    printf("[BENCH] clk_sys %lu Hz\n", (unsigned long)clock_get_hz(clk_sys));
+    while (true) {
+        roda();
+        sleep_ms(10000);
+    }
+#endif
+}
@@ -0,0 +1,174 @@
+/*
+ * reconnect_sim: simulação (no host) de uma frota reconectando após um restart do broker.
+ *
+ * Compara a política antiga (tentativa imediata após a queda e depois a cada 10 s fixos)
+ * com o motor de reconexão do firmware (src/reconnect.c, compilado sem alterações).
+ *
+ * Modelo:
+ *  - No instante 0 o broker reinicia e todos os dispositivos perdem a conexão.
+ *  - Durante --down segundos o broker recusa conexões TCP (falha de classe TCP).
+ *  - Depois, aceita no máximo --rate handshakes TLS por segundo; o excedente
+ *    expira no handshake (falha de classe TLS), como acontece no servidor real.
+ *
+ * Uso: reconnect_sim [--devices N] [--rate HS_POR_S] [--down S] [--duration S] [--seed X]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "reconnect.h"
+
+#define TICK_MS        100
+#define BIN_S          5      // Largura de cada barra do gráfico
+#define LEGACY_RETRY_MS 10000 // MQTT_RECONNECT_INTERVAL_MS da versão antiga
+
+typedef struct {
+    uint32_t next_ms;     // Próxima tentativa
+    bool connected;
+    reconnect_t rc;
+    uint32_t rng_state;
+} device_t;
+
+typedef struct {
+    int devices;
+    int rate;
+    int down_s;
+    int duration_s;
+    uint32_t seed;
+} sim_config_t;
+
+typedef struct {
+    uint32_t *attempts_per_s;
+    uint32_t *connected_per_s;
+    uint32_t peak_attempts;
+    uint32_t total_attempts;
+    int all_connected_s;   // -1 se a frota não reconectou dentro da duração
+} sim_result_t;
+
+// xorshift32: um gerador independente por dispositivo, como o DRBG de cada placa
+static uint32_t sim_rand(void *ctx) {
+    uint32_t *s = (uint32_t *)ctx;
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+static void sim_run(const sim_config_t *cfg, bool legacy, sim_result_t *res) {
+    device_t *dev = calloc(cfg->devices, sizeof(device_t));
+    res->attempts_per_s = calloc(cfg->duration_s, sizeof(uint32_t));
+    res->connected_per_s = calloc(cfg->duration_s, sizeof(uint32_t));
+    res->peak_attempts = 0;
+    res->total_attempts = 0;
+    res->all_connected_s = -1;
+
+    for (int i = 0; i < cfg->devices; i++) {
+        dev[i].rng_state = cfg->seed ^ (0x9E3779B9u * (uint32_t)(i + 1));
+        if (dev[i].rng_state == 0) dev[i].rng_state = 1;
+        reconnect_init(&dev[i].rc, reconnect_default_policies, sim_rand, &dev[i].rng_state);
+        // Queda simultânea no instante 0
+        dev[i].next_ms = legacy ? 0 : reconnect_on_drop(&dev[i].rc);
+    }
+
+    const uint32_t duration_ms = (uint32_t)cfg->duration_s * 1000;
+    const uint32_t down_ms = (uint32_t)cfg->down_s * 1000;
+    uint32_t accepted_this_s = 0;
+    uint32_t connected = 0;
+
+    for (uint32_t now = 0; now < duration_ms; now += TICK_MS) {
+        uint32_t sec = now / 1000;
+        if (now % 1000 == 0) accepted_this_s = 0;
+
+        for (int i = 0; i < cfg->devices; i++) {
+            device_t *d = &dev[i];
+            if (d->connected || d->next_ms > now) continue;
+
+            res->attempts_per_s[sec]++;
+            res->total_attempts++;
+
+            reconnect_class_t cls;
+            if (now < down_ms) {
+                cls = RECONNECT_TCP;
+            } else if (accepted_this_s < (uint32_t)cfg->rate) {
+                accepted_this_s++;
+                d->connected = true;
+                connected++;
+                reconnect_reset(&d->rc, RECONNECT_TCP);
+                reconnect_reset(&d->rc, RECONNECT_TLS);
+                continue;
+            } else {
+                cls = RECONNECT_TLS;
+            }
+            d->next_ms = now + (legacy ? LEGACY_RETRY_MS : reconnect_on_failure(&d->rc, cls));
+        }
+
+        if (now % 1000 == 1000 - TICK_MS) {
+            res->connected_per_s[sec] = connected;
+            if (res->attempts_per_s[sec] > res->peak_attempts) res->peak_attempts = res->attempts_per_s[sec];
+            if (connected == (uint32_t)cfg->devices && res->all_connected_s < 0) res->all_connected_s = (int)sec + 1;
+        }
+    }
+    free(dev);
+}
+
+static void sim_print(const sim_config_t *cfg, const char *name, const sim_result_t *res) {
+    printf("\n== %s ==\n", name);
+    printf("tentativas totais: %u | pico: %u tentativas/s | frota reconectada em: ",
+           res->total_attempts, res->peak_attempts);
+    if (res->all_connected_s >= 0) printf("%d s\n", res->all_connected_s);
+    else printf("> %d s\n", cfg->duration_s);
+
+    // Curva do pico de tentativas por segundo em cada barra e dispositivos conectados
+    uint32_t scale = res->peak_attempts > 60 ? (res->peak_attempts + 59) / 60 : 1;
+    printf("   t(s)  pico tent/s  conectados  (cada '#' = %u tent/s)\n", scale);
+    for (int b = 0; b * BIN_S < cfg->duration_s; b++) {
+        uint32_t sum = 0, peak = 0;
+        int end = (b + 1) * BIN_S < cfg->duration_s ? (b + 1) * BIN_S : cfg->duration_s;
+        for (int s = b * BIN_S; s < end; s++) {
+            sum += res->attempts_per_s[s];
+            if (res->attempts_per_s[s] > peak) peak = res->attempts_per_s[s];
+        }
+        printf("  %5d  %11u  %10u  ", b * BIN_S, peak, res->connected_per_s[end - 1]);
+        for (uint32_t k = 0; k < (peak + scale - 1) / scale; k++) putchar('#');
+        putchar('\n');
+        if (res->connected_per_s[end - 1] == (uint32_t)cfg->devices && sum == 0) break;
+    }
+}
+
+int main(int argc, char **argv) {
+    sim_config_t cfg = { .devices = 2000, .rate = 50, .down_s = 10, .duration_s = 600, .seed = 12345 };
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--devices")) cfg.devices = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--rate")) cfg.rate = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--down")) cfg.down_s = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--duration")) cfg.duration_s = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--seed")) cfg.seed = (uint32_t)strtoul(argv[i + 1], NULL, 0);
+        else {
+            fprintf(stderr, "opção desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (cfg.devices <= 0 || cfg.rate <= 0 || cfg.duration_s <= 0) {
+        fprintf(stderr, "parâmetros inválidos\n");
+        return 1;
+    }
+
+    printf("Frota: %d dispositivos | broker fora do ar por %d s | capacidade: %d handshakes/s\n",
+           cfg.devices, cfg.down_s, cfg.rate);
+
+    sim_result_t legacy, backoff;
+    sim_run(&cfg, true, &legacy);
+    sim_run(&cfg, false, &backoff);
+    sim_print(&cfg, "Politica antiga (imediato + 10 s fixos)", &legacy);
+    sim_print(&cfg, "Backoff exponencial com jitter (src/reconnect.c)", &backoff);
+
+    free(legacy.attempts_per_s);
+    free(legacy.connected_per_s);
+    free(backoff.attempts_per_s);
+    free(backoff.connected_per_s);
+    return 0;
+}
@@ -0,0 +1,395 @@
+/*
+ * ssd1306_assets: converte imagens BMP e fontes BDF para o formato nativo do SSD1306
+ * (page-major: páginas de 8 linhas, um byte por coluna, bit 0 na linha de cima), gerando
+ * um par .c/.h com ssd1306_imagem_t e ssd1306_fonte_t (inc/ssd1306.h). Roda no build do
+ * firmware (CMakeLists.txt, alvo "assets"); no firmware, desenhar uma imagem de tela cheia
+ * vira um memcpy e os caracteres são copiados por coluna, sem interpretar bit a bit.
+ *
+ * Imagens: BMP de 1 bit (paleta) ou de 24/32 bits sem compressão. Como no antigo
+ * ssd1306_bmp_show_image(), os pixels pretos acendem.
+ * Fontes: BDF (X11). TTF/OTF: converta antes, no tamanho desejado (ex.: otf2bdf -p 12).
+ * O sufixo ":N" gera uma cópia da fonte ampliada N vezes aqui, no build, para que o
+ * firmware não precise escalar nada.
+ *
+ * Uso: ssd1306_assets -o SAIDA [--fonte NOME=ARQ.bdf[:N]]... [--imagem NOME=ARQ.bmp]...
+ *      (gera SAIDA.c e SAIDA.h)
+ */
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ASSETS   16
+#define MAX_CHARS    256
+#define MAX_DIM      255
+
+typedef struct {
+    const char *nome;
+    const char *arquivo;
+    int escala;                 // Só para fontes
+    bool fonte;
+} asset_t;
+
+// Bitmap monocromático de trabalho: um byte por pixel
+typedef struct {
+    int largura, altura;
+    uint8_t *px;
+} bitmap_t;
+
+static uint32_t le(const uint8_t *p, int n) {
+    uint32_t v = 0;
+    for (int i = n - 1; i >= 0; i--) v = v << 8 | p[i];
+    return v;
+}
+
+static uint8_t *ler_arquivo(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) { perror(path); return NULL; }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = malloc((size_t)n + 1);
+    if (!buf || fread(buf, 1, (size_t)n, f) != (size_t)n) {
+        fprintf(stderr, "%s: erro de leitura\n", path);
+        free(buf);
+        fclose(f);
+        return NULL;
+    }
+    buf[n] = '\0';
+    fclose(f);
+    *len = (size_t)n;
+    return buf;
+}
+
+static bool bmp_carregar(const char *path, bitmap_t *bm) {
+    size_t len;
+    uint8_t *d = ler_arquivo(path, &len);
+    if (!d) return false;
+    if (len < 54 || d[0] != 'B' || d[1] != 'M') {
+        fprintf(stderr, "%s: não é um BMP\n", path);
+        return false;
+    }
+
+    uint32_t off = le(&d[10], 4), hdr = le(&d[14], 4);
+    int32_t w = (int32_t)le(&d[18], 4), h = (int32_t)le(&d[22], 4);
+    unsigned bpp = le(&d[28], 2), comp = le(&d[30], 4);
+    bool de_baixo = h > 0;
+    if (h < 0) h = -h;
+    if (comp != 0 || (bpp != 1 && bpp != 24 && bpp != 32) || w <= 0 || w > MAX_DIM || h > MAX_DIM) {
+        fprintf(stderr, "%s: só BMP sem compressão de 1, 24 ou 32 bits, até %dx%d\n", path, MAX_DIM, MAX_DIM);
+        return false;
+    }
+
+    // 1 bit: o índice cuja cor da paleta é preta é o que acende
+    unsigned aceso = 0;
+    if (bpp == 1) {
+        const uint8_t *pal = &d[14 + hdr];
+        aceso = (pal[0] | pal[1] | pal[2]) == 0 ? 0 : 1;
+    }
+
+    size_t por_linha = (((size_t)w * bpp + 31) / 32) * 4;
+    if (off + por_linha * (size_t)h > len) {
+        fprintf(stderr, "%s: BMP truncado\n", path);
+        return false;
+    }
+
+    bm->largura = w;
+    bm->altura = h;
+    bm->px = calloc((size_t)w * (size_t)h, 1);
+    for (int y = 0; y < h; y++) {
+        const uint8_t *linha = &d[off + por_linha * (size_t)(de_baixo ? h - 1 - y : y)];
+        for (int x = 0; x < w; x++) {
+            bool on;
+            if (bpp == 1) {
+                on = ((linha[x >> 3] >> (7 - (x & 7))) & 1) == aceso;
+            } else {
+                const uint8_t *c = &linha[x * (int)(bpp / 8)];
+                on = (c[0] * 29u + c[1] * 150u + c[2] * 77u) / 256u < 128u;    // BGR
+            }
+            bm->px[y * w + x] = on;
+        }
+    }
+    free(d);
+    return true;
+}
+
+/**
+ * @brief Escreve o bitmap em page-major: (altura+7)/8 páginas de 'largura' bytes.
+ */
+static size_t para_paginas(const bitmap_t *bm, int x0, int w, uint8_t *out) {
+    int paginas = (bm->altura + 7) / 8;
+    size_t n = 0;
+    for (int pg = 0; pg < paginas; pg++) {
+        for (int x = x0; x < x0 + w; x++) {
+            uint8_t b = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                int y = pg * 8 + bit;
+                if (y < bm->altura && bm->px[y * bm->largura + x]) b |= (uint8_t)(1u << bit);
+            }
+            out[n++] = b;
+        }
+    }
+    return n;
+}
+
+static void emitir_bytes(FILE *c, const uint8_t *d, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        fprintf(c, "%s0x%02X,%s", i % 16 == 0 ? "    " : "", d[i], i % 16 == 15 || i + 1 == n ? "\n" : " ");
+    }
+}
+
+static bool gerar_imagem(FILE *c, FILE *h, const asset_t *a) {
+    bitmap_t bm;
+    if (!bmp_carregar(a->arquivo, &bm)) return false;
+
+    uint8_t *dados = malloc((size_t)bm.largura * (size_t)((bm.altura + 7) / 8));
+    size_t n = para_paginas(&bm, 0, bm.largura, dados);
+
+    fprintf(h, "extern const ssd1306_imagem_t %s;   // %dx%d, de %s\n", a->nome, bm.largura, bm.altura, a->arquivo);
+    fprintf(c, "static const uint8_t %s_dados[%zu] = {\n", a->nome, n);
+    emitir_bytes(c, dados, n);
+    fprintf(c, "};\n\nconst ssd1306_imagem_t %s = { %d, %d, %s_dados };\n\n", a->nome, bm.largura, bm.altura, a->nome);
+    free(dados);
+    free(bm.px);
+    return true;
+}
+
+typedef struct {
+    bool existe;
+    int avanco;
+    bitmap_t bm;                // Célula: avanço x altura da fonte
+} glifo_t;
+
+static bool bdf_carregar(const char *path, int escala, glifo_t *glifos, int *altura_out) {
+    size_t len;
+    char *txt = (char *)ler_arquivo(path, &len);
+    if (!txt) return false;
+
+    int ascent = -1, descent = -1, fbb_h = 0, fbb_y = 0;
+    int enc = -1, avanco = 0, bw = 0, bh = 0, bx = 0, by = 0;
+    int linha_bitmap = -1, altura = 0;
+    glifo_t *g = NULL;
+
+    for (char *ln = strtok(txt, "\n"); ln; ln = strtok(NULL, "\n")) {
+        if (linha_bitmap >= 0) {
+            if (!strncmp(ln, "ENDCHAR", 7)) {
+                linha_bitmap = -1;
+                continue;
+            }
+            // Linha do bitmap: bits mais significativos primeiro, à esquerda
+            if (g && linha_bitmap < bh) {
+                int ytop = ascent - (by + bh) + linha_bitmap;
+                for (int x = 0; x < bw; x++) {
+                    int nib = x / 4;
+                    if (!isxdigit((unsigned char)ln[nib])) break;
+                    int v = isdigit((unsigned char)ln[nib]) ? ln[nib] - '0' : (tolower((unsigned char)ln[nib]) - 'a' + 10);
+                    if (!((v >> (3 - x % 4)) & 1)) continue;
+                    int px = bx + x;
+                    if (px < 0 || px >= g->bm.largura || ytop < 0 || ytop >= altura) continue;
+                    g->bm.px[ytop * g->bm.largura + px] = 1;
+                }
+            }
+            linha_bitmap++;
+            continue;
+        }
+
+        if (sscanf(ln, "FONTBOUNDINGBOX %*d %d %*d %d", &fbb_h, &fbb_y) == 2) continue;
+        if (sscanf(ln, "FONT_ASCENT %d", &ascent) == 1) continue;
+        if (sscanf(ln, "FONT_DESCENT %d", &descent) == 1) continue;
+        if (sscanf(ln, "ENCODING %d", &enc) == 1) continue;
+        if (sscanf(ln, "DWIDTH %d", &avanco) == 1) continue;
+        if (sscanf(ln, "BBX %d %d %d %d", &bw, &bh, &bx, &by) == 4) continue;
+        if (!strncmp(ln, "STARTCHAR", 9)) {
+            enc = -1;
+            avanco = 0;
+            bw = bh = bx = by = 0;
+            continue;
+        }
+        if (!strncmp(ln, "BITMAP", 6)) {
+            if (ascent < 0 || descent < 0) {    // Sem as propriedades, usa a caixa da fonte
+                ascent = fbb_h + fbb_y;
+                descent = -fbb_y;
+            }
+            altura = ascent + descent;
+            g = NULL;
+            if (enc >= 0 && enc < MAX_CHARS && avanco > 0 && avanco <= MAX_DIM && altura <= MAX_DIM) {
+                g = &glifos[enc];
+                g->existe = true;
+                g->avanco = avanco;
+                g->bm.largura = avanco;
+                g->bm.altura = altura;
+                g->bm.px = calloc((size_t)avanco * (size_t)altura, 1);
+            }
+            linha_bitmap = 0;
+        }
+    }
+    free(txt);
+    if (altura == 0) {
+        fprintf(stderr, "%s: nenhum caractere no BDF\n", path);
+        return false;
+    }
+
+    // Ampliação no build: cada pixel vira um quadrado escala x escala
+    if (escala > 1) {
+        for (int i = 0; i < MAX_CHARS; i++) {
+            glifo_t *gl = &glifos[i];
+            if (!gl->existe) continue;
+            bitmap_t novo = { gl->bm.largura * escala, gl->bm.altura * escala, NULL };
+            if (novo.largura > MAX_DIM || novo.altura > MAX_DIM) {
+                fprintf(stderr, "%s: escala %d grande demais\n", path, escala);
+                return false;
+            }
+            novo.px = malloc((size_t)novo.largura * (size_t)novo.altura);
+            for (int y = 0; y < novo.altura; y++) {
+                for (int x = 0; x < novo.largura; x++) {
+                    novo.px[y * novo.largura + x] = gl->bm.px[(y / escala) * gl->bm.largura + x / escala];
+                }
+            }
+            free(gl->bm.px);
+            gl->bm = novo;
+            gl->avanco *= escala;
+        }
+        altura *= escala;
+    }
+    *altura_out = altura;
+    return true;
+}
+
+static bool gerar_fonte(FILE *c, FILE *h, const asset_t *a) {
+    static glifo_t glifos[MAX_CHARS];
+    int altura;
+
+    memset(glifos, 0, sizeof(glifos));
+    if (!bdf_carregar(a->arquivo, a->escala, glifos, &altura)) return false;
+
+    int primeiro = 0, ultimo = MAX_CHARS - 1;
+    while (primeiro < MAX_CHARS && !glifos[primeiro].existe) primeiro++;
+    while (ultimo > primeiro && !glifos[ultimo].existe) ultimo--;
+    if (primeiro == MAX_CHARS) {
+        fprintf(stderr, "%s: nenhum caractere entre 0 e %d\n", a->arquivo, MAX_CHARS - 1);
+        return false;
+    }
+
+    int n_chars = ultimo - primeiro + 1;
+    int paginas = (altura + 7) / 8;
+    uint8_t *dados = malloc((size_t)n_chars * MAX_DIM * (size_t)paginas);
+    uint32_t offsets[MAX_CHARS];
+    uint8_t larguras[MAX_CHARS];
+    size_t n = 0;
+
+    for (int i = 0; i < n_chars; i++) {
+        glifo_t *g = &glifos[primeiro + i];
+        offsets[i] = (uint32_t)n;
+        larguras[i] = g->existe ? (uint8_t)g->avanco : 0;    // 0: caractere ausente
+        if (g->existe) n += para_paginas(&g->bm, 0, g->avanco, &dados[n]);
+    }
+    if (n > 0xFFFF) {
+        fprintf(stderr, "%s: fonte grande demais (%zu bytes)\n", a->arquivo, n);
+        return false;
+    }
+
+    fprintf(h, "extern const ssd1306_fonte_t %s;   // %d px, caracteres %d..%d, de %s", a->nome, altura,
+            primeiro, ultimo, a->arquivo);
+    if (a->escala > 1) fprintf(h, " (x%d)", a->escala);
+    fprintf(h, "\n");
+
+    fprintf(c, "static const uint8_t %s_larguras[%d] = {\n", a->nome, n_chars);
+    emitir_bytes(c, larguras, (size_t)n_chars);
+    fprintf(c, "};\n\nstatic const uint16_t %s_offsets[%d] = {\n", a->nome, n_chars);
+    for (int i = 0; i < n_chars; i++) {
+        fprintf(c, "%s%u,%s", i % 12 == 0 ? "    " : "", offsets[i], i % 12 == 11 || i + 1 == n_chars ? "\n" : " ");
+    }
+    fprintf(c, "};\n\nstatic const uint8_t %s_dados[%zu] = {\n", a->nome, n);
+    emitir_bytes(c, dados, n);
+    fprintf(c, "};\n\nconst ssd1306_fonte_t %s = { %d, %d, %d, %s_larguras, %s_offsets, %s_dados };\n\n",
+            a->nome, altura, primeiro, ultimo, a->nome, a->nome, a->nome);
+
+    for (int i = 0; i < MAX_CHARS; i++) free(glifos[i].bm.px);
+    free(dados);
+    return true;
+}
+
+static bool parse_asset(const char *arg, bool fonte, asset_t *a) {
+    size_t len = strlen(arg);
+    char *copia = malloc(len + 1);
+    memcpy(copia, arg, len + 1);
+    char *eq = strchr(copia, '=');
+    if (!eq || eq == copia) return false;
+    *eq = '\0';
+    a->nome = copia;
+    a->arquivo = eq + 1;
+    a->fonte = fonte;
+    a->escala = 1;
+    for (const char *p = a->nome; *p; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '_') return false;
+    }
+    char *dois_pontos = strrchr(eq + 1, ':');
+    if (fonte && dois_pontos && dois_pontos[1] && strspn(dois_pontos + 1, "0123456789") == strlen(dois_pontos + 1)) {
+        *dois_pontos = '\0';
+        a->escala = atoi(dois_pontos + 1);
+    }
+    return a->escala >= 1;
+}
+
+static void uso(void) {
+    fprintf(stderr, "uso: ssd1306_assets -o SAIDA [--fonte NOME=ARQ.bdf[:N]]... [--imagem NOME=ARQ.bmp]...\n");
+}
+
+int main(int argc, char **argv) {
+    asset_t assets[MAX_ASSETS];
+    int n_assets = 0;
+    const char *saida = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!val) { uso(); return 1; }
+        if (!strcmp(argv[i], "-o")) {
+            saida = val;
+        } else if ((!strcmp(argv[i], "--fonte") || !strcmp(argv[i], "--imagem")) && n_assets < MAX_ASSETS) {
+            if (!parse_asset(val, argv[i][2] == 'f', &assets[n_assets++])) {
+                fprintf(stderr, "asset inválido: %s\n", val);
+                return 1;
+            }
+        } else {
+            uso();
+            return 1;
+        }
+        i++;
+    }
+    if (!saida || n_assets == 0) { uso(); return 1; }
+
+    char path_c[512], path_h[512];
+    snprintf(path_c, sizeof(path_c), "%s.c", saida);
+    snprintf(path_h, sizeof(path_h), "%s.h", saida);
+    const char *base = strrchr(saida, '/') ? strrchr(saida, '/') + 1 : saida;
+    char guarda[64];
+    size_t g = 0;
+    for (; base[g] && g + 1 < sizeof(guarda); g++) {
+        guarda[g] = isalnum((unsigned char)base[g]) ? (char)toupper((unsigned char)base[g]) : '_';
+    }
+    guarda[g] = '\0';
+
+    FILE *c = fopen(path_c, "w"), *h = fopen(path_h, "w");
+    if (!c || !h) { perror(saida); return 1; }
+
+    fprintf(h, "// Gerado por tools/ssd1306_assets. Não edite: altere os arquivos em assets/.\n");
+    fprintf(h, "#ifndef %s_H\n#define %s_H\n\n#include \"ssd1306.h\"\n\n", guarda, guarda);
+    fprintf(c, "// Gerado por tools/ssd1306_assets. Não edite: altere os arquivos em assets/.\n");
+    fprintf(c, "#include \"%s.h\"\n\n", base);
+
+    bool ok = true;
+    for (int i = 0; i < n_assets && ok; i++) {
+        ok = assets[i].fonte ? gerar_fonte(c, h, &assets[i]) : gerar_imagem(c, h, &assets[i]);
+    }
+    fprintf(h, "\n#endif\n");
+    fclose(c);
+    fclose(h);
+    if (!ok) {
+        remove(path_c);     // Sem saída parcial: o build falha em vez de usar assets velhos
+        remove(path_h);
+        return 1;
+    }
+    return 0;
+}